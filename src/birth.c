@@ -494,7 +494,7 @@ static void player_outfit(void)
 	int show_idx = 1;
 
 	/* Hack -- Give the player his equipment */
-	for (i = 0; i < MAX_CLASS_ITEMS + MAX_COMMON_ITEMS + 1; i++)
+	for (i = 0; i < MAX_CLASS_ITEMS + MAX_COMMON_ITEMS; i++)
 	{
 		object_type *o_ptr;
 
@@ -2868,6 +2868,43 @@ static bool player_birth_aux(void)
 }
 
 
+#ifdef ALLOW_BORG
+
+/*
+ * Helper function for 'player_birth()'.
+ *
+ * The headless borg always plays the beginner character, and asks
+ * no questions at all.
+ */
+static bool player_birth_borg(void)
+{
+	int i;
+
+	/* Level one */
+	p_ptr->max_lev = p_ptr->lev = 1;
+
+	/* Quick start the character */
+	player_birth_quickstart(&beginner_quickstart);
+
+	/* Set adult options from birth options */
+	for (i = OPT_BIRTH; i < OPT_CHEAT; i++)
+	{
+		op_ptr->opt[OPT_ADULT + (i - OPT_BIRTH)] = op_ptr->opt[i];
+	}
+
+	/* Reset score options from cheat options */
+	for (i = OPT_CHEAT; i < OPT_ADULT; i++)
+	{
+		op_ptr->opt[OPT_SCORE + (i - OPT_CHEAT)] = op_ptr->opt[i];
+	}
+
+	/* Accept */
+	return (TRUE);
+}
+
+#endif /* ALLOW_BORG */
+
+
 void roll_hp_table(void)
 {
   int i, j, min_value, max_value;
@@ -2939,6 +2976,11 @@ void player_birth(void)
 	/* Create a new character */
 	while (1)
 	{
+#ifdef ALLOW_BORG
+		/* Roll up a character for the headless borg */
+		if (borg_headless && player_birth_borg()) break;
+#endif
+
 		/* Roll up a new character */
 		if (player_birth_aux()) break;
 	}
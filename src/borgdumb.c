@@ -26,6 +26,94 @@ int count_teleport = 0;
 byte allowed_depth[2] = { 0, 0 };
 byte borg_dir;
 
+/*
+ * Headless ("batch") borg state and statistics
+ */
+bool borg_headless = FALSE;
+u32b borg_count_turns = 0L;
+u32b borg_count_levels = 0L;
+clock_t borg_clock_monsters = 0;
+clock_t borg_clock_generate = 0;
+#ifdef VIEW_SHADOWCAST
+clock_t borg_clock_view[2] = { 0, 0 };
+u32b borg_count_views = 0L;
+u32b borg_count_view_differ = 0L;
+#endif /* VIEW_SHADOWCAST */
+
+
+/*
+ * Prepare the borg for a new session.
+ *
+ * The borg plays for "turns" turns, staying "stay" turns on each level
+ * (or a random number of turns, if "stay" is zero), and travels between
+ * the depths "min_depth" and "max_depth".
+ */
+void borg_setup(u32b turns, int stay, int min_depth, int max_depth)
+{
+	/* Set timers */
+	count_stop = 1L + turns;
+	change_level = stay;
+
+	/* Set depths */
+	if (min_depth < 0) min_depth = 0;
+	if (min_depth >= MAX_DEPTH) min_depth = MAX_DEPTH - 1;
+	if (max_depth < 0) max_depth = 0;
+	if (max_depth >= MAX_DEPTH) max_depth = MAX_DEPTH - 1;
+
+	allowed_depth[0] = (byte)min_depth;
+	allowed_depth[1] = (byte)max_depth;
+
+	/* Check sanity. */
+	if (allowed_depth[1] < allowed_depth[0])
+	{
+		if (!borg_headless) msg_print("clearing all level restrictions.");
+		allowed_depth[0] = 0;
+		allowed_depth[1] = MAX_DEPTH - 1;
+	}
+
+	/* Change level immediately, wait a bit before teleporting. */
+	count_change_level = 0;
+	count_teleport = rand_range(100, 150);
+
+	/* Pick a direction of travel at random */
+	borg_dir = (byte)rand_int(8);
+}
+
+
+/*
+ * Process the monsters, timing them for the batch statistics.
+ */
+void borg_process_monsters(byte minimum_energy)
+{
+	clock_t start = clock();
+
+	process_monsters(minimum_energy);
+
+	borg_clock_monsters += clock() - start;
+}
+
+
+/*
+ * Generate a level, timing it for the batch statistics.
+ */
+void borg_generate_cave(void)
+{
+	clock_t start = clock();
+
+	generate_cave();
+
+	borg_clock_generate += clock() - start;
+
+	/* Count levels */
+	borg_count_levels++;
+
+#ifdef VIEW_SHADOWCAST
+	/* Compare the view engines on the new level */
+	if (borg_headless) view_benchmark(16, borg_clock_view, &borg_count_views,
+		&borg_count_view_differ);
+#endif /* VIEW_SHADOWCAST */
+}
+
 
 /*
  * Run the "Mindless Borg".
@@ -44,55 +132,47 @@ void do_cmd_borg(void)
 	{
 		char ch[80] = "";
 
+		u32b turns;
+		int stay, min_depth;
+
 		/* Query */
 		if (!get_string("How many turns shall the borg play for?", ch, 9)) return;
 
 		/* Set timer */
-		count_stop = 1L + (long)atol(ch);
+		turns = (u32b)atol(ch);
 
 		/* Query */
 		if (!get_string("How many turns shall the borg stay on a level for (0 for random)?", ch, 9)) return;
 
 		/* Set timer */
-		change_level = 1L + (long)atol(ch);
+		stay = (int)(1L + (long)atol(ch));
 
 		/* Query */
 		if (!get_string("What is the minimun level that the borg should travel on?", ch, 3)) return;
 
 		/* Set minimum depth */
-		allowed_depth[0] = atoi(ch);
-		/* if (allowed_depth[0] < 0) allowed_depth[0] = 0; */
-		if (allowed_depth[0] >= MAX_DEPTH) allowed_depth[0] = MAX_DEPTH - 1;
+		min_depth = atoi(ch);
 
 		/* Query */
 		if (!get_string("What is the maximum level that the borg should travel on?", ch, 3)) return;
 
-		/* Set maximum depth */
-		allowed_depth[1] = atoi(ch);
-		/* if (allowed_depth[1] < 0) allowed_depth[1] = 0; */
-		if (allowed_depth[1] >= MAX_DEPTH) allowed_depth[1] = MAX_DEPTH - 1;
-
-		/* Check sanity. */
-		if (allowed_depth[1] < allowed_depth[0])
-		{
-			msg_print("clearing all level restrictions.");
-			allowed_depth[0] = 0;
-			allowed_depth[1] = MAX_DEPTH - 1;
-
-		}
-
-		/* Change level immediately, wait a bit before teleporting. */
-		count_change_level = 0;
-		count_teleport = rand_range(100, 150);
-
-		/* Pick a direction of travel at random */
-		borg_dir = (byte)rand_int(8);
+		/* Start */
+		borg_setup(turns, stay, min_depth, atoi(ch));
 	}
 
 	/* Stop when needed. */
 	count_stop--;
 	if (count_stop == 0)
 	{
+		/* Headless borg is done with this character */
+		if (borg_headless)
+		{
+			p_ptr->playing = FALSE;
+			p_ptr->leaving = TRUE;
+
+			return;
+		}
+
 		/* Redraw everything */
 		do_cmd_redraw();
 
@@ -135,11 +215,18 @@ void do_cmd_borg(void)
 		p_ptr->rest = PY_REST_MAX - 1;
 	}
 
+	/* Count turns */
+	borg_count_turns++;
+
 	/* Do not wait */
 	inkey_scan = TRUE;
 
 	/* Check for a key, and stop the borg if one is pressed */
-	if (inkey())
+	if (borg_headless)
+	{
+		/* Nobody is watching */
+	}
+	else if (inkey())
 	{
 		/* Flush input */
 		flush();
@@ -161,11 +248,15 @@ void do_cmd_borg(void)
 	/* Take a turn */
 	p_ptr->energy_use = 100 - (p_ptr->depth / 2);
 
-	/* Refresh the screen */
-	Term_fresh();
+	/* Run at full speed when headless */
+	if (!borg_headless)
+	{
+		/* Refresh the screen */
+		Term_fresh();
 
-	/* Delay the borg */
-	Term_xtra(TERM_XTRA_DELAY, op_ptr->delay_factor * op_ptr->delay_factor);
+		/* Delay the borg */
+		Term_xtra(TERM_XTRA_DELAY, op_ptr->delay_factor * op_ptr->delay_factor);
+	}
 
 
 	/* Change level when needed. */
@@ -79,7 +79,7 @@ sint distance(int y1, int x1, int y2, int x2)
  * determining which grids are illuminated by the player's torch, and which
  * grids and monsters can be "seen" by the player, etc).
  */
-bool generic_los(int y1, int x1, int y2, int x2, byte flg)
+static bool generic_los_aux(int y1, int x1, int y2, int x2, byte flg)
 {
 	/* Delta */
 	int dx, dy;
@@ -102,9 +102,6 @@ bool generic_los(int y1, int x1, int y2, int x2, byte flg)
 	/* Slope, or 1/Slope, of LOS */
 	int m;
 
-	/* Paranoia */
-	if (!flg) flg = CAVE_XLOS;
-
 	/* Extract the offset */
 	dy = y2 - y1;
 	dx = x2 - x1;
@@ -299,6 +296,90 @@ bool generic_los(int y1, int x1, int y2, int x2, byte flg)
 }
 
 
+#ifdef LOS_CACHE
+
+/*
+ * Remembered results of generic_los(), one per hash bucket.
+ *
+ * An entry is good only while "epoch" matches cave_feat_epoch, so any
+ * change of terrain (or a new level) forgets every entry at once.  Only
+ * CAVE_XLOS and CAVE_XLOF change with the terrain, so other flags are
+ * never remembered.  An unused entry has no "flg", which no call can
+ * ever ask for.
+ */
+typedef struct los_cache_type los_cache_type;
+
+struct los_cache_type
+{
+	u32b epoch;		/* Terrain epoch when worked out */
+	u32b grids;		/* Source and target grids */
+	byte flg;		/* CAVE_XLOS / CAVE_XLOF */
+	bool los;		/* Result */
+};
+
+static los_cache_type los_cache[LOS_CACHE_SIZE];
+
+#endif /* LOS_CACHE */
+
+
+/*
+ * Check whether a line of sight or fire can be traced between two grids,
+ * using the flags in "flg" to decide which grids block it.
+ *
+ * The same pairs of grids get asked about many times each game turn,
+ * by monsters choosing targets and by the noise and scent code, so we
+ * remember recent answers until the terrain next changes.
+ */
+bool generic_los(int y1, int x1, int y2, int x2, byte flg)
+{
+#ifdef LOS_CACHE
+	los_cache_type *l_ptr;
+	u32b grids;
+#endif
+
+	/* Paranoia */
+	if (!flg) flg = CAVE_XLOS;
+
+	/* Handle adjacent (or identical) grids */
+	if ((ABS(y2 - y1) < 2) && (ABS(x2 - x1) < 2)) return (TRUE);
+
+#ifdef LOS_CACHE
+
+	/* Only the terrain flags are kept up to date by the epoch */
+	if (flg & ~(CAVE_XLOS | CAVE_XLOF)) return (generic_los_aux(y1, x1, y2, x2, flg));
+
+	/* Pack the grids into a key */
+	grids = ((u32b)((y1 << 8) | x1) << 16) | (u32b)((y2 << 8) | x2);
+
+	/* Find the bucket */
+	l_ptr = &los_cache[((grids * 2654435761UL + flg) & 0xFFFFFFFFUL) >> (32 - LOS_CACHE_BITS)];
+
+	/* Remembered */
+	if ((l_ptr->epoch == cave_feat_epoch) && (l_ptr->grids == grids) && (l_ptr->flg == flg))
+	{
+		los_cache_hit++;
+
+		return (l_ptr->los);
+	}
+
+	los_cache_miss++;
+
+	/* Work it out, and remember it */
+	l_ptr->epoch = cave_feat_epoch;
+	l_ptr->grids = grids;
+	l_ptr->flg = flg;
+	l_ptr->los = generic_los_aux(y1, x1, y2, x2, flg);
+
+	return (l_ptr->los);
+
+#else /* LOS_CACHE */
+
+	return (generic_los_aux(y1, x1, y2, x2, flg));
+
+#endif /* LOS_CACHE */
+}
+
+
 
 /*
  * Returns true if the player's grid is dark
@@ -2018,6 +2099,24 @@ void note_spot(int y, int x)
 }
 
 
+#ifdef LITE_SPOT_BATCH
+
+/*
+ * Grids waiting to be redrawn while lite_spot() is held back.
+ *
+ * Each grid is listed at most once however often it is asked for, so a
+ * ball or breath that changes the same grid several times (the blast,
+ * the terrain, the objects, the monster and the view) redraws it once.
+ */
+static int lite_spot_held = 0;
+
+static int lite_spot_n = 0;
+static u16b lite_spot_g[DUNGEON_HGT * DUNGEON_WID];
+static bool lite_spot_mark[DUNGEON_HGT][DUNGEON_WID];
+
+#endif /* LITE_SPOT_BATCH */
+
+
 /*
  * Redraw (on the screen) a given map location
  *
@@ -2027,7 +2126,7 @@ void note_spot(int y, int x)
  *
  * The main screen will always be at least 24x80 in size.
  */
-void lite_spot(int y, int x)
+static void lite_spot_aux(int y, int x)
 {
 	byte a;
 	char c;
@@ -2090,6 +2189,85 @@ void lite_spot(int y, int x)
 }
 
 
+/*
+ * Redraw (on the screen) a given map location, or remember to do so
+ * later if redraws are being held back.
+ */
+void lite_spot(int y, int x)
+{
+#ifdef LITE_SPOT_BATCH
+
+	/* Held back */
+	if ((lite_spot_held) && (in_bounds(y, x)))
+	{
+		/* Remember the grid once */
+		if (!lite_spot_mark[y][x])
+		{
+			lite_spot_mark[y][x] = TRUE;
+			lite_spot_g[lite_spot_n++] = GRID(y, x);
+		}
+
+		return;
+	}
+
+#endif /* LITE_SPOT_BATCH */
+
+	lite_spot_aux(y, x);
+}
+
+
+/*
+ * Redraw every grid held back by lite_spot_hold().
+ *
+ * This is done whenever the screen must be up to date, such as before
+ * waiting for a keypress, even if redraws are still being held back.
+ */
+void lite_spot_flush(void)
+{
+#ifdef LITE_SPOT_BATCH
+	int i, y, x;
+
+	for (i = 0; i < lite_spot_n; i++)
+	{
+		y = GRID_Y(lite_spot_g[i]);
+		x = GRID_X(lite_spot_g[i]);
+
+		lite_spot_mark[y][x] = FALSE;
+
+		lite_spot_aux(y, x);
+	}
+
+	lite_spot_n = 0;
+#endif /* LITE_SPOT_BATCH */
+}
+
+
+/*
+ * Hold back lite_spot() until the matching lite_spot_release().
+ *
+ * These calls nest, so that a projection can cause another one.
+ */
+void lite_spot_hold(void)
+{
+#ifdef LITE_SPOT_BATCH
+	lite_spot_held++;
+#endif /* LITE_SPOT_BATCH */
+}
+
+
+/*
+ * Stop holding back lite_spot(), redrawing the grids that were held back.
+ */
+void lite_spot_release(void)
+{
+#ifdef LITE_SPOT_BATCH
+	if (--lite_spot_held) return;
+
+	lite_spot_flush();
+#endif /* LITE_SPOT_BATCH */
+}
+
+
 /*
  * Redraw (on the screen) the current map panel
  *
@@ -3436,6 +3614,9 @@ void forget_view(void)
 
 	byte *fast_play_info = &play_info[0][0];
 
+	/* The view is changing */
+	play_view_epoch++;
+
 	/* None to forget */
 	if (!fast_view_n) return;
 
@@ -3482,249 +3663,70 @@ void forget_view(void)
 
 
 /*
- * Calculate the complete field of view using a new algorithm
- *
- * If "view_g" and "temp_g" were global pointers to arrays of grids, as
- * opposed to actual arrays of grids, then we could be more efficient by
- * using "pointer swapping".
- *
- * Note the following idiom, which is used in the function below.
- * This idiom processes each "octant" of the field of view, in a
- * clockwise manner, starting with the east strip, south side,
- * and for each octant, allows a simple calculation to set "g"
- * equal to the proper grids, relative to "pg", in the octant.
- *
- *   for (o2 = 0; o2 < 8; o2++)
- *   ...
- * g = pg + p->grid[o2];
- *   ...
- *
- *
- * Normally, vision along the major axes is more likely than vision
- * along the diagonal axes, so we check the bits corresponding to
- * the lines of sight near the major axes first.
- *
- * We use the "temp_g" array (and the "CAVE_TEMP" flag) to keep track of
- * which grids were previously marked "CAVE_SEEN", since only those grids
- * whose "CAVE_SEEN" value changes during this routine must be redrawn.
- *
- * This function is now responsible for maintaining the "CAVE_SEEN"
- * flags as well as the "CAVE_VIEW" flags, which is good, because
- * the only grids which normally need to be memorized and/or redrawn
- * are the ones whose "CAVE_SEEN" flag changes during this routine.
- *
- * Basically, this function divides the "octagon of view" into octants of
- * grids (where grids on the main axes and diagonal axes are "shared" by
- * two octants), and processes each octant one at a time, processing each
- * octant one grid at a time, processing only those grids which "might" be
- * viewable, and setting the "CAVE_VIEW" flag for each grid for which there
- * is an (unobstructed) line of sight from the center of the player grid to
- * any internal point in the grid (and collecting these "CAVE_VIEW" grids
- * into the "view_g" array), and setting the "CAVE_SEEN" flag for the grid
- * if, in addition, the grid is "illuminated" in some way.
- *
- * This function relies on a theorem (suggested and proven by Mat Hostetter)
- * which states that in each octant of a field of view, a given grid will
- * be "intersected" by one or more unobstructed "lines of sight" from the
- * center of the player grid if and only if it is "intersected" by at least
- * one such unobstructed "line of sight" which passes directly through some
- * corner of some grid in the octant which is not shared by any other octant.
- * The proof is based on the fact that there are at least three significant
- * lines of sight involving any non-shared grid in any octant, one which
- * intersects the grid and passes though the corner of the grid closest to
- * the player, and two which "brush" the grid, passing through the "outer"
- * corners of the grid, and that any line of sight which intersects a grid
- * without passing through the corner of a grid in the octant can be "slid"
- * slowly towards the corner of the grid closest to the player, until it
- * either reaches it or until it brushes the corner of another grid which
- * is closer to the player, and in either case, the existanc of a suitable
- * line of sight is thus demonstrated.
- *
- * It turns out that in each octant of the radius 20 "octagon of view",
- * there are 161 grids (with 128 not shared by any other octant), and there
- * are exactly 126 distinct "lines of sight" passing from the center of the
- * player grid through any corner of any non-shared grid in the octant.  To
- * determine if a grid is "viewable" by the player, therefore, you need to
- * simply show that one of these 126 lines of sight intersects the grid but
- * does not intersect any wall grid closer to the player.  So we simply use
- * a bit vector with 126 bits to represent the set of interesting lines of
- * sight which have not yet been obstructed by wall grids, and then we scan
- * all the grids in the octant, moving outwards from the player grid.  For
- * each grid, if any of the lines of sight which intersect that grid have not
- * yet been obstructed, then the grid is viewable.  Furthermore, if the grid
- * is a wall grid, then all of the lines of sight which intersect the grid
- * should be marked as obstructed for future reference.  Also, we only need
- * to check those grids for whom at least one of the "parents" was a viewable
- * non-wall grid, where the parents include the two grids touching the grid
- * but closer to the player grid (one adjacent, and one diagonal).  For the
- * bit vector, we simply use 4 32-bit integers.  All of the static values
- * which are needed by this function are stored in the large "vinfo" array
- * (above), which is machine generated by another program.  XXX XXX XXX
+ * Scan the octants of the field of view with the "vinfo" table,
+ * marking the grids in view and in line of fire from (py, px).
  *
- * Hack -- The queue must be able to hold more than VINFO_MAX_GRIDS grids
- * because the grids at the edge of the field of view use "grid zero" as
- * their children, and the queue must be able to hold several of these
- * special grids.  Because the actual number of required grids is bizarre,
- * we simply allocate twice as many as we would normally need.  XXX XXX XXX
+ * See "update_view()" for a description of the algorithm.
  */
-void update_view(void)
+static void update_view_vinfo(int py, int px, int radius)
 {
-	int py = p_ptr->py;
-	int px = p_ptr->px;
-
 	int pg = GRID(py,px);
 
 	int i, g, o2;
 
-	int radius;
-
 	int fast_view_n = view_n;
 	u16b *fast_view_g = view_g;
 
-	int fast_temp_n = 0;
-	u16b *fast_temp_g = temp_g;
-
 	byte *fast_cave_info = &cave_info[0][0];
 	byte *fast_play_info = &play_info[0][0];
 
 	byte pinfo;
 	byte cinfo;
 
-	/*** Step 0 -- Begin ***/
-
-	/* Save the old "view" grids for later */
-	for (i = 0; i < fast_view_n; i++)
+	/*** Step 2a -- octants (PLAY_VIEW | PLAY_SEEN) ***/
+	/* Scan each octant */
+	for (o2 = 0; o2 < 8; o2++)
 	{
-		/* Grid */
-		g = fast_view_g[i];
+		vinfo_type *p;
 
-		/* Get grid info */
-		pinfo = fast_play_info[g];
-		cinfo = fast_cave_info[g];
+		/* Last added */
+		vinfo_type *last = &vinfo[0];
 
-		/* Save "PLAY_SEEN" grids */
-		if (pinfo & (PLAY_SEEN))
-		{
-			/* Set "PLAY_TEMP" flag */
-			pinfo |= (PLAY_TEMP);
+		/* Grid queue */
+		int queue_head = 0;
+		int queue_tail = 0;
+		vinfo_type *queue[VINFO_MAX_GRIDS*2];
 
-			/* Save grid for later */
-			fast_temp_g[fast_temp_n++] = g;
-		}
+		/* Slope bit vector */
+		u32b bits0 = VINFO_BITS_0;
+		u32b bits1 = VINFO_BITS_1;
+		u32b bits2 = VINFO_BITS_2;
+		u32b bits3 = VINFO_BITS_3;
 
-		/* Clear various player FOV flags */
-		pinfo &= ~(PLAY_VIEW | PLAY_SEEN | PLAY_LITE);
+		/* Reset queue */
+		queue_head = queue_tail = 0;
 
-		/* Save cave info */
-		fast_play_info[g] = pinfo;
-	}
+		/* Initial grids */
+		queue[queue_tail++] = &vinfo[1];
+		queue[queue_tail++] = &vinfo[2];
 
-	/* Reset the "view" array */
-	fast_view_n = 0;
+		/* Process queue */
+		while (queue_head < queue_tail)
+		{
+			/* Dequeue next grid */
+			p = queue[queue_head++];
 
-	/* Clear the CAVE_FIRE flag */
-	for (i = 0; i < fire_n; i++)
-	{
-		/* Grid */
-		g = fire_g[i];
+			/* Check bits */
+			if ((bits0 & (p->bits_0)) ||
+			    (bits1 & (p->bits_1)) ||
+			    (bits2 & (p->bits_2)) ||
+			    (bits3 & (p->bits_3)))
+			{
+				/* Extract grid value XXX XXX XXX */
+				g = pg + p->grid[o2];
 
-		/* Clear */
-		fast_play_info[g] &= ~(PLAY_FIRE);
-	}
-
-	/* Reset the "fire" array */
-	fire_n = 0;
-
-	/* Extract "radius" value */
-	radius = p_ptr->cur_lite;
-
-	/* Handle real light */
-	if (radius > 0) ++radius;
-
-	/*** Step 1 -- player grid ***/
-
-	/* Player grid */
-	g = pg;
-
-	/* Get grid info */
-	cinfo = fast_cave_info[g];
-
-	/* Get grid info */
-	pinfo = fast_play_info[g];
-
-	/* Assume viewable & shootable */
-	pinfo |= (PLAY_VIEW | PLAY_FIRE);
-
-	/* Torch-lit grid */
-	if (0 < radius)
-	{
-		/* Mark as "PLAY_SEEN" */
-		pinfo |= (PLAY_SEEN);
-
-		/* Mark as "PLAY_LITE" */
-		pinfo |= (PLAY_LITE);
-	}
-
-	/* Lit grid */
-	else if (cinfo & (CAVE_LITE))
-	{
-		/* Mark as "PLAY_SEEN" */
-		pinfo |= (PLAY_SEEN);
-	}
-
-	/* Save player info */
-	fast_play_info[g] = pinfo;
-
-	/* Save in array */
-	fast_view_g[fast_view_n++] = g;
-
-	/* Save in the "fire" array */
-	fire_g[fire_n++] = g;
-
-	/*** Step 2a -- octants (PLAY_VIEW | PLAY_SEEN) ***/
-	/* Scan each octant */
-	for (o2 = 0; o2 < 8; o2++)
-	{
-		vinfo_type *p;
-
-		/* Last added */
-		vinfo_type *last = &vinfo[0];
-
-		/* Grid queue */
-		int queue_head = 0;
-		int queue_tail = 0;
-		vinfo_type *queue[VINFO_MAX_GRIDS*2];
-
-		/* Slope bit vector */
-		u32b bits0 = VINFO_BITS_0;
-		u32b bits1 = VINFO_BITS_1;
-		u32b bits2 = VINFO_BITS_2;
-		u32b bits3 = VINFO_BITS_3;
-
-		/* Reset queue */
-		queue_head = queue_tail = 0;
-
-		/* Initial grids */
-		queue[queue_tail++] = &vinfo[1];
-		queue[queue_tail++] = &vinfo[2];
-
-		/* Process queue */
-		while (queue_head < queue_tail)
-		{
-			/* Dequeue next grid */
-			p = queue[queue_head++];
-
-			/* Check bits */
-			if ((bits0 & (p->bits_0)) ||
-			    (bits1 & (p->bits_1)) ||
-			    (bits2 & (p->bits_2)) ||
-			    (bits3 & (p->bits_3)))
-			{
-				/* Extract grid value XXX XXX XXX */
-				g = pg + p->grid[o2];
-
-				/* Get grid info */
-				cinfo = fast_cave_info[g];
+				/* Get grid info */
+				cinfo = fast_cave_info[g];
 
 				/* Get grid info */
 				pinfo = fast_play_info[g];
@@ -3988,2163 +3990,3354 @@ void update_view(void)
 		}
 	}
 
-	/*** Step 3 -- Complete the algorithm ***/
 
-	/* Handle blindness */
-	if ((p_ptr->timed[TMD_BLIND]) || (p_ptr->timed[TMD_PSLEEP] >= PY_SLEEP_ASLEEP))
-	{
-		/* Process "new" grids */
-		for (i = 0; i < fast_view_n; i++)
-		{
-			/* Grid */
-			g = fast_view_g[i];
+	/* Save 'view_n' */
+	view_n = fast_view_n;
+}
 
-			/* Grid cannot be "PLAY_SEEN" */
-			fast_play_info[g] &= ~(PLAY_SEEN | PLAY_LITE);
-		}
-	}
 
-	/* Process "new" grids */
-	for (i = 0; i < fast_view_n; i++)
-	{
-		/* Grid */
-		g = fast_view_g[i];
+#ifdef VIEW_SHADOWCAST
 
-		/* Get grid info */
-		pinfo = fast_play_info[g];
+/*
+ * Symmetric shadowcasting, after Albert Ford.
+ *
+ * Each quadrant of the field of view is scanned one row at a time,
+ * moving away from the centre.  Each row is scanned between a pair of
+ * slopes, which start at -1 and 1, and every run of clear grids in the
+ * row starts a scan of the next row out between the slopes of the walls
+ * at either end of the run.  Slopes are kept as fractions, and rows are
+ * never longer than the distance from the centre, so there is no table
+ * to build and no limit on the radius.
+ *
+ * A clear grid is seen only if a line from the centre of the player grid
+ * reaches its centre, which makes the view symmetric: if the player can
+ * see a monster, the monster can see the player.  Walls are seen if any
+ * part of them is in view, as is the case with "vinfo".
+ */
+static int shadow_py, shadow_px;	/* Centre of the view */
+static int shadow_quad;			/* Quadrant being scanned */
+static int shadow_range;		/* Furthest distance to mark */
+static int shadow_radius;		/* Light radius */
+static byte shadow_flg;			/* CAVE_XLOS or CAVE_XLOF */
 
-		/* Was not "PLAY_SEEN", is now "PLAY_SEEN" */
-		if ((pinfo & (PLAY_SEEN)) && !(pinfo & (PLAY_TEMP)))
-		{
-			int y, x;
+/*
+ * Offsets of a grid in each quadrant, for rows and columns
+ */
+static const int shadow_row_y[4] = { -1, 1, 0, 0 };
+static const int shadow_row_x[4] = { 0, 0, 1, -1 };
+static const int shadow_col_y[4] = { 0, 0, 1, 1 };
+static const int shadow_col_x[4] = { 1, 1, 0, 0 };
 
-			/* Location */
-			y = GRID_Y(g);
-			x = GRID_X(g);
 
-			/* Note */
-			note_spot(y, x);
+/*
+ * Divide "a" by "b", rounding down.  "b" must be positive.
+ */
+static int shadow_div(int a, int b)
+{
+	if (a >= 0) return (a / b);
 
-			/* Redraw */
-			lite_spot(y, x);
+	return (-((b - 1 - a) / b));
+}
+
+
+/*
+ * Mark a grid found by the shadowcasting scan.
+ *
+ * "centre" is TRUE if the centre of the grid is in view.
+ */
+static void update_view_shadow_grid(int y, int x, bool wall, bool centre)
+{
+	byte pinfo = play_info[y][x];
+
+	int d = distance(shadow_py, shadow_px, y, x);
+
+	/* Too far away */
+	if (d > shadow_range) return;
+
+	/* Line of fire */
+	if (shadow_flg & (CAVE_XLOF))
+	{
+		/* Require a clear line to the centre of the grid */
+		if ((centre) && !(pinfo & (PLAY_FIRE)))
+		{
+			/* Mark as "PLAY_FIRE" */
+			play_info[y][x] = pinfo | (PLAY_FIRE);
+
+			/* Save in array */
+			fire_g[fire_n++] = GRID(y, x);
 		}
+
+		return;
 	}
 
-	/* Process "old" grids */
-	for (i = 0; i < fast_temp_n; i++)
-	{
-		/* Grid */
-		g = fast_temp_g[i];
+	/* Already viewable */
+	if (pinfo & (PLAY_VIEW)) return;
 
-		/* Get grid info */
-		cinfo = fast_cave_info[g];
+	/* Mark as "viewable" */
+	pinfo |= (PLAY_VIEW);
 
-		/* Get grid info */
-		pinfo = fast_play_info[g];
+	/* Torch-lit grids */
+	if (d < shadow_radius)
+	{
+		/* Mark as "PLAY_SEEN" and "PLAY_LITE" */
+		pinfo |= (PLAY_SEEN | PLAY_LITE);
+	}
 
-		/* Clear "PLAY_TEMP" flag */
-		pinfo &= ~(PLAY_TEMP);
+	/* Lit non-wall grids */
+	else if ((cave_info[y][x] & (CAVE_LITE)) && !(wall))
+	{
+		/* Mark as "PLAY_SEEN" */
+		pinfo |= (PLAY_SEEN);
+	}
 
-		/* Save cave info */
-		fast_play_info[g] = pinfo;
+	/* Lit wall grids */
+	else if (cave_info[y][x] & (CAVE_LITE))
+	{
+		/* Hack -- move towards player */
+		int yy = (y < shadow_py) ? (y + 1) : (y > shadow_py) ? (y - 1) : y;
+		int xx = (x < shadow_px) ? (x + 1) : (x > shadow_px) ? (x - 1) : x;
 
-		/* Was "PLAY_SEEN", is now not "PLAY_SEEN" */
-		if (!(pinfo & (PLAY_SEEN)))
+#ifdef UPDATE_VIEW_COMPLEX_WALL_ILLUMINATION
+
+		/* Check for "complex" illumination */
+		if ((!(cave_info[yy][xx] & (CAVE_XLOS)) &&
+		      (cave_info[yy][xx] & (CAVE_LITE))) ||
+		    (!(cave_info[y][xx] & (CAVE_XLOS)) &&
+		      (cave_info[y][xx] & (CAVE_LITE))) ||
+		    (!(cave_info[yy][x] & (CAVE_XLOS)) &&
+		      (cave_info[yy][x] & (CAVE_LITE))))
 		{
-			int y, x;
+			/* Mark as seen */
+			pinfo |= (PLAY_SEEN);
+		}
 
-			/* Location */
-			y = GRID_Y(g);
-			x = GRID_X(g);
+#else /* UPDATE_VIEW_COMPLEX_WALL_ILLUMINATION */
 
-			/* Redraw */
-			lite_spot(y, x);
+		/* Check for "simple" illumination */
+		if (cave_info[yy][xx] & (CAVE_LITE))
+		{
+			/* Mark as seen */
+			pinfo |= (PLAY_SEEN);
 		}
+
+#endif /* UPDATE_VIEW_COMPLEX_WALL_ILLUMINATION */
 	}
 
+	/* Save player info */
+	play_info[y][x] = pinfo;
 
-	/* Save 'view_n' */
-	view_n = fast_view_n;
+	/* Save in array */
+	view_g[view_n++] = GRID(y, x);
 }
 
 
-
 /*
- * Update the features that have dynamic flags. These grids need to be
- * checked every turn to see if they affected adjacent grids with
- * an attack of some kind.
- *
- * INSTANT grids always alter themselves.
- *
- * ADJACENT grids always affect cardinally adjacent grids with an attack equal to their blow
- * attack. They will affect diagonally adjacent grids 50% of the time (checked per grid).
- *
- * TIMED grids will 2% of the time alter themselves.
- *
- * SPREAD grids will 66% of the time affect an adjacent grid with an attack
- * equal to their blow attack, along with their own grid. 8% of the time they
- * will affect their own grid only.
- *
- * ERUPT grids will 5% of the time project a radius 2 ball attack equal to three times
- * the damage of their blow attack, centred on their grid.
- *
- * STRIKE grids will 5% of the time project a radius 0 ball attack equal to ten times
- * the damage of their blow attack, centred on their grid. At some point, it'd be
- * nice to change this to a beam attack in a random direction, but this will require
- * changes to the project function.
- *
- * Examples of dynamic attacks include fire, smoke, steam, acidic vapours and
- * poison gas.  Examples of erupt attacks include vents. Examples of strike
- * attacks include charged clouds.
- *
- * Because we can potentially have the whole level consisting of features of
- * this type, we maintain an array of 'nearby' grids, that is a list of all
- * grids out to an approximate distance of 20 away. We update the list of grids
- * whenever we move 5 or more distance away from the current location.
- *
- * As an efficiency gain, we only do the above, when we note such a level is
- * 'dyna_full', that is, we have tried adding a dyna_grid that would overflow
- * the array. In instances where we are not dyna_full, the dyna_grid array contains
- * every instance of a dynamic feature of some kind on the level. Once a level
- * has been noted as being 'dyna_full', we do not reset this information until
- * the start of level generation on a new level.
- *
- * We also update this list by adding and removing features that are either
- * dynamic as they are created/destroyed. However, this requires that we create
- * a temporary copy of this list when we are applying the attacks in
- * this function.
- * This may prove not to be such an efficiency gain.
+ * Scan a row "depth" grids away from the centre, between the slopes
+ * "s_num / s_den" and "e_num / e_den", and all of the rows beyond it
+ * which can be seen through it.
  */
-void update_dyna(void)
+static void update_view_shadow_scan(int depth, int s_num, int s_den, int e_num, int e_den)
 {
-	int py = p_ptr->py;
-	int px = p_ptr->px;
-
-	int dist, y, x, g, i;
+	int col, min_col, max_col;
+	int y, x;
 
-	int dam, flg;
+	bool wall;
+	bool centre;
 
-	int fast_dyna_n = dyna_n;
-	u16b *fast_dyna_g = dyna_g;
+	/* Nothing scanned yet */
+	int last = -1;
 
-	int temp_dyna_n;
-	u16b temp_dyna_g[DYNA_MAX];
+	/* Too far away */
+	if (depth > shadow_range) return;
 
-	s16b feat;
+	/* Round the start slope up, and the end slope down, at half-grids */
+	min_col = shadow_div(2 * depth * s_num + s_den, 2 * s_den);
+	max_col = -shadow_div(e_den - 2 * depth * e_num, 2 * e_den);
 
-	feature_type *f_ptr;
+	/* Scan the row */
+	for (col = min_col; col <= max_col; col++)
+	{
+		/* Location */
+		y = shadow_py + depth * shadow_row_y[shadow_quad] + col * shadow_col_y[shadow_quad];
+		x = shadow_px + depth * shadow_row_x[shadow_quad] + col * shadow_col_x[shadow_quad];
 
-	bool full = FALSE;
+		/* Off the level -- treat as an unseen wall */
+		if (!in_bounds(y, x))
+		{
+			wall = TRUE;
+		}
+		else
+		{
+			/* Blocking grid */
+			wall = ((cave_info[y][x] & (shadow_flg)) != 0);
 
-	int alter;
+			/* Centre of the grid is between the slopes */
+			centre = ((col * s_den >= depth * s_num) && (col * e_den <= depth * e_num));
 
-	/* Efficiency */
-	if (dyna_full)
-	{
-		dist = ABS(p_ptr->py - dyna_cent_y);
-		if (ABS(p_ptr->px - dyna_cent_x) > dist)
-			dist = ABS(p_ptr->px - dyna_cent_x);
+			/* Mark the grid */
+			if ((wall) || (centre)) update_view_shadow_grid(y, x, wall, centre);
+		}
 
-		/*
-		 * Character is far enough away from the previous dyna center -
-		 * do a full rebuild.
-		 */
-		if (dist >= 5) full = TRUE;
-	}
-
-	/* Fully update */
-	if (full)
-	{
-		int min_y = MAX(0, py - MAX_SIGHT);
-		int max_y = MIN(DUNGEON_HGT, py + MAX_SIGHT + 1);
-		int min_x = MAX(0, px - MAX_SIGHT);
-		int max_x = MIN(DUNGEON_WID, px + MAX_SIGHT + 1);
-
-		fast_dyna_n = 0;
-
-		/* Scan the potentially visible area of the dungeon */
-		for (y = min_y; y < max_y; y++)
+		/* A run of clear grids starts after a wall */
+		if ((last == 1) && !(wall))
 		{
-			for (x = min_x; x < max_x; x++)
-			{
-				/* Check distance */
-				if (distance(y,x,py,px) > MAX_SIGHT) continue;
-
-				/* Get grid feat */
-				feat = cave_feat[y][x];
-
-				/* Get the feature */
-				f_ptr = &f_info[feat];
-
-				/* Check for dynamic */
-				if (f_ptr->flags3 & (FF3_DYNAMIC_MASK))
-				{
-					fast_dyna_g[fast_dyna_n++] = GRID(y,x);
-				}
-			}
+			s_num = 2 * col - 1;
+			s_den = 2 * depth;
 		}
 
-		dyna_cent_y = py;
-		dyna_cent_x = px;
-		dyna_n = fast_dyna_n;
-	}
-
-	/* Actually apply the attacks */
-	for (i = 0; i < fast_dyna_n; i++)
-	{
-		temp_dyna_g[i] = fast_dyna_g[i];
-	}
-
-	temp_dyna_n = fast_dyna_n;
-
-	/* Actually apply the attacks */
-	for (i = 0; i < temp_dyna_n; i++)
-	{
-		feature_type *f_ptr;
-
-		/* Grid */
-		g = temp_dyna_g[i];
-
-		/* Coordinates */
-		y = GRID_Y(g);
-		x = GRID_X(g);
-
-		/* Get grid feat */
-		feat = cave_feat[y][x];
-
-		/* Get the feature */
-		f_ptr = &f_info[feat];
-
-		/* Default action */
-		alter = 0;
-
-		/* Erupt */
-		if (f_ptr->flags3 & (FF3_ERUPT))
+		/* A run of clear grids ends at a wall -- look beyond it */
+		if ((last == 0) && (wall))
 		{
-			if (!(rand_int(20)))
-			{
-				flg = PROJECT_BOOM | PROJECT_GRID | PROJECT_ITEM | PROJECT_KILL | PROJECT_PLAY;
-
-				dam = damroll(f_ptr->blow.d_side,f_ptr->blow.d_dice) * 2;
-
-				/* Apply the blow */
-				project(SOURCE_FEATURE, feat, 2, 0, y, x, y, x, dam, f_ptr->blow.effect, flg, 0, 0);
-
-				alter = FS_ERUPT;
-			}
+			update_view_shadow_scan(depth + 1, s_num, s_den, 2 * col - 1, 2 * depth);
 		}
 
-		/* Strike */
-		if (f_ptr->flags3 & (FF3_STRIKE))
-		{
-			if (!(rand_int(20)))
-			{
-				flg = PROJECT_GRID | PROJECT_ITEM | PROJECT_KILL | PROJECT_PLAY;
-
-				dam = damroll(f_ptr->blow.d_side,f_ptr->blow.d_dice) * 10;
+		last = (wall ? 1 : 0);
+	}
 
-				/* Apply the blow */
-				project(SOURCE_FEATURE, feat, 0, 0, y, x, y, x, dam, f_ptr->blow.effect, flg, 0, 0);
+	/* The row ended in a run of clear grids -- look beyond it */
+	if (last == 0) update_view_shadow_scan(depth + 1, s_num, s_den, e_num, e_den);
+}
 
-				alter = FS_STRIKE;
-			}
-		}
 
-		/* Instant */
-		if (f_ptr->flags3 & (FF3_INSTANT))
-		{
-			alter = FS_INSTANT;
-		}
+/*
+ * Find the grids in view and in line of fire from (py, px) by
+ * shadowcasting, marking them directly in "play_info".
+ */
+static void update_view_shadow(int py, int px, int radius)
+{
+	/* Centre */
+	shadow_py = py;
+	shadow_px = px;
 
-		/* Adjacent */
-		if (f_ptr->flags3 & (FF3_ADJACENT))
-		{
-			int yy, xx, adjfeat, dir;
-			byte affected = 0;
+	/* Range and light */
+	shadow_range = MAX_SIGHT;
+	shadow_radius = radius;
 
-			for (dir = 0; dir < 8; dir ++)
-			{
-				/* Hack -- skip diagonals 50% of the time, as long as adjacent cardinal direction affected */
-				if ((dir > 3) && (rand_int(100) < 50) &&
-					(((affected & (1 << side_dirs[dir][1])) != 0) || ((affected & (1 << side_dirs[dir][2])) != 0))) continue;
+	/* Scan each quadrant for line of sight */
+	shadow_flg = CAVE_XLOS;
 
-				yy = y + ddy_ddd[dir];
-				xx = x + ddx_ddd[dir];
+	for (shadow_quad = 0; shadow_quad < 4; shadow_quad++)
+	{
+		update_view_shadow_scan(1, -1, 1, 1, 1);
+	}
 
-				adjfeat = cave_feat[yy][xx];
+	/* Scan each quadrant for line of fire */
+	shadow_flg = CAVE_XLOF;
 
-				flg = PROJECT_GRID | PROJECT_ITEM | PROJECT_HIDE;
+	for (shadow_quad = 0; shadow_quad < 4; shadow_quad++)
+	{
+		update_view_shadow_scan(1, -1, 1, 1, 1);
+	}
+}
 
-				dam = damroll(f_ptr->blow.d_side,f_ptr->blow.d_dice);
+#endif /* VIEW_SHADOWCAST */
 
-				/* Apply the blow */
-				project(SOURCE_FEATURE, feat, 0, 0, yy, xx, yy, xx, dam, f_ptr->blow.effect, flg, 0, 0);
 
-				/* Hack -- Remove adjacent grids from further processing */
-				if (adjfeat != cave_feat[yy][xx])
-				{
-					int j;
+/*
+ * Mark the grids in view and in line of fire from (py, px), and add
+ * them to the "view_g" and "fire_g" arrays, which must start empty.
+ *
+ * The "radius" is the light radius of the player (plus one), and the
+ * grids are found by shadowcasting if "shadow" is set.
+ */
+static void update_view_grids(int py, int px, int radius, bool shadow)
+{
+	int g = GRID(py, px);
 
-					affected |= dir;
+	byte pinfo;
+	byte cinfo;
 
-					for (j = i + 1; j < temp_dyna_n; j++)
-					if (temp_dyna_g[j] == GRID(yy,xx))
-					{
-						temp_dyna_n--;
+	/*** Step 1 -- player grid ***/
 
-						temp_dyna_g[j] = temp_dyna_g[temp_dyna_n];
-					}
-				}
-			}
+	/* Get grid info */
+	cinfo = cave_info[py][px];
 
-			if (!alter) alter = FS_ADJACENT;
-		}
+	/* Get grid info */
+	pinfo = play_info[py][px];
 
-		/* Spread */
-		if (f_ptr->flags3 & (FF3_SPREAD))
-		{
-			int dir = rand_int(12);
+	/* Assume viewable & shootable */
+	pinfo |= (PLAY_VIEW | PLAY_FIRE);
 
-			if (dir < 8)
-			{
-				int yy = y + ddy_ddd[dir];
-				int xx = x + ddx_ddd[dir];
+	/* Torch-lit grid */
+	if (0 < radius)
+	{
+		/* Mark as "PLAY_SEEN" */
+		pinfo |= (PLAY_SEEN);
 
-				int adjfeat = cave_feat[yy][xx];
+		/* Mark as "PLAY_LITE" */
+		pinfo |= (PLAY_LITE);
+	}
 
-				flg = PROJECT_GRID | PROJECT_ITEM | PROJECT_HIDE;
+	/* Lit grid */
+	else if (cinfo & (CAVE_LITE))
+	{
+		/* Mark as "PLAY_SEEN" */
+		pinfo |= (PLAY_SEEN);
+	}
 
-				dam = damroll(f_ptr->blow.d_side,f_ptr->blow.d_dice);
+	/* Save player info */
+	play_info[py][px] = pinfo;
 
-				/* Apply the blow */
-				project(SOURCE_FEATURE, feat, 0, 0, yy, xx, yy, xx, dam, f_ptr->blow.effect, flg, 0, 0);
+	/* Save in array */
+	view_g[view_n++] = g;
 
-				/* Hack -- require smoke/acid clouds to move */
-				if (adjfeat == cave_feat[yy][xx]) dir = 12;
+	/* Save in the "fire" array */
+	fire_g[fire_n++] = g;
 
-				/* Hack -- remove altered grids from further processing this iteration */
-				else
-				{
-					int j;
+	/*** Step 2 -- octants ***/
 
-					for (j = i + 1; j < temp_dyna_n; j++)
-					if (temp_dyna_g[j] == GRID(yy,xx))
-					{
-						temp_dyna_n--;
+#ifdef VIEW_SHADOWCAST
 
-						temp_dyna_g[j] = temp_dyna_g[temp_dyna_n];
-					}
-				}
-			}
+	/* Shadowcasting */
+	if (shadow)
+	{
+		update_view_shadow(py, px, radius);
 
-			if ((dir < 9) && (!alter))
-			{
-				alter = FS_SPREAD;
-			}
-		}
+		return;
+	}
 
-		/* Timed */
-		if (f_ptr->flags3 & (FF3_TIMED))
-		{
-			if (rand_int(50) == 0)
-			{
-				alter = FS_TIMED;
-			}
-		}
+#endif /* VIEW_SHADOWCAST */
 
-		/* Alter terrain */
-		if (alter > 0)
-		{
-			cave_alter_feat(y,x,alter);
-		}
-	}
+	/* Use the "vinfo" table */
+	update_view_vinfo(py, px, radius);
 }
 
 
-
 /*
- * Every so often, the character makes enough noise that nearby
- * monsters can use it to home in on him.
+ * Calculate the complete field of view using a new algorithm
  *
- * Fill in the "cave_cost" field of every grid that the player can
- * reach with the number of steps needed to reach that grid.  This
- * also yields the route distance of the player from every grid.
+ * If "view_g" and "temp_g" were global pointers to arrays of grids, as
+ * opposed to actual arrays of grids, then we could be more efficient by
+ * using "pointer swapping".
  *
- * Monsters use this information by moving to adjacent grids with
- * lower flow costs, thereby homing in on the player even though
- * twisty tunnels and mazes.  Monsters can also run away from loud
- * noises.
+ * Note the following idiom, which is used in the function below.
+ * This idiom processes each "octant" of the field of view, in a
+ * clockwise manner, starting with the east strip, south side,
+ * and for each octant, allows a simple calculation to set "g"
+ * equal to the proper grids, relative to "pg", in the octant.
  *
- * The biggest limitation of this code is that it does not easily
- * allow for alternate ways around doors (not all monsters can handle
- * doors) and lava/water (many monsters are not allowed to enter
- * water, lava, or both).
+ *   for (o2 = 0; o2 < 8; o2++)
+ *   ...
+ * g = pg + p->grid[o2];
+ *   ...
  *
- * The flow table is three-dimensional.  The first dimension allows the
- * table to both store and overwrite grids safely.  The second indicates
- * whether this value is that for x or for y.  The third is the number
- * of grids able to be stored at any flow distance.
- */
-void update_noise(void)
-{
-#ifdef MONSTER_FLOW
-	int cost;
-	int route_distance = 0;
-
-	int i, d;
-	int y, x, y2, x2;
-	int last_index;
-	int grid_count = 0;
-
-	int dist;
-	bool full = FALSE;
-
-	/* Note where we get information from, and where we overwrite */
-	int this_cycle = 0;
-	int next_cycle = 1;
-
-	byte flow_table[2][2][8 * NOISE_STRENGTH];
-
-	/* The character's grid has no flow info.  Do a full rebuild. */
-	if (cave_cost[p_ptr->py][p_ptr->px] == 0) full = TRUE;
+ *
+ * Normally, vision along the major axes is more likely than vision
+ * along the diagonal axes, so we check the bits corresponding to
+ * the lines of sight near the major axes first.
+ *
+ * We use the "temp_g" array (and the "CAVE_TEMP" flag) to keep track of
+ * which grids were previously marked "CAVE_SEEN", since only those grids
+ * whose "CAVE_SEEN" value changes during this routine must be redrawn.
+ *
+ * This function is now responsible for maintaining the "CAVE_SEEN"
+ * flags as well as the "CAVE_VIEW" flags, which is good, because
+ * the only grids which normally need to be memorized and/or redrawn
+ * are the ones whose "CAVE_SEEN" flag changes during this routine.
+ *
+ * Basically, this function divides the "octagon of view" into octants of
+ * grids (where grids on the main axes and diagonal axes are "shared" by
+ * two octants), and processes each octant one at a time, processing each
+ * octant one grid at a time, processing only those grids which "might" be
+ * viewable, and setting the "CAVE_VIEW" flag for each grid for which there
+ * is an (unobstructed) line of sight from the center of the player grid to
+ * any internal point in the grid (and collecting these "CAVE_VIEW" grids
+ * into the "view_g" array), and setting the "CAVE_SEEN" flag for the grid
+ * if, in addition, the grid is "illuminated" in some way.
+ *
+ * This function relies on a theorem (suggested and proven by Mat Hostetter)
+ * which states that in each octant of a field of view, a given grid will
+ * be "intersected" by one or more unobstructed "lines of sight" from the
+ * center of the player grid if and only if it is "intersected" by at least
+ * one such unobstructed "line of sight" which passes directly through some
+ * corner of some grid in the octant which is not shared by any other octant.
+ * The proof is based on the fact that there are at least three significant
+ * lines of sight involving any non-shared grid in any octant, one which
+ * intersects the grid and passes though the corner of the grid closest to
+ * the player, and two which "brush" the grid, passing through the "outer"
+ * corners of the grid, and that any line of sight which intersects a grid
+ * without passing through the corner of a grid in the octant can be "slid"
+ * slowly towards the corner of the grid closest to the player, until it
+ * either reaches it or until it brushes the corner of another grid which
+ * is closer to the player, and in either case, the existanc of a suitable
+ * line of sight is thus demonstrated.
+ *
+ * It turns out that in each octant of the radius 20 "octagon of view",
+ * there are 161 grids (with 128 not shared by any other octant), and there
+ * are exactly 126 distinct "lines of sight" passing from the center of the
+ * player grid through any corner of any non-shared grid in the octant.  To
+ * determine if a grid is "viewable" by the player, therefore, you need to
+ * simply show that one of these 126 lines of sight intersects the grid but
+ * does not intersect any wall grid closer to the player.  So we simply use
+ * a bit vector with 126 bits to represent the set of interesting lines of
+ * sight which have not yet been obstructed by wall grids, and then we scan
+ * all the grids in the octant, moving outwards from the player grid.  For
+ * each grid, if any of the lines of sight which intersect that grid have not
+ * yet been obstructed, then the grid is viewable.  Furthermore, if the grid
+ * is a wall grid, then all of the lines of sight which intersect the grid
+ * should be marked as obstructed for future reference.  Also, we only need
+ * to check those grids for whom at least one of the "parents" was a viewable
+ * non-wall grid, where the parents include the two grids touching the grid
+ * but closer to the player grid (one adjacent, and one diagonal).  For the
+ * bit vector, we simply use 4 32-bit integers.  All of the static values
+ * which are needed by this function are stored in the large "vinfo" array
+ * (above), which is machine generated by another program.  XXX XXX XXX
+ *
+ * Hack -- The queue must be able to hold more than VINFO_MAX_GRIDS grids
+ * because the grids at the edge of the field of view use "grid zero" as
+ * their children, and the queue must be able to hold several of these
+ * special grids.  Because the actual number of required grids is bizarre,
+ * we simply allocate twice as many as we would normally need.  XXX XXX XXX
+ */
+void update_view(void)
+{
+	int py = p_ptr->py;
+	int px = p_ptr->px;
 
-	/* Determine when to rebuild, update, or do nothing */
-	if (!full)
-	{
-		dist = ABS(p_ptr->py - flow_center_y);
-		if (ABS(p_ptr->px - flow_center_x) > dist)
-			dist = ABS(p_ptr->px - flow_center_x);
+	int i, g;
 
-		/*
-		 * Character is far enough away from the previous flow center -
-		 * do a full rebuild.
-		 */
-		if (dist >= 15) full = TRUE;
+	int radius;
 
-		else
-		{
-			/* Get axis distance to center of last update */
-			dist = ABS(p_ptr->py - update_center_y);
-			if (ABS(p_ptr->px - update_center_x) > dist)
-				dist = ABS(p_ptr->px - update_center_x);
+	int fast_view_n = view_n;
+	u16b *fast_view_g = view_g;
 
-			/*
-			 * We probably cannot decrease the center cost any more.
-			 * We should assume that we have to do a full rebuild.
-			 */
-			if (cost_at_center - (dist + 5) <= 0) full = TRUE;
+	int fast_temp_n = 0;
+	u16b *fast_temp_g = temp_g;
 
+	byte *fast_play_info = &play_info[0][0];
 
-			/* Less than five grids away from last update */
-			else if (dist < 5)
-			{
-				/* We're in LOS of the last update - don't update again */
-				if (generic_los(p_ptr->py, p_ptr->px, update_center_y,
-		 		    update_center_x, CAVE_XLOS)) return;
+	byte pinfo;
 
-				/* We're not in LOS - update */
-				else full = FALSE;
-			}
+#ifdef VIEW_SHADOWCAST
+	bool shadow = view_shadowcast;
+#else /* VIEW_SHADOWCAST */
+	bool shadow = FALSE;
+#endif /* VIEW_SHADOWCAST */
 
-			/* Always update if at least five grids away */
-			else full = FALSE;
-		}
-	}
+	/*** Step 0 -- Begin ***/
 
-	/* Update */
-	if (!full)
+	/* The view is changing */
+	play_view_epoch++;
+
+#ifdef VIEW_SHADOWCAST
+
+	/*
+	 * Hack -- shadowcasting can see more grids than "temp_g" holds, so
+	 * keep the old "PLAY_SEEN" grids in the old view array, packing them
+	 * down as we go.  This is safe, as we never write past the grid we
+	 * have just read.
+	 */
+	if (shadow) fast_temp_g = fast_view_g;
+
+#endif /* VIEW_SHADOWCAST */
+
+	/* Save the old "view" grids for later */
+	for (i = 0; i < fast_view_n; i++)
 	{
-		bool found = FALSE;
+		/* Grid */
+		g = fast_view_g[i];
 
-		/* Start at the character's location */
-		flow_table[this_cycle][0][0] = p_ptr->py;
-		flow_table[this_cycle][1][0] = p_ptr->px;
-		grid_count = 1;
+		/* Get grid info */
+		pinfo = fast_play_info[g];
 
-		/* Erase outwards until we hit the previous update center */
-		for (cost = 0; cost <= NOISE_STRENGTH; cost++)
+		/* Save "PLAY_SEEN" grids */
+		if (pinfo & (PLAY_SEEN))
 		{
-			/*
-			 * Keep track of the route distance to the previous
-			 * update center.
-			 */
-			route_distance++;
-
+			/* Set "PLAY_TEMP" flag */
+			pinfo |= (PLAY_TEMP);
 
-			/* Get the number of grids we'll be looking at */
-			last_index = grid_count;
+			/* Save grid for later */
+			fast_temp_g[fast_temp_n++] = g;
+		}
 
-			/* Clear the grid count */
-			grid_count = 0;
+		/* Clear various player FOV flags */
+		pinfo &= ~(PLAY_VIEW | PLAY_SEEN | PLAY_LITE);
 
-			/* Get each valid entry in the flow table in turn */
-			for (i = 0; i < last_index; i++)
-			{
-				/* Get this grid */
-				y = flow_table[this_cycle][0][i];
-				x = flow_table[this_cycle][1][i];
+		/* Save cave info */
+		fast_play_info[g] = pinfo;
+	}
 
-				/* Look at all adjacent grids */
-				for (d = 0; d < 8; d++)
-				{
-					/* Child location */
-					y2 = y + ddy_ddd[d];
-					x2 = x + ddx_ddd[d];
+#ifdef VIEW_SHADOWCAST
 
-					/* Check Bounds */
-					if (!in_bounds(y2, x2)) continue;
+	/* Build the new view in the spare array */
+	if (shadow)
+	{
+		view_g = view_old_g;
+		view_old_g = fast_temp_g;
+	}
 
-					/* Ignore illegal grids */
-					if (cave_cost[y2][x2] == 0) continue;
+#endif /* VIEW_SHADOWCAST */
 
-					/* Ignore previously erased grids */
-					if (cave_cost[y2][x2] == 255) continue;
+	/* Reset the "view" array */
+	view_n = 0;
 
-					/* Erase previous info, mark grid */
-					cave_cost[y2][x2] = 255;
+	/* Clear the CAVE_FIRE flag */
+	for (i = 0; i < fire_n; i++)
+	{
+		/* Grid */
+		g = fire_g[i];
 
-					/* Store this grid in the flow table */
-					flow_table[next_cycle][0][grid_count] = y2;
-					flow_table[next_cycle][1][grid_count] = x2;
+		/* Clear */
+		fast_play_info[g] &= ~(PLAY_FIRE);
+	}
 
-					/* Increment number of grids stored */
-					grid_count++;
+	/* Reset the "fire" array */
+	fire_n = 0;
 
-					/* If this is the previous update center, we can stop */
-					if ((y2 == update_center_y) &&
-						(x2 == update_center_x)) found = TRUE;
-				}
-			}
+	/* Extract "radius" value */
+	radius = p_ptr->cur_lite;
 
-			/* Stop when we find the previous update center. */
-			if (found) break;
+	/* Handle real light */
+	if (radius > 0) ++radius;
 
+	/*** Steps 1 and 2 -- find the grids in view ***/
 
-			/* Swap write and read portions of the table */
-			if (this_cycle == 0)
-			{
-				this_cycle = 1;
-				next_cycle = 0;
-			}
-			else
-			{
-				this_cycle = 0;
-				next_cycle = 1;
-			}
-		}
+	update_view_grids(py, px, radius, shadow);
 
-		/*
-		 * Reduce the flow cost assigned to the new center grid by
-		 * enough to maintain the correct cost slope out to the range
-		 * we have to update the flow.
-		 */
-		cost_at_center -= route_distance;
+	/* Get the new view */
+	fast_view_n = view_n;
+	fast_view_g = view_g;
 
-		/* We can't reduce the center cost any more.  Do a full rebuild. */
-		if (cost_at_center < 0) full = TRUE;
+	/*** Step 3 -- Complete the algorithm ***/
 
-		else
+	/* Handle blindness */
+	if ((p_ptr->timed[TMD_BLIND]) || (p_ptr->timed[TMD_PSLEEP] >= PY_SLEEP_ASLEEP))
+	{
+		/* Process "new" grids */
+		for (i = 0; i < fast_view_n; i++)
 		{
-			/* Store the new update center */
-			update_center_y = p_ptr->py;
-			update_center_x = p_ptr->px;
+			/* Grid */
+			g = fast_view_g[i];
+
+			/* Grid cannot be "PLAY_SEEN" */
+			fast_play_info[g] &= ~(PLAY_SEEN | PLAY_LITE);
 		}
 	}
 
-
-	/* Full rebuild */
-	if (full)
+	/* Process "new" grids */
+	for (i = 0; i < fast_view_n; i++)
 	{
-		/*
-		 * Set the initial cost to 100; updates will progressively
-		 * lower this value.  When it reaches zero, another full
-		 * rebuild has to be done.
-		 */
-		cost_at_center = 100;
-
-		/* Save the new noise epicenter */
-		flow_center_y = p_ptr->py;
-		flow_center_x = p_ptr->px;
-		update_center_y = p_ptr->py;
-		update_center_x = p_ptr->px;
+		/* Grid */
+		g = fast_view_g[i];
 
+		/* Get grid info */
+		pinfo = fast_play_info[g];
 
-		/* Erase all of the current flow (noise) information */
-		for (y = 0; y < DUNGEON_HGT; y++)
+		/* Was not "PLAY_SEEN", is now "PLAY_SEEN" */
+		if ((pinfo & (PLAY_SEEN)) && !(pinfo & (PLAY_TEMP)))
 		{
-			for (x = 0; x < DUNGEON_WID; x++)
-			{
-				cave_cost[y][x] = 0;
-			}
-		}
-	}
-
-
-	/*** Update or rebuild the flow ***/
+			int y, x;
 
+			/* Location */
+			y = GRID_Y(g);
+			x = GRID_X(g);
 
-	/* Store base cost at the character location */
-	cave_cost[p_ptr->py][p_ptr->px] = cost_at_center;
+			/* Note */
+			note_spot(y, x);
 
-	/* Store this grid in the flow table, note that we've done so */
-	flow_table[this_cycle][0][0] = p_ptr->py;
-	flow_table[this_cycle][1][0] = p_ptr->px;
-	grid_count = 1;
+			/* Redraw */
+			lite_spot(y, x);
+		}
+	}
 
-	/* Extend the noise burst out to its limits */
-	for (cost = cost_at_center + 1; cost <= cost_at_center + NOISE_STRENGTH; cost++)
+	/* Process "old" grids */
+	for (i = 0; i < fast_temp_n; i++)
 	{
-		/* Get the number of grids we'll be looking at */
-		last_index = grid_count;
+		/* Grid */
+		g = fast_temp_g[i];
+
+		/* Get grid info */
+		pinfo = fast_play_info[g];
 
-		/* Stop if we've run out of work to do */
-		if (last_index == 0) break;
+		/* Clear "PLAY_TEMP" flag */
+		pinfo &= ~(PLAY_TEMP);
 
-		/* Clear the grid count */
-		grid_count = 0;
+		/* Save cave info */
+		fast_play_info[g] = pinfo;
 
-		/* Get each valid entry in the flow table in turn. */
-		for (i = 0; i < last_index; i++)
+		/* Was "PLAY_SEEN", is now not "PLAY_SEEN" */
+		if (!(pinfo & (PLAY_SEEN)))
 		{
-			/* Get this grid */
-			y = flow_table[this_cycle][0][i];
-			x = flow_table[this_cycle][1][i];
+			int y, x;
 
-			/* Look at all adjacent grids */
-			for (d = 0; d < 8; d++)
-			{
-				/* Child location */
-				y2 = y + ddy_ddd[d];
-				x2 = x + ddx_ddd[d];
+			/* Location */
+			y = GRID_Y(g);
+			x = GRID_X(g);
 
-				/* Check Bounds */
-				if (!in_bounds(y2, x2)) continue;
+			/* Redraw */
+			lite_spot(y, x);
+		}
+	}
 
-				/* When doing a rebuild... */
-				if (full)
-				{
-					/* Ignore previously marked grids */
-					if (cave_cost[y2][x2]) continue;
 
-					/* Ignore walls.  Do not ignore rubble. */
-					if (f_info[cave_feat[y2][x2]].flags1 & (FF1_WALL))
-					{
-						continue;
-					}
-				}
+	/* Save 'view_n' */
+	view_n = fast_view_n;
+}
 
-				/* When doing an update... */
-				else
-				{
-					/* Ignore all but specially marked grids */
-					if (cave_cost[y2][x2] != 255) continue;
-				}
 
-				/* Store cost at this location */
-				cave_cost[y2][x2] = cost;
+#ifdef VIEW_SHADOWCAST
 
-				/* Store this grid in the flow table */
-				flow_table[next_cycle][0][grid_count] = y2;
-				flow_table[next_cycle][1][grid_count] = x2;
+/*
+ * Clear the grids marked by "update_view_grids()".
+ */
+static void view_benchmark_clear(void)
+{
+	int i;
 
-				/* Increment number of grids stored */
-				grid_count++;
-			}
-		}
+	byte *fast_play_info = &play_info[0][0];
 
-		/* Swap write and read portions of the table */
-		if (this_cycle == 0)
-		{
-			this_cycle = 1;
-			next_cycle = 0;
-		}
-		else
-		{
-			this_cycle = 0;
-			next_cycle = 1;
-		}
+	for (i = 0; i < view_n; i++)
+	{
+		fast_play_info[view_g[i]] &= ~(PLAY_VIEW | PLAY_SEEN | PLAY_LITE);
 	}
 
-#endif
+	for (i = 0; i < fire_n; i++)
+	{
+		fast_play_info[fire_g[i]] &= ~(PLAY_FIRE);
+	}
+
+	view_n = 0;
+	fire_n = 0;
 }
 
 
 /*
- * Characters leave scent trails for perceptive monsters to track.
- *
- * Smell is rather more limited than sound.  Many creatures cannot use
- * it at all, it doesn't extend very far outwards from the character's
- * current position, and monsters can use it to home in the character,
- * but not to run away from him.
+ * Time both field of view engines on the current level.
  *
- * Smell is valued according to age.  When a character takes his turn,
- * scent is aged by one, and new scent of the current age is laid down.
- * Speedy characters leave more scent, true, but it also ages faster,
- * which makes it harder to hunt them down.
+ * The view is worked out from every "step"th grid that does not block
+ * line of sight, first with the "vinfo" table and then by shadowcasting,
+ * and the time taken by each is added to "clocks".  We also count the
+ * views worked out, and the grids seen by one engine but not the other.
  *
- * Whenever the age count loops, most of the scent trail is erased and
- * the age of the remainder is recalculated.
+ * The view of the player is put back afterwards, so the game is not
+ * changed in any way.
  */
-void update_smell(void)
+void view_benchmark(int step, clock_t clocks[2], u32b *views, u32b *differ)
 {
-#ifdef MONSTER_FLOW
+	int y, x, i, n;
+	int k = 0;
 
-	int i, j;
-	int y, x;
+	int radius = p_ptr->cur_lite;
 
-	int py = p_ptr->py;
-	int px = p_ptr->px;
+	byte *fast_play_info = &play_info[0][0];
 
+	byte *old_play_info;
+	u16b *old_view_g, *old_fire_g, *vinfo_g;
+	sint old_view_n = view_n;
+	sint old_fire_n = fire_n;
 
-	/* Create a table that controls the spread of scent */
-	int scent_adjust[5][5] =
-	{
-		{ 250,  2,  2,  2, 250 },
-		{   2,  1,  1,  1,   2 },
-		{   2,  1,  0,  1,   2 },
-		{   2,  1,  1,  1,   2 },
-		{ 250,  2,  2,  2, 250 },
-	};
+	/* Handle real light */
+	if (radius > 0) ++radius;
+
+	/* Save the view */
+	old_play_info = C_ZNEW(DUNGEON_HGT * LEVEL_STRIDE, byte);
+	C_COPY(old_play_info, fast_play_info, DUNGEON_HGT * LEVEL_STRIDE, byte);
+	old_view_g = C_ZNEW(view_n + 1, u16b);
+	C_COPY(old_view_g, view_g, view_n, u16b);
+	old_fire_g = C_ZNEW(fire_n + 1, u16b);
+	C_COPY(old_fire_g, fire_g, fire_n, u16b);
 
-	/* Scent becomes "younger" */
-	scent_when--;
+	/* Space for the "vinfo" view */
+	vinfo_g = C_ZNEW(VIEW_MAX, u16b);
 
-	/* Loop the age and adjust scent values when necessary */
-	if (scent_when <= 0)
+	/* Forget the view */
+	view_benchmark_clear();
+
+	/* Scan the level */
+	for (y = 1; y < DUNGEON_HGT - 1; y++)
 	{
-		/* Scan the entire dungeon */
-		for (y = 0; y < DUNGEON_HGT; y++)
+		for (x = 1; x < DUNGEON_WID - 1; x++)
 		{
-			for (x = 0; x < DUNGEON_WID; x++)
-			{
-				/* Ignore non-existent scent */
-				if (cave_when[y][x] == 0) continue;
+			/* Need somewhere to stand */
+			if (cave_info[y][x] & (CAVE_XLOS)) continue;
 
-				/* Erase the earlier part of the previous cycle */
-				if (cave_when[y][x] > SMELL_STRENGTH) cave_when[y][x] = 0;
+			/* Only every "step"th grid */
+			if (k++ % step) continue;
 
-				/* Reset the ages of the most recent scent */
-				else cave_when[y][x] = 250 - SMELL_STRENGTH + cave_when[y][x];
-			}
-		}
+			(*views)++;
 
-		/* Reset the age value */
-		scent_when = 250 - SMELL_STRENGTH;
-	}
+			/* Time the "vinfo" table */
+			clocks[0] -= clock();
+			update_view_grids(y, x, radius, FALSE);
+			clocks[0] += clock();
 
+			/* Remember the view */
+			n = view_n;
+			C_COPY(vinfo_g, view_g, n, u16b);
+			view_benchmark_clear();
 
-	/* Lay down new scent */
-	for (i = 0; i < 5; i++)
-	{
-		for (j = 0; j < 5; j++)
-		{
-			/* Translate table to map grids */
-			y = i + py - 2;
-			x = j + px - 2;
+			/* Time shadowcasting */
+			clocks[1] -= clock();
+			update_view_grids(y, x, radius, TRUE);
+			clocks[1] += clock();
 
-			/* Check Bounds */
-			if (!in_bounds(y, x)) continue;
+			/* Count the grids seen by only one of them */
+			*differ += view_n + n;
 
-			/* Walls, water, and lava cannot hold scent. */
-			if ((f_info[cave_feat[y][x]].flags1 & (FF1_WALL)) ||
-			    (f_info[cave_feat[y][x]].flags2 & (FF2_SHALLOW)) ||
-			    (f_info[cave_feat[y][x]].flags2 & (FF2_DEEP)) ||
-			    (f_info[cave_feat[y][x]].flags2 & (FF2_FILLED)))
+			for (i = 0; i < n; i++)
 			{
-				continue;
+				if (fast_play_info[vinfo_g[i]] & (PLAY_VIEW)) *differ -= 2;
 			}
 
-			/* Grid must not be blocked by walls from the character */
-			if (!generic_los(p_ptr->py, p_ptr->px, y, x, CAVE_XLOF)) continue;
-
-			/* Note grids that are too far away */
-			if (scent_adjust[i][j] == 250) continue;
-
-			/* Mark the grid with new scent */
-			cave_when[y][x] = scent_when + scent_adjust[i][j];
+			view_benchmark_clear();
 		}
 	}
 
-#endif
+	/* Restore the view */
+	C_COPY(fast_play_info, old_play_info, DUNGEON_HGT * LEVEL_STRIDE, byte);
+	view_n = old_view_n;
+	C_COPY(view_g, old_view_g, view_n, u16b);
+	fire_n = old_fire_n;
+	C_COPY(fire_g, old_fire_g, fire_n, u16b);
+
+	/* The view has changed */
+	play_view_epoch++;
+
+	FREE(old_play_info);
+	FREE(old_view_g);
+	FREE(old_fire_g);
+	FREE(vinfo_g);
 }
 
+#endif /* VIEW_SHADOWCAST */
+
 
 
 /*
- * Map all rooms and neighbourhood belonging to a particular
- * monster's ecology membership. We also show some monsters
- * which occur in that region.
+ * Update the features that have dynamic flags. These grids need to be
+ * checked every turn to see if they affected adjacent grids with
+ * an attack of some kind.
+ *
+ * INSTANT grids always alter themselves.
+ *
+ * ADJACENT grids always affect cardinally adjacent grids with an attack equal to their blow
+ * attack. They will affect diagonally adjacent grids 50% of the time (checked per grid).
+ *
+ * TIMED grids will 2% of the time alter themselves.
+ *
+ * SPREAD grids will 66% of the time affect an adjacent grid with an attack
+ * equal to their blow attack, along with their own grid. 8% of the time they
+ * will affect their own grid only.
+ *
+ * ERUPT grids will 5% of the time project a radius 2 ball attack equal to three times
+ * the damage of their blow attack, centred on their grid.
+ *
+ * STRIKE grids will 5% of the time project a radius 0 ball attack equal to ten times
+ * the damage of their blow attack, centred on their grid. At some point, it'd be
+ * nice to change this to a beam attack in a random direction, but this will require
+ * changes to the project function.
+ *
+ * Examples of dynamic attacks include fire, smoke, steam, acidic vapours and
+ * poison gas.  Examples of erupt attacks include vents. Examples of strike
+ * attacks include charged clouds.
+ *
+ * Because we can potentially have the whole level consisting of features of
+ * this type, we maintain an array of 'nearby' grids, that is a list of all
+ * grids out to an approximate distance of 20 away. We update the list of grids
+ * whenever we move 5 or more distance away from the current location.
+ *
+ * As an efficiency gain, we only do the above, when we note such a level is
+ * 'dyna_full', that is, we have tried adding a dyna_grid that would overflow
+ * the array. In instances where we are not dyna_full, the dyna_grid array contains
+ * every instance of a dynamic feature of some kind on the level. Once a level
+ * has been noted as being 'dyna_full', we do not reset this information until
+ * the start of level generation on a new level.
+ *
+ * We also update this list by adding and removing features that are either
+ * dynamic as they are created/destroyed. However, this requires that we create
+ * a temporary copy of this list when we are applying the attacks in
+ * this function.
+ * This may prove not to be such an efficiency gain.
  */
-bool map_home(int m_idx)
+void update_dyna(void)
 {
-	u32b ecology = 0L;
-	int i, y, x;
+	int py = p_ptr->py;
+	int px = p_ptr->px;
 
-	/* No ecology */
-	if (!cave_ecology.ready)
-	{
-		/* Show the whole level instead */
-		wiz_lite();
-		return (TRUE);
-	}
+	int dist, y, x, g, i;
 
-	/* Get the flags */
-	for (i = 0; i < cave_ecology.num_races; i++)
-	{
-		/* This monster exists here */
-		if (cave_ecology.race[i] == m_idx)
-		{
-			/* Note ecologies */
-			ecology |= cave_ecology.race_ecologies[i];
-		}
-	}
+	int dam, flg;
 
-	/* Nothing? */
-	if (!ecology)
-	{
-		/* Not a native of these parts */
-		return (FALSE);
-	}
+	int fast_dyna_n = dyna_n;
+	u16b *fast_dyna_g = dyna_g;
 
-	/* Scan that area */
-	for (y = 1; y < DUNGEON_HGT - 1; y++)
-	{
-		for (x = 1; x < DUNGEON_WID - 1; x++)
-		{
-			/* All non-walls are "checked" */
-			if (!(f_info[cave_feat[y][x]].flags1 & (FF1_WALL)))
-			{
-				/* Skip if not in the ecology */
-				if ((room_info[room_idx_ignore_valid(y, x)].ecology & (ecology)) == 0) continue;
+	int temp_dyna_n;
+	u16b temp_dyna_g[DYNA_MAX];
 
-				/* Memorize normal features */
-				if (f_info[cave_feat[y][x]].flags1 & (FF1_REMEMBER))
-				{
-					/* Memorize the object */
-					play_info[y][x] |= (PLAY_MARK);
-				}
+	s16b feat;
 
-				/* Memorize known walls */
-				for (i = 0; i < 8; i++)
-				{
-					int yy = y + ddy_ddd[i];
-					int xx = x + ddx_ddd[i];
+	feature_type *f_ptr;
 
-					/* Memorize walls (etc) */
-					if (f_info[cave_feat[yy][xx]].flags1 & (FF1_REMEMBER))
-					{
-						/* Memorize the walls */
-						play_info[yy][xx] |= (PLAY_MARK);
-					}
-				}
+	bool full = FALSE;
 
-				/* Get monster */
-				i = cave_m_idx[y][x];
+	int alter;
 
-				/* Show monsters */
-				if (i <= 0) continue;
+	/* Efficiency */
+	if (dyna_full)
+	{
+		dist = ABS(p_ptr->py - dyna_cent_y);
+		if (ABS(p_ptr->px - dyna_cent_x) > dist)
+			dist = ABS(p_ptr->px - dyna_cent_x);
 
-				/* Reveal own kind */
-				if ((r_info[m_list[i].r_idx].d_char == r_info[m_list[m_idx].r_idx].d_char)
+		/*
+		 * Character is far enough away from the previous dyna center -
+		 * do a full rebuild.
+		 */
+		if (dist >= 5) full = TRUE;
+	}
 
-					/* Reveal animals, insects, plants */
-					|| ((r_info[i].flags3 & (RF3_ANIMAL | RF3_INSECT | RF3_PLANT)) != 0))
-				{
-					/* Reveal half of monsters */
-					if (i % 2)
-					{
-						/* Optimize -- Repair flags */
-						repair_mflag_mark = repair_mflag_show = TRUE;
+	/* Fully update */
+	if (full)
+	{
+		int min_y = MAX(0, py - MAX_SIGHT);
+		int max_y = MIN(DUNGEON_HGT, py + MAX_SIGHT + 1);
+		int min_x = MAX(0, px - MAX_SIGHT);
+		int max_x = MIN(DUNGEON_WID, px + MAX_SIGHT + 1);
 
-						/* Hack -- Detect the monster */
-						m_list[i].mflag |= (MFLAG_MARK | MFLAG_SHOW);
+		fast_dyna_n = 0;
 
-						/* Update the monster */
-						update_mon(i, FALSE);
-					}
+		/* Scan the potentially visible area of the dungeon */
+		for (y = min_y; y < max_y; y++)
+		{
+			for (x = min_x; x < max_x; x++)
+			{
+				/* Check distance */
+				if (distance(y,x,py,px) > MAX_SIGHT) continue;
+
+				/* Get grid feat */
+				feat = cave_feat[y][x];
+
+				/* Get the feature */
+				f_ptr = &f_info[feat];
+
+				/* Check for dynamic */
+				if (f_ptr->flags3 & (FF3_DYNAMIC_MASK))
+				{
+					fast_dyna_g[fast_dyna_n++] = GRID(y,x);
 				}
 			}
 		}
+
+		dyna_cent_y = py;
+		dyna_cent_x = px;
+		dyna_n = fast_dyna_n;
 	}
 
-	/* Redraw map */
-	p_ptr->redraw |= (PR_MAP);
+	/* Actually apply the attacks */
+	for (i = 0; i < fast_dyna_n; i++)
+	{
+		temp_dyna_g[i] = fast_dyna_g[i];
+	}
 
-	/* Window stuff */
-	p_ptr->window |= (PW_OVERHEAD | PW_MAP);
+	temp_dyna_n = fast_dyna_n;
 
-	return (TRUE);
-}
+	/* Actually apply the attacks */
+	for (i = 0; i < temp_dyna_n; i++)
+	{
+		feature_type *f_ptr;
 
+		/* Grid */
+		g = temp_dyna_g[i];
 
-/*
- * Map a circle ala "magic mapping"
- *
- * We must never attempt to map the outer dungeon walls, or we
- * might induce illegal cave grid references.
- */
-void map_area(void)
-{
-	int i, x, y, y1, y2, x1, x2, r;
+		/* Coordinates */
+		y = GRID_Y(g);
+		x = GRID_X(g);
 
-	/* Radius of detection */
-	r = 2 * MAX_SIGHT;
+		/* Get grid feat */
+		feat = cave_feat[y][x];
 
-	/* Pick an area to map */
-	y1 = MAX(p_ptr->py - r, 1);
-	y2 = MIN(p_ptr->py + r, DUNGEON_HGT-1);
-	x1 = MAX(p_ptr->px - r, 1);
-	x2 = MIN(p_ptr->px + r, DUNGEON_WID-1);
+		/* Get the feature */
+		f_ptr = &f_info[feat];
 
-	/* Scan that area */
-	for (y = y1; y < y2; y++)
-	{
-		for (x = x1; x < x2; x++)
-		{
-			/* Check distance */
-			if (distance(p_ptr->py, p_ptr->px, y, x) > r) continue;
+		/* Default action */
+		alter = 0;
 
-			/* All non-walls are "checked" */
-			if (!(f_info[cave_feat[y][x]].flags1 & (FF1_WALL)))
+		/* Erupt */
+		if (f_ptr->flags3 & (FF3_ERUPT))
+		{
+			if (!(rand_int(20)))
 			{
+				flg = PROJECT_BOOM | PROJECT_GRID | PROJECT_ITEM | PROJECT_KILL | PROJECT_PLAY;
 
-				/* Memorize normal features */
-				if (f_info[cave_feat[y][x]].flags1 & (FF1_REMEMBER))
-				{
-					/* Memorize the object */
-					play_info[y][x] |= (PLAY_MARK);
-				}
+				dam = damroll(f_ptr->blow.d_side,f_ptr->blow.d_dice) * 2;
 
-				/* Memorize known walls */
-				for (i = 0; i < 8; i++)
-				{
-					int yy = y + ddy_ddd[i];
-					int xx = x + ddx_ddd[i];
+				/* Apply the blow */
+				project(SOURCE_FEATURE, feat, 2, 0, y, x, y, x, dam, f_ptr->blow.effect, flg, 0, 0);
 
-					/* Memorize walls (etc) */
-					if (f_info[cave_feat[yy][xx]].flags1 & (FF1_REMEMBER))
-					{
-						/* Memorize the walls */
-						play_info[yy][xx] |= (PLAY_MARK);
-					}
-				}
+				alter = FS_ERUPT;
 			}
 		}
-	}
 
-	/* Redraw map */
-	p_ptr->redraw |= (PR_MAP);
+		/* Strike */
+		if (f_ptr->flags3 & (FF3_STRIKE))
+		{
+			if (!(rand_int(20)))
+			{
+				flg = PROJECT_GRID | PROJECT_ITEM | PROJECT_KILL | PROJECT_PLAY;
 
-	/* Window stuff */
-	p_ptr->window |= (PW_OVERHEAD | PW_MAP);
-}
+				dam = damroll(f_ptr->blow.d_side,f_ptr->blow.d_dice) * 10;
 
+				/* Apply the blow */
+				project(SOURCE_FEATURE, feat, 0, 0, y, x, y, x, dam, f_ptr->blow.effect, flg, 0, 0);
 
+				alter = FS_STRIKE;
+			}
+		}
 
-/*
- * Light up the dungeon using "claravoyance"
- *
- * This function "illuminates" every grid in the dungeon, memorizes all
- * "objects", memorizes all grids as with magic mapping, and, under the
- * standard option settings (view_perma_grids but not view_torch_grids)
- * memorizes all floor grids too.
- *
- * Note that if "view_perma_grids" is not set, we do not memorize floor
- * grids, since this would defeat the purpose of "view_perma_grids", not
- * that anyone seems to play without this option.
- *
- * Note that if "view_torch_grids" is set, we do not memorize floor grids,
- * since this would prevent the use of "view_torch_grids" as a method to
- * keep track of what grids have been observed directly.
- */
-void wiz_lite(void)
-{
-	int i, y, x;
+		/* Instant */
+		if (f_ptr->flags3 & (FF3_INSTANT))
+		{
+			alter = FS_INSTANT;
+		}
 
+		/* Adjacent */
+		if (f_ptr->flags3 & (FF3_ADJACENT))
+		{
+			int yy, xx, adjfeat, dir;
+			byte affected = 0;
 
-	/* Memorize objects */
-	for (i = 1; i < o_max; i++)
-	{
-		object_type *o_ptr = &o_list[i];
+			for (dir = 0; dir < 8; dir ++)
+			{
+				/* Hack -- skip diagonals 50% of the time, as long as adjacent cardinal direction affected */
+				if ((dir > 3) && (rand_int(100) < 50) &&
+					(((affected & (1 << side_dirs[dir][1])) != 0) || ((affected & (1 << side_dirs[dir][2])) != 0))) continue;
 
-		/* Skip dead objects */
-		if (!o_ptr->k_idx) continue;
+				yy = y + ddy_ddd[dir];
+				xx = x + ddx_ddd[dir];
 
-		/* Skip held objects */
-		if (o_ptr->held_m_idx) continue;
+				adjfeat = cave_feat[yy][xx];
 
-		/* Memorize */
-		o_ptr->ident |= (IDENT_MARKED);
-	}
+				flg = PROJECT_GRID | PROJECT_ITEM | PROJECT_HIDE;
 
-	/* Scan all normal grids */
-	for (y = 1; y < DUNGEON_HGT-1; y++)
-	{
-		/* Scan all normal grids */
-		for (x = 1; x < DUNGEON_WID-1; x++)
-		{
-			/* Process all non-walls */
-			if (!(f_info[cave_feat[y][x]].flags1 & (FF1_WALL)))
-			{
-				/* Scan all neighbors */
-				for (i = 0; i < 9; i++)
+				dam = damroll(f_ptr->blow.d_side,f_ptr->blow.d_dice);
+
+				/* Apply the blow */
+				project(SOURCE_FEATURE, feat, 0, 0, yy, xx, yy, xx, dam, f_ptr->blow.effect, flg, 0, 0);
+
+				/* Hack -- Remove adjacent grids from further processing */
+				if (adjfeat != cave_feat[yy][xx])
 				{
-					int yy = y + ddy_ddd[i];
-					int xx = x + ddx_ddd[i];
+					int j;
 
-					/* Perma-lite the grid */
-					cave_info[yy][xx] |= (CAVE_GLOW);
+					affected |= dir;
 
-					/* Memorize normal features */
-					if (f_info[cave_feat[yy][xx]].flags1 & (FF1_REMEMBER))
+					for (j = i + 1; j < temp_dyna_n; j++)
+					if (temp_dyna_g[j] == GRID(yy,xx))
 					{
-						/* Memorize the grid */
-						play_info[yy][xx] |= (PLAY_MARK);
-					}
+						temp_dyna_n--;
 
-					/* Normally, memorize floors (see above) */
-					if (view_perma_grids && !view_torch_grids)
-					{
-						/* Memorize the grid */
-						play_info[yy][xx] |= (PLAY_MARK);
+						temp_dyna_g[j] = temp_dyna_g[temp_dyna_n];
 					}
 				}
 			}
-		}
-	}
 
-	/* Fully update the visuals */
-	p_ptr->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
+			if (!alter) alter = FS_ADJACENT;
+		}
 
-	/* Redraw map */
-	p_ptr->redraw |= (PR_MAP);
+		/* Spread */
+		if (f_ptr->flags3 & (FF3_SPREAD))
+		{
+			int dir = rand_int(12);
 
-	/* Window stuff */
-	p_ptr->window |= (PW_OVERHEAD | PW_MAP | PW_MONLIST);
-}
+			if (dir < 8)
+			{
+				int yy = y + ddy_ddd[dir];
+				int xx = x + ddx_ddd[dir];
 
+				int adjfeat = cave_feat[yy][xx];
 
-/*
- * Forget the dungeon map (ala "Thinking of Maud...").
- */
-void wiz_dark(void)
-{
-	int i, y, x;
+				flg = PROJECT_GRID | PROJECT_ITEM | PROJECT_HIDE;
 
+				dam = damroll(f_ptr->blow.d_side,f_ptr->blow.d_dice);
 
-	/* Forget every grid */
-	for (y = 0; y < DUNGEON_HGT; y++)
-	{
-		for (x = 0; x < DUNGEON_WID; x++)
-		{
-			/* Process the grid */
-			play_info[y][x] &= ~(PLAY_MARK);
-		}
-	}
+				/* Apply the blow */
+				project(SOURCE_FEATURE, feat, 0, 0, yy, xx, yy, xx, dam, f_ptr->blow.effect, flg, 0, 0);
 
-	/* Forget all objects */
-	for (i = 1; i < o_max; i++)
-	{
-		object_type *o_ptr = &o_list[i];
+				/* Hack -- require smoke/acid clouds to move */
+				if (adjfeat == cave_feat[yy][xx]) dir = 12;
 
-		/* Skip dead objects */
-		if (!o_ptr->k_idx) continue;
+				/* Hack -- remove altered grids from further processing this iteration */
+				else
+				{
+					int j;
 
-		/* Skip held objects */
-		if (o_ptr->held_m_idx) continue;
+					for (j = i + 1; j < temp_dyna_n; j++)
+					if (temp_dyna_g[j] == GRID(yy,xx))
+					{
+						temp_dyna_n--;
 
-		/* Forget the object */
-		o_ptr->ident &= ~(IDENT_MARKED);
-	}
+						temp_dyna_g[j] = temp_dyna_g[temp_dyna_n];
+					}
+				}
+			}
 
-	/* Fully update the visuals */
-	p_ptr->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
+			if ((dir < 9) && (!alter))
+			{
+				alter = FS_SPREAD;
+			}
+		}
 
-	/* Redraw map */
-	p_ptr->redraw |= (PR_MAP);
+		/* Timed */
+		if (f_ptr->flags3 & (FF3_TIMED))
+		{
+			if (rand_int(50) == 0)
+			{
+				alter = FS_TIMED;
+			}
+		}
 
-	/* Window stuff */
-	p_ptr->window |= (PW_OVERHEAD | PW_MAP | PW_MONLIST);
+		/* Alter terrain */
+		if (alter > 0)
+		{
+			cave_alter_feat(y,x,alter);
+		}
+	}
 }
 
 
 
+#ifdef MONSTER_FLOW
+
 /*
- * Light or Darken the town
+ * Flow (noise) is worked out with a bucket queue.  Every grid waiting
+ * to be expanded is linked into the bucket for its current flow cost,
+ * and the buckets are emptied in increasing order of cost.  The
+ * queue is always empty between calls.
  */
-void town_illuminate(bool daytime)
-{
-	int y, x, i;
+#define FLOW_NONE	0xFFFF
 
-	town_type *t_ptr = &t_info[p_ptr->dungeon];
+static u16b flow_head[256];
+static u16b flow_next[DUNGEON_HGT * DUNGEON_WID];
+static u16b flow_prev[DUNGEON_HGT * DUNGEON_WID];
+static bool flow_queued[DUNGEON_HGT * DUNGEON_WID];
 
-	dungeon_zone *zone=&t_ptr->zone[0];
+/*
+ * The cost for noise to enter each grid, cached from the terrain.
+ * Zero means that noise cannot enter the grid at all.
+ */
+static byte flow_cost[DUNGEON_HGT][DUNGEON_WID];
 
-	int dungeon_hgt, dungeon_wid;
+/*
+ * The terrain has changed in a way that may make flow costs too low.
+ */
+static bool flow_dirty = FALSE;
 
-	/* Get the zone */
-	get_zone(&zone,p_ptr->dungeon,p_ptr->depth);
 
-	dungeon_hgt = (level_flag & (LF1_TOWN)) != 0 ? TOWN_HGT : DUNGEON_HGT;
-	dungeon_wid = (level_flag & (LF1_TOWN)) != 0 ? TOWN_WID : DUNGEON_WID;
+/*
+ * Get the cost for noise to enter a grid with the given feature.
+ *
+ * Walls stop noise.  Do not ignore rubble.
+ */
+static byte flow_feat_cost(int feat)
+{
+	/* Walls stop noise */
+	if (f_info[feat].flags1 & (FF1_WALL)) return (0);
 
-	/* Darken at night */
-	for (y = 0; y < dungeon_hgt; y++)
+	/* Everything else */
+	return (1);
+}
+
+
+/*
+ * Store a flow cost in a grid and queue it for expansion.
+ */
+static void flow_push(int y, int x, int cost)
+{
+	int g = y * DUNGEON_WID + x;
+
+	/* Already queued at a higher cost - unlink it */
+	if (flow_queued[g])
 	{
-		for (x = 0; x < dungeon_wid; x++)
-		{
-			/* Light outside and adjacent indoors */
-			if ((!daytime) || ((f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE)) == 0))
-			{
-				/* Darken the grid */
-				cave_info[y][x] &= ~(CAVE_DLIT);
-			}
-		}
+		if (flow_prev[g] != FLOW_NONE) flow_next[flow_prev[g]] = flow_next[g];
+		else flow_head[cave_cost[y][x]] = flow_next[g];
+
+		if (flow_next[g] != FLOW_NONE) flow_prev[flow_next[g]] = flow_prev[g];
 	}
 
-	/* Apply light during day */
-	if (daytime) for (y = 0; y < dungeon_hgt; y++)
+	/* Store the cost */
+	cave_cost[y][x] = cost;
+
+	/* Link into the bucket for this cost */
+	flow_prev[g] = FLOW_NONE;
+	flow_next[g] = flow_head[cost];
+	if (flow_head[cost] != FLOW_NONE) flow_prev[flow_head[cost]] = g;
+	flow_head[cost] = g;
+
+	flow_queued[g] = TRUE;
+}
+
+
+/*
+ * Empty the bucket queue, spreading noise outwards from every grid in
+ * it, but never giving any grid a cost higher than "limit".
+ *
+ * A grid is only ever touched if its flow cost goes down, so the work
+ * done is proportional to the number of grids that change.
+ */
+static void flow_spread(int cost, int limit)
+{
+	int d, g;
+	int y, x, y2, x2;
+	int cost2;
+
+	/* Empty the buckets in order */
+	for (; cost <= limit; cost++)
 	{
-		for (x = 0; x < dungeon_wid; x++)
+		while (flow_head[cost] != FLOW_NONE)
 		{
-			/* Location is outside */
-			if (((f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE)) != 0)
+			/* Take the first grid out of the bucket */
+			g = flow_head[cost];
+			flow_head[cost] = flow_next[g];
+			if (flow_next[g] != FLOW_NONE) flow_prev[flow_next[g]] = FLOW_NONE;
+			flow_queued[g] = FALSE;
 
-				/* or light rooms lit by daylight */
-				|| ((room_has_flag(y, x, ROOM_DAYLITE)) != 0))
+			y = g / DUNGEON_WID;
+			x = g % DUNGEON_WID;
+
+			/* Look at all adjacent grids */
+			for (d = 0; d < 8; d++)
 			{
-				/* Illuminate the grid */
-				cave_info[y][x] |= (CAVE_DLIT);
+				/* Child location */
+				y2 = y + ddy_ddd[d];
+				x2 = x + ddx_ddd[d];
 
-				for (i = 0; i < 8; i++)
-				{
-					int yy = y + ddy_ddd[i];
-					int xx = x + ddx_ddd[i];
+				/* Check Bounds */
+				if (!in_bounds(y2, x2)) continue;
 
-					/* Ignore annoying locations */
-					if (!in_bounds(yy, xx)) continue;
+				/* Ignore grids noise cannot enter */
+				if (!flow_cost[y2][x2]) continue;
 
-					/* Illuminate the grid */
-					cave_info[yy][xx] |= (CAVE_DLIT);
-				}
+				/* Cost to get there */
+				cost2 = cost + flow_cost[y2][x2];
+
+				/* Too far away */
+				if (cost2 > limit) continue;
+
+				/* Ignore grids that are already as loud */
+				if ((cave_cost[y2][x2]) && (cave_cost[y2][x2] <= cost2)) continue;
+
+				/* Store cost and queue the grid */
+				flow_push(y2, x2, cost2);
 			}
 		}
 	}
+}
 
-	/* XXX WARNING:
-	 *
-	 * Town_illuminate is called once whilst loading a character.
-	 *
-	 * The following will cause a monster to be generated before loading
-	 * the monsters, and cause the save file to fail to load.
-	 *
-	 * Therefore we need to ensure that the character is loaded first.
-	 *
-	 */
 
-	/* Megahack --- darkness brings out the bad guys */
-	if ((character_loaded) && (!daytime) && actual_guardian(zone->guard, p_ptr->dungeon, zone - t_ptr->zone) && (r_info[actual_guardian(zone->guard, p_ptr->dungeon, zone - t_ptr->zone)].cur_num <= 0))
+/*
+ * The terrain in a grid has changed.  Update the cached flow cost,
+ * and let noise leak through newly opened grids.
+ *
+ * If a grid gets harder to pass, the flow costs beyond it may now be
+ * too low; we simply rebuild the flow next time round.
+ */
+static void update_noise_grid(int y, int x)
+{
+	int d, y2, x2;
+	int old_cost = flow_cost[y][x];
+	int new_cost = flow_feat_cost(cave_feat[y][x]);
+	int cost, limit;
+
+	/* Update the cache */
+	flow_cost[y][x] = new_cost;
+
+	/* Nothing to do */
+	if ((new_cost == old_cost) || (!cost_at_center)) return;
+
+	/* Grid is harder to pass than before */
+	if ((!new_cost) || ((old_cost) && (new_cost > old_cost)))
 	{
-		/* Place the guardian */
-		place_guardian(1, 1, dungeon_hgt- 1, dungeon_wid -1);
+		/* Other grids may depend on this one - rebuild */
+		if (cave_cost[y][x]) flow_dirty = TRUE;
+
+		/* Walls hold no noise */
+		if (!new_cost) cave_cost[y][x] = 0;
+
+		return;
 	}
 
-	/* Fully update the visuals */
-	p_ptr->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
+	/* Noise may now flow through this grid */
+	limit = cost_at_center + NOISE_STRENGTH;
+	cost = limit + 1;
 
-	/* Redraw map */
-	p_ptr->redraw |= (PR_MAP);
+	/* Find the loudest adjacent grid */
+	for (d = 0; d < 8; d++)
+	{
+		y2 = y + ddy_ddd[d];
+		x2 = x + ddx_ddd[d];
 
-	/* Window stuff */
-	p_ptr->window |= (PW_OVERHEAD | PW_MONLIST | PW_MAP);
+		if (!in_bounds(y2, x2)) continue;
+		if (!cave_cost[y2][x2]) continue;
+
+		if (cave_cost[y2][x2] + new_cost < cost) cost = cave_cost[y2][x2] + new_cost;
+	}
+
+	/* No noise reaches here, or no improvement */
+	if (cost > limit) return;
+	if ((cave_cost[y][x]) && (cave_cost[y][x] <= cost)) return;
+
+	/* Spread the noise onwards */
+	flow_push(y, x, cost);
+	flow_spread(cost, limit);
 }
 
+#endif /* MONSTER_FLOW */
 
 
 /*
- * Hack -- Really change the feature
+ * Every so often, the character makes enough noise that nearby
+ * monsters can use it to home in on him.
+ *
+ * Fill in the "cave_cost" field of every grid that the character can
+ * reach with the cost of getting to that grid.  This also yields the
+ * route distance of the character from every grid.
+ *
+ * Monsters use this information by moving to adjacent grids with
+ * lower flow costs, thereby homing in on the character even though
+ * twisty tunnels and mazes.  Monsters can also run away from loud
+ * noises.
+ *
+ * When the character moves, we do not throw the old flow away.  We
+ * give the new grid a cost lower than that of any other grid, by at
+ * least the cost of getting there from the last update, and spread
+ * noise outwards only into grids that get louder as a result.  Only
+ * when the cost at the center can be reduced no further, or the
+ * character is 15 grids from where the flow was last rebuilt, do we
+ * wipe the level and start again.
+ *
+ * The biggest limitation of this code is that it does not easily
+ * allow for alternate ways around doors (not all monsters can handle
+ * doors) and lava/water (many monsters are not allowed to enter
+ * water, lava, or both).
  */
-void cave_set_feat_aux(const int y, const int x, int feat)
+void update_noise(void)
 {
-	/* Set if blocks los */
-	bool los = cave_floor_bold(y,x);
-
-	/* Get feature */
-	feature_type *f_ptr = &f_info[feat];
-
-	/* Set if dynamic */
-	bool dyna = (f_info[cave_feat[y][x]].flags3 & (FF3_DYNAMIC_MASK)) != 0;
+#ifdef MONSTER_FLOW
+	int py = p_ptr->py;
+	int px = p_ptr->px;
 
-	bool hide_item = (f_info[cave_feat[y][x]].flags2 & (FF2_HIDE_ITEM)) != 0;
+	int i, y, x;
+	int dist;
+	bool full = FALSE;
 
-	bool use_feat = (f_info[cave_feat[y][x]].flags3 & (FF3_USE_FEAT)) != 0 ? f_info[cave_feat[y][x]].k_idx : 0;
+	/* The character's grid has no flow info.  Do a full rebuild. */
+	if (cave_cost[py][px] == 0) full = TRUE;
 
-	s16b this_o_idx, next_o_idx = 0;
+	/* The terrain has got harder to pass.  Do a full rebuild. */
+	if (flow_dirty) full = TRUE;
 
-	/* Paranoia */
-	if ((feat > z_info->f_max) || (y < 0) || (y > DUNGEON_HGT) || (x < 0) || (x > DUNGEON_WID))
+	/* Determine when to rebuild, update, or do nothing */
+	if (!full)
 	{
-		msg_format("Error: Setting invalid feat %d at (%d, %d).", feat, y, x);
-		return;
-	}
+		dist = ABS(py - flow_center_y);
+		if (ABS(px - flow_center_x) > dist)
+			dist = ABS(px - flow_center_x);
 
-	/* Paranoia */
-	if (((f_info[feat].flags1 & (FF1_ENTER)) != 0) && ((level_flag & (LF1_TOWN)) == 0))
-	{
-		msg_format("BUG: Setting store %d at (%d, %d) outside of a town level.", feat, y, x);
-		return;
+		/*
+		 * Character is far enough away from the previous flow center -
+		 * do a full rebuild.
+		 */
+		if (dist >= 15) full = TRUE;
 	}
 
-	/* Really set the feature */
-	cave_feat[y][x] = feat;
-
-	/* Check for line of sight */
-	if (f_ptr->flags1 & (FF1_LOS))
+	if (!full)
 	{
-		cave_info[y][x] &= ~(CAVE_XLOS);
-	}
+		/* Get axis distance to center of last update */
+		dist = ABS(py - update_center_y);
+		if (ABS(px - update_center_x) > dist)
+			dist = ABS(px - update_center_x);
 
-	/* Handle wall grids */
-	else
-	{
-		cave_info[y][x] |= (CAVE_XLOS);
-	}
+		/*
+		 * We probably cannot decrease the center cost any more.
+		 * We should assume that we have to do a full rebuild.
+		 */
+		if (cost_at_center - (dist + 5) <= 0) full = TRUE;
 
-	/* Check for line of fire */
-	if (f_ptr->flags1 & (FF1_PROJECT))
-	{
-		cave_info[y][x] &= ~(CAVE_XLOF);
+		/* Less than five grids away from last update */
+		else if (dist < 5)
+		{
+			/* We're in LOS of the last update - don't update again */
+			if (generic_los(py, px, update_center_y,
+			    update_center_x, CAVE_XLOS)) return;
+		}
 	}
 
-	/* Handle wall grids */
-	else
+	if (!full)
 	{
-		cave_info[y][x] |= (CAVE_XLOF);
-	}
-
-	/* Check for change to boring grid */
-	if (!(f_ptr->flags1 & (FF1_REMEMBER))) play_info[y][x] &= ~(PLAY_MARK);
+		/* Get the cost of getting here from the last update */
+		dist = cave_cost[py][px] - cost_at_center;
 
-	/* Check for change to out of sight grid */
-	else if (!(player_can_see_bold(y,x))) play_info[y][x] &= ~(PLAY_MARK);
+		/* Already the loudest grid */
+		if (dist <= 0) return;
 
-	/* Check if adding to dynamic list */
-	if (!dyna && (f_ptr->flags3 & (FF3_DYNAMIC_MASK)))
-	{
-		if (dyna_n >= (DYNA_MAX -1))
-		{
-			dyna_full = TRUE;
+		/*
+		 * Reduce the flow cost assigned to the new center grid by
+		 * enough to maintain the correct cost slope out to the range
+		 * we have to update the flow.
+		 */
+		if (cost_at_center - dist < 1) full = TRUE;
 
-			/* Hack to force rebuild */
-			dyna_cent_y = 255;
-			dyna_cent_x = 255;
-		}
 		else
 		{
-			dyna_g[dyna_n++] = GRID(y,x);
+			cost_at_center -= dist;
+
+			/* Store the new update center */
+			update_center_y = py;
+			update_center_x = px;
 		}
 	}
-	/* Check if removing from dynamic list */
-	else if (dyna && !(f_ptr->flags3 & (FF3_DYNAMIC_MASK)))
+
+	/* Start the queue afresh */
+	for (i = 0; i < 256; i++) flow_head[i] = FLOW_NONE;
+
+	/* Full rebuild */
+	if (full)
 	{
-		int i;
+		/*
+		 * Set the initial cost to 100; updates will progressively
+		 * lower this value.  When it reaches zero, another full
+		 * rebuild has to be done.
+		 */
+		cost_at_center = 100;
 
-		for (i = 0; i < dyna_n; i++)
-		if (dyna_g[i] == GRID(y,x))
+		/* Save the new noise epicenter */
+		flow_center_y = py;
+		flow_center_x = px;
+		update_center_y = py;
+		update_center_x = px;
+
+		/* Erase all of the current flow (noise) information */
+		for (y = 0; y < DUNGEON_HGT; y++)
 		{
-			dyna_n--;
-			dyna_g[i] = dyna_g[dyna_n];
+			for (x = 0; x < DUNGEON_WID; x++)
+			{
+				cave_cost[y][x] = 0;
+
+				/* Cache the cost of entering the grid */
+				flow_cost[y][x] = flow_feat_cost(cave_feat[y][x]);
+			}
 		}
+
+		flow_dirty = FALSE;
 	}
 
-	/* Check to see if monster exposed by change */
-	if (cave_m_idx[y][x] > 0)
-	{
-		monster_type *m_ptr = &m_list[cave_m_idx[y][x]];
 
-		bool hidden = ((m_ptr->mflag & (MFLAG_HIDE)) != 0);
+	/*** Update or rebuild the flow ***/
 
-		if (hidden)
-		{
-			monster_hide(y, x, place_monster_here(y, x, m_ptr->r_idx), m_ptr);
+	/* Store base cost at the character location */
+	flow_push(py, px, cost_at_center);
 
-			if (!(m_ptr->mflag & (MFLAG_HIDE)))
-			{
-				/* And update */
-				update_mon(cave_m_idx[y][x],FALSE);
+	/* Extend the noise burst out to its limits */
+	flow_spread(cost_at_center, cost_at_center + NOISE_STRENGTH);
 
-				/* Hack --- tell the player if something unhides */
-				if (m_ptr->ml)
-				{
-					char m_name[80];
+#endif
+}
 
-					/* Get the monster name */
-					monster_desc(m_name, sizeof(m_name), cave_m_idx[y][x], 0);
 
-					msg_format("%^s emerges from %s%s.",m_name,
-						((f_info[cave_feat[m_ptr->fy][m_ptr->fx]].flags2 & (FF2_FILLED))?"":"the "),
-						f_name+f_info[cave_feat[m_ptr->fy][m_ptr->fx]].name);
-				}
+#ifdef MONSTER_FLOW
 
-				/* Disturb on "move" */
-				if ((m_ptr->ml &&
-				    (disturb_move ||
-				     ((m_ptr->mflag & (MFLAG_VIEW)) &&
-				      disturb_near)))
-				      	&& ((m_ptr->mflag & (MFLAG_ALLY)) == 0))
+/*
+ * The grids around the character that can hold new scent, worked out
+ * for the position and terrain epoch below.
+ */
+static bool scent_mask[5][5];
+static int scent_mask_y = -1;
+static int scent_mask_x = -1;
+static u32b scent_mask_epoch;
 
-				{
-					/* Disturb */
-					disturb(0, 0);
-				}
-			}
-		}
-	}
+#endif /* MONSTER_FLOW */
 
-	/* Scan all objects in the grid */
-	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
-	{
-		object_type *o_ptr;
 
-		/* Get the object */
-		o_ptr = &o_list[this_o_idx];
+/*
+ * Characters leave scent trails for perceptive monsters to track.
+ *
+ * Smell is rather more limited than sound.  Many creatures cannot use
+ * it at all, it doesn't extend very far outwards from the character's
+ * current position, and monsters can use it to home in the character,
+ * but not to run away from him.
+ *
+ * Smell is valued according to age.  When a character takes his turn,
+ * the scent clock ticks once, and new scent is laid down stamped with
+ * the current time (backdated a little away from the character).  The
+ * age of scent is worked out when it is read (see "get_scent()"), so
+ * old scent simply fades.  The clock only has 16 bits, so before it runs
+ * out, it is started again and the scent still around is re-stamped.
+ * Speedy characters leave more scent, true, but it also ages faster,
+ * which makes it harder to hunt them down.
+ *
+ * Which grids can take scent depends only on the character's position
+ * and the terrain, so it is remembered until either changes.
+ */
+void update_smell(void)
+{
+#ifdef MONSTER_FLOW
 
-		/* Get the next object */
-		next_o_idx = o_ptr->next_o_idx;
+	int i, j;
+	int y, x;
 
-		/* Hide stuff */
-		if ((!hide_item) && (f_ptr->flags2 & (FF2_HIDE_ITEM)))
-		{
-			/* Hide it */
-			o_ptr->ident &= ~(IDENT_MARKED);
-		}
+	int py = p_ptr->py;
+	int px = p_ptr->px;
 
-		/* Destroy stored items */
-		if (o_ptr->ident & (IDENT_STORE))
+
+	/* Create a table that controls the spread of scent */
+	static const byte scent_adjust[5][5] =
+	{
+		{ 250,  2,  2,  2, 250 },
+		{   2,  1,  1,  1,   2 },
+		{   2,  1,  0,  1,   2 },
+		{   2,  1,  1,  1,   2 },
+		{ 250,  2,  2,  2, 250 },
+	};
+
+	/* Scent clock ticks */
+	scent_when++;
+
+	/* Start the clock again before it runs out */
+	if (scent_when >= SMELL_CLOCK_MAX)
+	{
+		/* Restart so that no live scent is stamped zero */
+		u16b shift = scent_when - (SMELL_FADE + 1);
+
+		for (y = 0; y < DUNGEON_HGT; y++)
 		{
-			/* Destroy anything that has a 'used' object that never really exists */
-			if (use_feat && (!(f_ptr->flags3 & (FF3_USE_FEAT)) || (use_feat != f_ptr->k_idx)))
-			{
-				  delete_object_idx(this_o_idx);
-			}
-			/* Reveal other objects from e.g. traps */
-			else if (!use_feat)
+			for (x = 0; x < DUNGEON_WID; x++)
 			{
-				o_ptr->ident &= ~IDENT_STORE;
+				/* Ignore non-existent scent */
+				if (!cave_when[y][x]) continue;
 
-				/* Window flags */
-				p_ptr->window |= (PW_ITEMLIST);
+				/* Erase faded scent */
+				if ((u16b)(scent_when - cave_when[y][x]) > SMELL_FADE) cave_when[y][x] = 0;
+
+				/* Keep the age of the rest */
+				else cave_when[y][x] -= shift;
 			}
-			continue;
 		}
-	}
 
-	/* Check if los has changed */
-	if ((los) && (player_has_los_bold(y,x)) && !(cave_floor_bold(y,x)))
-	{
-		/* Update the visuals */
-		p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
-	}
-	else if ((!los) && (player_has_los_bold(y,x)) && (cave_floor_bold(y,x)))
-	{
-		/* Update the visuals */
-		p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
+		scent_when -= shift;
 	}
 
-	/* Check if location changed under player */
-	if ((p_ptr->py == y) && (p_ptr->px == x))
+	/* Work out where scent can be laid */
+	if ((py != scent_mask_y) || (px != scent_mask_x) ||
+	    (cave_feat_epoch != scent_mask_epoch))
 	{
-		bool outside = (level_flag & (LF1_SURFACE)) &&
-			(f_info[feat].flags3 & (FF3_OUTSIDE));
+		for (i = 0; i < 5; i++)
+		{
+			for (j = 0; j < 5; j++)
+			{
+				/* Assume not */
+				scent_mask[i][j] = FALSE;
 
-		/* Recalculate bonuses */
-		p_ptr->update |= (PU_BONUS);
+				/* Note grids that are too far away */
+				if (scent_adjust[i][j] == 250) continue;
 
-		/* Changed inside/outside */
-		if (outside != p_ptr->outside)
-		{
- 			p_ptr->redraw |= (PR_MAP);
+				/* Translate table to map grids */
+				y = i + py - 2;
+				x = j + px - 2;
 
- 			p_ptr->window |= (PW_OVERHEAD | PW_MAP);
-		}
+				/* Check Bounds */
+				if (!in_bounds(y, x)) continue;
 
-		/* Change state */
-		p_ptr->outside = outside;
-	}
+				/* Walls, water, and lava cannot hold scent. */
+				if ((f_info[cave_feat[y][x]].flags1 & (FF1_WALL)) ||
+				    (f_info[cave_feat[y][x]].flags2 & (FF2_SHALLOW)) ||
+				    (f_info[cave_feat[y][x]].flags2 & (FF2_DEEP)) ||
+				    (f_info[cave_feat[y][x]].flags2 & (FF2_FILLED)))
+				{
+					continue;
+				}
 
-	if (player_has_los_bold(y,x))
-	{
-		/* Notice */
-		note_spot(y, x);
+				/* Grid must not be blocked by walls from the character */
+				if (!generic_los(py, px, y, x, CAVE_XLOF)) continue;
 
-		/* Redraw */
-		lite_spot(y, x);
-	}
+				/* Scent can be laid here */
+				scent_mask[i][j] = TRUE;
+			}
+		}
 
-	/* XXX XXX Disabled the following because it still causes infinite loops */
-#if 0
+		/* Remember */
+		scent_mask_y = py;
+		scent_mask_x = px;
+		scent_mask_epoch = cave_feat_epoch;
+	}
 
-	/* Apply terrain damage to all objects and player in the grid */
-	/* XXX Don't call project as we may be getting called from there. */
-	/* XXX Don't apply damage to monsters as we may lose out on getting experience */
-	/* XXX XXX Be aware, that project_o can cause subsequent changes in terrain type,
-	   resulting in recursion back here. However, we shouldn't have any dangerous
-	   dangling pointers because project_o just marks objects for subsequent destruction,
-	   and careful terrain design should hopefully pick up any infinite loops. */
-	if (f_ptr->blow.effect)
+	/* Lay down new scent */
+	for (i = 0; i < 5; i++)
 	{
-		project_o(0, y, x, damroll(f_ptr->blow.d_dice,f_ptr->blow.d_side), f_ptr->blow.effect);
-		project_p(0, y, x, damroll(f_ptr->blow.d_dice,f_ptr->blow.d_side), f_ptr->blow.effect);
-		project_t(0, y, x, damroll(f_ptr->blow.d_dice,f_ptr->blow.d_side), f_ptr->blow.effect);
+		for (j = 0; j < 5; j++)
+		{
+			if (!scent_mask[i][j]) continue;
+
+			/* Mark the grid with new scent */
+			cave_when[i + py - 2][j + px - 2] = scent_when - scent_adjust[i][j];
+		}
 	}
 
 #endif
 }
 
+
+
 /*
- * Check adjacent locations to see if an attribute that a feature applies
- * to these locations still applies.
- *
- * This occurs for cave edges, trees, locations lit by daylight, locations lit by
- * glowing features etc.
+ * Map all rooms and neighbourhood belonging to a particular
+ * monster's ecology membership. We also show some monsters
+ * which occur in that region.
  */
-void check_attribute_lost(const int y, const int x, const int r, const byte los, tester_attribute_func require_attribute, tester_attribute_func has_attribute,
-	tester_attribute_func redraw_attribute, modify_attribute_func_remove remove_attribute,	modify_attribute_func_reapply reapply_attribute)
+bool map_home(int m_idx)
 {
-	int yy, xx;
-	int yyy, xxx;
+	u32b ecology = 0L;
+	int i, y, x;
 
-	for (yy = y - r; yy <= y + r; yy++)
+	/* No ecology */
+	if (!cave_ecology.ready)
 	{
-		for (xx = x - r; xx <= x + r; xx++)
+		/* Show the whole level instead */
+		wiz_lite();
+		return (TRUE);
+	}
+
+	/* Get the flags */
+	for (i = 0; i < cave_ecology.num_races; i++)
+	{
+		/* This monster exists here */
+		if (cave_ecology.race[i] == m_idx)
 		{
-			/* Ignore annoying locations */
-			if (!in_bounds_fully(yy, xx)) continue;
+			/* Note ecologies */
+			ecology |= cave_ecology.race_ecologies[i];
+		}
+	}
 
-			/* Ignore distance locations */
-			if ((r > 1) && (distance(y, x, yy, xx) > r)) continue;
+	/* Nothing? */
+	if (!ecology)
+	{
+		/* Not a native of these parts */
+		return (FALSE);
+	}
 
-			/* Was destroyed grid only one 'holding this one up' */
-			if (require_attribute(yy, xx))
+	/* Scan that area */
+	for (y = 1; y < DUNGEON_HGT - 1; y++)
+	{
+		for (x = 1; x < DUNGEON_WID - 1; x++)
+		{
+			/* All non-walls are "checked" */
+			if (!(f_info[cave_feat[y][x]].flags1 & (FF1_WALL)))
 			{
-				/* Temporarily remove the attribute from the grid */
-				int rr = remove_attribute(yy, xx);
+				/* Skip if not in the ecology */
+				if ((room_info[room_idx_ignore_valid(y, x)].ecology & (ecology)) == 0) continue;
 
-				/* Check nearby grids to reapply it */
-				for (yyy = yy - r; yyy <= yy + r; yyy++)
+				/* Memorize normal features */
+				if (f_info[cave_feat[y][x]].flags1 & (FF1_REMEMBER))
 				{
-					for (xxx = x - r; xxx <= x + r; xxx++)
-					{
-						/* Ignore annoying locations */
-						if (!in_bounds_fully(yyy, xxx)) continue;
-
-						/* Ignore distance locations */
-						if ((r > 1) && (distance(yy, xx, yyy, xxx) > r)) continue;
-
-						/* Ensure grid has line of sight if required */
-						if ((r > 1) && (los) && !(generic_los(yy, xx, yyy, xxx, los))) continue;
-
-						/* Is supports the 'affected' grid */
-						if (has_attribute(yyy,xxx))
-						{
-							reapply_attribute(yy, xx, rr);
+					/* Memorize the object */
+					play_info[y][x] |= (PLAY_MARK);
+				}
 
-							break;
-						}
-					}
+				/* Memorize known walls */
+				for (i = 0; i < 8; i++)
+				{
+					int yy = y + ddy_ddd[i];
+					int xx = x + ddx_ddd[i];
 
-					/* Require redraw */
-					if (redraw_attribute(yy,xx))
+					/* Memorize walls (etc) */
+					if (f_info[cave_feat[yy][xx]].flags1 & (FF1_REMEMBER))
 					{
-						note_spot(yy, xx);
-						lite_spot(yy, xx);
+						/* Memorize the walls */
+						play_info[yy][xx] |= (PLAY_MARK);
 					}
 				}
-			}
-		}
-	}
-}
 
+				/* Get monster */
+				i = cave_m_idx[y][x];
 
-/*
- * Apply an attribute to nearby locations
+				/* Show monsters */
+				if (i <= 0) continue;
+
+				/* Reveal own kind */
+				if ((r_info[m_list[i].r_idx].d_char == r_info[m_list[m_idx].r_idx].d_char)
+
+					/* Reveal animals, insects, plants */
+					|| ((r_info[i].flags3 & (RF3_ANIMAL | RF3_INSECT | RF3_PLANT)) != 0))
+				{
+					/* Reveal half of monsters */
+					if (i % 2)
+					{
+						/* Optimize -- Repair flags */
+						repair_mflag_mark = repair_mflag_show = TRUE;
+
+						/* Hack -- Detect the monster */
+						m_list[i].mflag |= (MFLAG_MARK | MFLAG_SHOW);
+
+						/* Update the monster */
+						update_mon(i, FALSE);
+					}
+				}
+			}
+		}
+	}
+
+	/* Redraw map */
+	p_ptr->redraw |= (PR_MAP);
+
+	/* Window stuff */
+	p_ptr->window |= (PW_OVERHEAD | PW_MAP);
+
+	return (TRUE);
+}
+
+
+/*
+ * Map a circle ala "magic mapping"
+ *
+ * We must never attempt to map the outer dungeon walls, or we
+ * might induce illegal cave grid references.
  */
-void gain_attribute(int y, int x, int r, byte los, modify_attribute_func apply_attribute, tester_attribute_func redraw_attribute)
+void map_area(void)
 {
-	int yy, xx;
+	int i, x, y, y1, y2, x1, x2, r;
 
-	for (yy = y - r; yy <= y + r; yy++)
+	/* Radius of detection */
+	r = 2 * MAX_SIGHT;
+
+	/* Pick an area to map */
+	y1 = MAX(p_ptr->py - r, 1);
+	y2 = MIN(p_ptr->py + r, DUNGEON_HGT-1);
+	x1 = MAX(p_ptr->px - r, 1);
+	x2 = MIN(p_ptr->px + r, DUNGEON_WID-1);
+
+	/* Scan that area */
+	for (y = y1; y < y2; y++)
 	{
-		for (xx = x - r; xx <= x + r; xx++)
+		for (x = x1; x < x2; x++)
 		{
-			/* Ignore annoying locations */
-			if (!in_bounds_fully(yy, xx)) continue;
+			/* Check distance */
+			if (distance(p_ptr->py, p_ptr->px, y, x) > r) continue;
 
-			/* Ignore distance locations */
-			if ((r > 1) && (distance(y, x, yy, xx) > r)) continue;
+			/* All non-walls are "checked" */
+			if (!(f_info[cave_feat[y][x]].flags1 & (FF1_WALL)))
+			{
 
-			/* Ensure grid has line of sight if required */
-			if ((r > 1) && (los) && !(generic_los(y, x, yy, xx, los))) continue;
+				/* Memorize normal features */
+				if (f_info[cave_feat[y][x]].flags1 & (FF1_REMEMBER))
+				{
+					/* Memorize the object */
+					play_info[y][x] |= (PLAY_MARK);
+				}
 
-			/* Apply attribute */
-			apply_attribute(yy, xx);
+				/* Memorize known walls */
+				for (i = 0; i < 8; i++)
+				{
+					int yy = y + ddy_ddd[i];
+					int xx = x + ddx_ddd[i];
 
-			/* Require redraw */
-			if (redraw_attribute(yy, xx))
-			{
-				note_spot(yy, xx);
-				lite_spot(yy, xx);
+					/* Memorize walls (etc) */
+					if (f_info[cave_feat[yy][xx]].flags1 & (FF1_REMEMBER))
+					{
+						/* Memorize the walls */
+						play_info[yy][xx] |= (PLAY_MARK);
+					}
+				}
 			}
 		}
 	}
+
+	/* Redraw map */
+	p_ptr->redraw |= (PR_MAP);
+
+	/* Window stuff */
+	p_ptr->window |= (PW_OVERHEAD | PW_MAP);
 }
 
 
 
 /*
- * Halo functions
+ * Light up the dungeon using "claravoyance"
+ *
+ * This function "illuminates" every grid in the dungeon, memorizes all
+ * "objects", memorizes all grids as with magic mapping, and, under the
+ * standard option settings (view_perma_grids but not view_torch_grids)
+ * memorizes all floor grids too.
+ *
+ * Note that if "view_perma_grids" is not set, we do not memorize floor
+ * grids, since this would defeat the purpose of "view_perma_grids", not
+ * that anyone seems to play without this option.
+ *
+ * Note that if "view_torch_grids" is set, we do not memorize floor grids,
+ * since this would prevent the use of "view_torch_grids" as a method to
+ * keep track of what grids have been observed directly.
  */
-bool require_halo(int y, int x)
-{
-	return ((cave_info[y][x] & (CAVE_HALO)) != 0);
-}
-
-bool has_halo(int y, int x)
+void wiz_lite(void)
 {
-	int this_o_idx, next_o_idx = 0;
+	int i, y, x;
 
-	/* Glowing feature */
-	if ((f_info[cave_feat[y][x]].flags2 & (FF2_GLOW)) != 0) return TRUE;
 
-	/* Scan all objects in the grid */
-	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
+	/* Memorize objects */
+	for (i = 1; i < o_max; i++)
 	{
-		object_type *o_ptr;
+		object_type *o_ptr = &o_list[i];
 
-		/* Get the object */
-		o_ptr = &o_list[this_o_idx];
+		/* Skip dead objects */
+		if (!o_ptr->k_idx) continue;
 
-		/* Get the next object */
-		next_o_idx = o_ptr->next_o_idx;
+		/* Skip held objects */
+		if (o_ptr->held_m_idx) continue;
 
-		/* Check object lite */
-		if (check_object_lite(o_ptr)) return TRUE;
+		/* Memorize */
+		o_ptr->ident |= (IDENT_MARKED);
 	}
 
-	return FALSE;
-}
+	/* Scan all normal grids */
+	for (y = 1; y < DUNGEON_HGT-1; y++)
+	{
+		/* Scan all normal grids */
+		for (x = 1; x < DUNGEON_WID-1; x++)
+		{
+			/* Process all non-walls */
+			if (!(f_info[cave_feat[y][x]].flags1 & (FF1_WALL)))
+			{
+				/* Scan all neighbors */
+				for (i = 0; i < 9; i++)
+				{
+					int yy = y + ddy_ddd[i];
+					int xx = x + ddx_ddd[i];
 
-bool redraw_halo_loss(int y, int x)
-{
-	return (((play_info[y][x] & (PLAY_VIEW)) && (play_info[y][x] & (PLAY_SEEN))
-	&& !(cave_info[y][x] & (CAVE_LITE)))
-	 || ((view_glowing_lite) && ((cave_info[y][x] & (CAVE_HALO)) == 0)));
-}
+					/* Perma-lite the grid */
+					cave_info[yy][xx] |= (CAVE_GLOW);
 
-bool redraw_halo_gain(int y, int x)
-{
-	return (((play_info[y][x] & (PLAY_VIEW)) && !(play_info[y][x] & (PLAY_SEEN)))
-	 || ((view_glowing_lite) && ((cave_info[y][x] & (CAVE_HALO)) != 0)));
-}
+					/* Memorize normal features */
+					if (f_info[cave_feat[yy][xx]].flags1 & (FF1_REMEMBER))
+					{
+						/* Memorize the grid */
+						play_info[yy][xx] |= (PLAY_MARK);
+					}
 
-void apply_halo(int y, int x)
-{
-	cave_info[y][x] |= (CAVE_HALO);
-	if ((play_info[y][x] & (PLAY_VIEW)) && !(p_ptr->timed[TMD_BLIND])) play_info[y][x] |= (PLAY_SEEN);
-}
+					/* Normally, memorize floors (see above) */
+					if (view_perma_grids && !view_torch_grids)
+					{
+						/* Memorize the grid */
+						play_info[yy][xx] |= (PLAY_MARK);
+					}
+				}
+			}
+		}
+	}
 
-int remove_halo(int y, int x)
-{
-	cave_info[y][x] &= ~(CAVE_HALO);
-	if (!(play_info[y][x] & (PLAY_LITE)) && !(cave_info[y][x] & (CAVE_LITE))) play_info[y][x] &= ~(PLAY_SEEN);	
-	
-	return (0);
-}
+	/* Fully update the visuals */
+	p_ptr->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
 
-void reapply_halo(int y, int x, int r)
-{
-	(void)r;
-	
-	cave_info[y][x] |= (CAVE_HALO);
-	if ((play_info[y][x] & (PLAY_VIEW)) && !(p_ptr->timed[TMD_BLIND])) play_info[y][x] |= (PLAY_SEEN);
+	/* Redraw map */
+	p_ptr->redraw |= (PR_MAP);
+
+	/* Window stuff */
+	p_ptr->window |= (PW_OVERHEAD | PW_MAP | PW_MONLIST);
 }
 
 
 /*
- * Daylight functions
+ * Forget the dungeon map (ala "Thinking of Maud...").
  */
-bool require_daylight(int y, int x)
+void wiz_dark(void)
 {
-	return ((cave_info[y][x] & (CAVE_DLIT)) != 0);
-}
+	int i, y, x;
 
-bool has_daylight(int y, int x)
-{
-	bool daytime = is_daytime();
-	bool outside = (level_flag & (LF1_SURFACE))
-		&& (f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE));
 
-	return (daytime && outside);
-}
+	/* Forget every grid */
+	for (y = 0; y < DUNGEON_HGT; y++)
+	{
+		for (x = 0; x < DUNGEON_WID; x++)
+		{
+			/* Process the grid */
+			play_info[y][x] &= ~(PLAY_MARK);
+		}
+	}
 
-bool redraw_daylight_loss(int y, int x)
-{
-	return (((play_info[y][x] & (PLAY_VIEW)) && (play_info[y][x] & (PLAY_SEEN))
-	&& !(cave_info[y][x] & (CAVE_LITE)))
-	 || ((view_glowing_lite) && ((cave_info[y][x] & (CAVE_DLIT)) == 0)));
-}
+	/* Forget all objects */
+	for (i = 1; i < o_max; i++)
+	{
+		object_type *o_ptr = &o_list[i];
 
-bool redraw_daylight_gain(int y, int x)
-{
-	return (((play_info[y][x] & (PLAY_VIEW)) && !(play_info[y][x] & (PLAY_SEEN)))
-	 || ((view_glowing_lite) && ((cave_info[y][x] & (CAVE_DLIT)) != 0)));
-}
+		/* Skip dead objects */
+		if (!o_ptr->k_idx) continue;
 
-void apply_daylight(int y, int x)
-{
-	cave_info[y][x] |= (CAVE_HALO);
-	if ((play_info[y][x] & (PLAY_VIEW)) && !(p_ptr->timed[TMD_BLIND])) play_info[y][x] |= (PLAY_SEEN);
-}
+		/* Skip held objects */
+		if (o_ptr->held_m_idx) continue;
 
-int remove_daylight(int y, int x)
-{
-	cave_info[y][x] &= ~(CAVE_DLIT);
-	if (!(play_info[y][x] & (PLAY_LITE)) && !(cave_info[y][x] & (CAVE_LITE))) play_info[y][x] &= ~(PLAY_SEEN);
-	
-	return (0);
-}
+		/* Forget the object */
+		o_ptr->ident &= ~(IDENT_MARKED);
+	}
 
-void reapply_daylight(int y, int x, int r)
-{
-	(void)r;
-	
-	cave_info[y][x] |= (CAVE_DLIT);
-	if ((play_info[y][x] & (PLAY_VIEW)) && !(p_ptr->timed[TMD_BLIND])) play_info[y][x] |= (PLAY_SEEN);
+	/* Fully update the visuals */
+	p_ptr->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
+
+	/* Redraw map */
+	p_ptr->redraw |= (PR_MAP);
+
+	/* Window stuff */
+	p_ptr->window |= (PW_OVERHEAD | PW_MAP | PW_MONLIST);
 }
 
 
+
 /*
- * Climb-able functions
- *
- * Optimisation for placement of monsters which can climb terrain.
+ * Light or Darken the town
  */
-bool require_climb(int y, int x)
-{
-	return ((cave_info[y][x] & (CAVE_CLIM)) != 0);
-}
-
-bool has_climb(int y, int x)
+void town_illuminate(bool daytime)
 {
-	return ((f_info[cave_feat[y][x]].flags2 & (FF2_CAN_CLIMB)) != 0);
-}
+	int y, x, i;
 
-bool redraw_climb_loss(int y, int x)
-{
-	(void)y;
-	(void)x;
-	return FALSE;
-}
+	town_type *t_ptr = &t_info[p_ptr->dungeon];
 
-bool redraw_climb_gain(int y, int x)
-{
-	(void)y;
-	(void)x;
-	return FALSE;
-}
+	dungeon_zone *zone=&t_ptr->zone[0];
 
-void apply_climb(int y, int x)
-{
-	cave_info[y][x] |= (CAVE_CLIM);
-}
+	int dungeon_hgt, dungeon_wid;
 
-int remove_climb(int y, int x)
-{
-	cave_info[y][x] &= ~(CAVE_CLIM);
-	
-	return (0);
-}
+	/* Get the zone */
+	get_zone(&zone,p_ptr->dungeon,p_ptr->depth);
 
-void reapply_climb(int y, int x, int r)
-{
-	(void)r;
-	
-	cave_info[y][x] |= (CAVE_CLIM);
-}
+	dungeon_hgt = (level_flag & (LF1_TOWN)) != 0 ? TOWN_HGT : DUNGEON_HGT;
+	dungeon_wid = (level_flag & (LF1_TOWN)) != 0 ? TOWN_WID : DUNGEON_WID;
 
+	/* Darken at night */
+	for (y = 0; y < dungeon_hgt; y++)
+	{
+		for (x = 0; x < dungeon_wid; x++)
+		{
+			/* Light outside and adjacent indoors */
+			if ((!daytime) || ((f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE)) == 0))
+			{
+				/* Darken the grid */
+				cave_info[y][x] &= ~(CAVE_DLIT);
+			}
+		}
+	}
 
-/*
- * Chasm edge -> chasm functions
- */
-bool require_chasm_edge(int y, int x)
-{
-	return (((f_info[cave_feat[y][x]].flags2 & (FF2_CHASM)) != 0) && (cave_feat[y][x] != FEAT_CHASM));
-}
+	/* Apply light during day */
+	if (daytime) for (y = 0; y < dungeon_hgt; y++)
+	{
+		for (x = 0; x < dungeon_wid; x++)
+		{
+			/* Location is outside */
+			if (((f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE)) != 0)
 
-bool has_chasm_edge(int y, int x)
-{
-	return ((cave_feat[y][x] != FEAT_NONE) &&
-			((f_info[cave_feat[y][x]].flags2 & (FF2_CHASM)) == 0) &&
-			 ((f_info[cave_feat[y][x]].flags2 & (FF2_COVERED)) == 0));
-}
+				/* or light rooms lit by daylight */
+				|| ((room_has_flag(y, x, ROOM_DAYLITE)) != 0))
+			{
+				/* Illuminate the grid */
+				cave_info[y][x] |= (CAVE_DLIT);
 
-bool redraw_chasm_edge_loss(int y, int x)
-{
-	(void)y;
-	(void)x;
+				for (i = 0; i < 8; i++)
+				{
+					int yy = y + ddy_ddd[i];
+					int xx = x + ddx_ddd[i];
 
-	return (FALSE);
-}
+					/* Ignore annoying locations */
+					if (!in_bounds(yy, xx)) continue;
 
-bool redraw_chasm_edge_gain(int y, int x)
-{
-	(void)y;
-	(void)x;
+					/* Illuminate the grid */
+					cave_info[yy][xx] |= (CAVE_DLIT);
+				}
+			}
+		}
+	}
 
-	return (FALSE);
-}
+	/* XXX WARNING:
+	 *
+	 * Town_illuminate is called once whilst loading a character.
+	 *
+	 * The following will cause a monster to be generated before loading
+	 * the monsters, and cause the save file to fail to load.
+	 *
+	 * Therefore we need to ensure that the character is loaded first.
+	 *
+	 */
 
-void apply_chasm_edge(int y, int x)
-{
-	if (cave_feat[y][x] == FEAT_CHASM)
+	/* Megahack --- darkness brings out the bad guys */
+	if ((character_loaded) && (!daytime) && actual_guardian(zone->guard, p_ptr->dungeon, zone - t_ptr->zone) && (r_info[actual_guardian(zone->guard, p_ptr->dungeon, zone - t_ptr->zone)].cur_num <= 0))
 	{
-		cave_set_feat_aux(y, x, FEAT_CHASM_E);
+		/* Place the guardian */
+		place_guardian(1, 1, dungeon_hgt- 1, dungeon_wid -1);
 	}
-}
 
-int remove_chasm_edge(int y, int x)
-{
-	int r = cave_feat[y][x];
+	/* Fully update the visuals */
+	p_ptr->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
 
-	cave_set_feat_aux(y, x, FEAT_CHASM);
-	
-	return (r);
-}
+	/* Redraw map */
+	p_ptr->redraw |= (PR_MAP);
 
-void reapply_chasm_edge(int y, int x, int r)
-{
-	cave_set_feat_aux(y, x, r);
+	/* Window stuff */
+	p_ptr->window |= (PW_OVERHEAD | PW_MONLIST | PW_MAP);
 }
 
 
+
 /*
- * Need tree functions
+ * Allocate the grid arrays for a level, as one block of memory with
+ * every row aligned to a cache line.
  */
-bool require_tree(int y, int x)
+level_type *level_alloc(void)
 {
-	return ((f_info[cave_feat[y][x]].flags3 & (FF3_NEED_TREE)) != 0);
-}
+	byte *block = C_ZNEW(sizeof(level_type) + LEVEL_ALIGN, byte);
+	level_type *l;
 
-bool has_tree(int y, int x)
-{
-	return (((f_info[cave_feat[y][x]].flags3 & (FF3_TREE)) !=0) && (rand_int(100) < 50));
-}
+	/* Align the level within the block */
+	l = (level_type *)(block + ((LEVEL_ALIGN - ((unsigned long)block % LEVEL_ALIGN)) % LEVEL_ALIGN));
 
-bool redraw_tree_loss(int y, int x)
-{
-	(void)y;
-	(void)x;
+	/* Remember the block */
+	l->block = block;
 
-	return (FALSE);
+	return (l);
 }
 
-bool redraw_tree_gain(int y, int x)
+
+/*
+ * Free the grid arrays for a level
+ */
+void level_free(level_type *l)
 {
-	(void)y;
-	(void)x;
+	/* The level lives inside the block */
+	mem_free(l->block);
+}
 
-	return (FALSE);
+
+/*
+ * Wipe all the grid arrays for a level at once
+ */
+void level_wipe(level_type *l)
+{
+	(void)memset(l, 0, offsetof(level_type, block));
 }
 
-int remove_tree(int y, int x)
+
+/*
+ * Make the cave arrays point to the grid arrays of a level
+ */
+void cave_level_set(level_type *l)
 {
-	int r = cave_feat[y][x];
+	cave_info = l->cave_info;
+	play_info = l->play_info;
+	cave_feat = l->cave_feat;
+	cave_o_idx = l->cave_o_idx;
+	cave_m_idx = l->cave_m_idx;
+	cave_region_piece = l->cave_region_piece;
 
-	cave_set_feat_aux(y, x, feat_state(r, FS_NEED_TREE));
-	
-	return (r);
+#ifdef MONSTER_FLOW
+	cave_cost = l->cave_cost;
+	cave_when = l->cave_when;
+#endif /* MONSTER_FLOW */
 }
 
-void reapply_tree(int y, int x, int r)
+
+/*
+ * Work out the passability bitmaps for a grid from its terrain.
+ *
+ * Monsters see the real feature.  The player only knows the mimiced
+ * feature, so "PASS_SAFE" and "PASS_ALTER" are worked out from that.
+ */
+void cave_pass_update(int y, int x)
 {
-	cave_set_feat_aux(y, x, r);
+	feature_type *f_ptr = &f_info[cave_feat[y][x]];
+	feature_type *f2_ptr = &f_info[f_ptr->mimic];
+
+	u32b bit = (1L << (x & 31));
+	int w = x >> 5;
+
+	bool walk = (f_ptr->flags1 & (FF1_MOVE)) != 0;
+	bool climb = (f_ptr->flags3 & (FF3_EASY_CLIMB)) != 0;
+	bool fly = (f_ptr->flags2 & (FF2_CAN_FLY)) != 0;
+	bool swim = (f_ptr->flags2 & (FF2_CAN_SWIM)) != 0;
+	bool dig = (f_ptr->flags2 & (FF2_CAN_DIG)) != 0;
+	bool ooze = (f_ptr->flags2 & (FF2_CAN_OOZE)) != 0;
+	bool safe, alter;
+
+	/* Player can walk over the known feature without harm */
+	safe = (((f2_ptr->flags1 & (FF1_MOVE)) != 0) || ((f2_ptr->flags3 & (FF3_EASY_CLIMB)) != 0)) &&
+		!(f2_ptr->blow.method) && !(f2_ptr->spell) &&
+		!(f2_ptr->flags2 & (FF2_DEEP | FF2_FILLED));
+
+	/* Player can disarm or open the known feature */
+	alter = ((f2_ptr->flags1 & (FF1_DISARM)) != 0) ||
+		(!(f2_ptr->flags1 & (FF1_MOVE)) && !(f2_ptr->flags3 & (FF3_EASY_CLIMB)) &&
+		 ((f2_ptr->flags1 & (FF1_OPEN)) != 0));
+
+	/* Clear the grid */
+	cave_pass[PASS_WALK][y][w] &= ~(bit);
+	cave_pass[PASS_SWIM][y][w] &= ~(bit);
+	cave_pass[PASS_FLY][y][w] &= ~(bit);
+	cave_pass[PASS_CLIMB][y][w] &= ~(bit);
+	cave_pass[PASS_WALL][y][w] &= ~(bit);
+	cave_pass[PASS_DIG][y][w] &= ~(bit);
+	cave_pass[PASS_OOZE][y][w] &= ~(bit);
+	cave_pass[PASS_MOVE][y][w] &= ~(bit);
+	cave_pass[PASS_SAFE][y][w] &= ~(bit);
+	cave_pass[PASS_ALTER][y][w] &= ~(bit);
+
+	/* Set the grid */
+	if (walk) cave_pass[PASS_WALK][y][w] |= (bit);
+	if (swim) cave_pass[PASS_SWIM][y][w] |= (bit);
+	if (fly) cave_pass[PASS_FLY][y][w] |= (bit);
+	if (climb) cave_pass[PASS_CLIMB][y][w] |= (bit);
+	if (f_ptr->flags2 & (FF2_CAN_PASS)) cave_pass[PASS_WALL][y][w] |= (bit);
+	if (dig) cave_pass[PASS_DIG][y][w] |= (bit);
+	if (ooze) cave_pass[PASS_OOZE][y][w] |= (bit);
+	if (walk || climb || fly || swim || dig || ooze) cave_pass[PASS_MOVE][y][w] |= (bit);
+	if (safe) cave_pass[PASS_SAFE][y][w] |= (bit);
+	if (alter) cave_pass[PASS_ALTER][y][w] |= (bit);
 }
 
 
-void set_level_flags(int feat)
+/*
+ * Work out the passability bitmaps for the whole level.
+ *
+ * This is needed whenever the terrain has been set directly,
+ * rather than through "cave_set_feat()".
+ */
+void cave_pass_rebuild(void)
 {
-	feature_type *f_ptr = &f_info[feat];
+	int y, x;
 
-	/* Set the level type */
-	if (f_ptr->flags2 & (FF2_WATER)) level_flag |= (LF1_WATER);
-	if (f_ptr->flags2 & (FF2_LAVA)) level_flag |= (LF1_LAVA);
-	if (f_ptr->flags2 & (FF2_ICE)) level_flag |= (LF1_ICE);
-	if (f_ptr->flags2 & (FF2_ACID)) level_flag |= (LF1_ACID);
-	if (f_ptr->flags2 & (FF2_OIL)) level_flag |= (LF1_OIL);
-	if (f_ptr->flags2 & (FF2_CHASM)) level_flag |= (LF1_CHASM);
-	if (f_ptr->flags3 & (FF3_LIVING)) level_flag |= (LF1_LIVING);
+	for (y = 0; y < DUNGEON_HGT; y++)
+	{
+		for (x = 0; x < DUNGEON_WID; x++)
+		{
+			cave_pass_update(y, x);
+		}
+	}
 }
 
 
-
 /*
- * Change the "feat" flag for a grid, and notice/redraw the grid
+ * Hack -- Really change the feature
  */
-void cave_set_feat(const int y, const int x, int feat)
+void cave_set_feat_aux(const int y, const int x, int feat)
 {
-	int i;
+	/* Set if blocks los */
+	bool los = cave_floor_bold(y,x);
 
-	int oldfeat = cave_feat[y][x];
+	/* Get feature */
+	feature_type *f_ptr = &f_info[feat];
 
-	feature_type *f_ptr = &f_info[oldfeat];
-	feature_type *f_ptr2 = &f_info[feat];
+	/* Set if dynamic */
+	bool dyna = (f_info[cave_feat[y][x]].flags3 & (FF3_DYNAMIC_MASK)) != 0;
 
-	bool surface = (bool)((level_flag & (LF1_SURFACE)));
-	bool daytime = (bool)(level_flag & (LF1_DAYLIGHT));
-
-	bool halo = (f_ptr->flags2 & FF2_GLOW) != 0;
-	bool halo2 = (f_ptr2->flags2 & FF2_GLOW) != 0;
+	bool hide_item = (f_info[cave_feat[y][x]].flags2 & (FF2_HIDE_ITEM)) != 0;
 
-	bool dlit = daytime && surface && (f_ptr->flags3 & (FF3_OUTSIDE));
-	bool dlit2 = daytime && surface && (f_ptr2->flags3 & (FF3_OUTSIDE));
+	bool use_feat = (f_info[cave_feat[y][x]].flags3 & (FF3_USE_FEAT)) != 0 ? f_info[cave_feat[y][x]].k_idx : 0;
 
-	bool tree = (f_ptr->flags3 & (FF3_TREE)) !=0;
-	bool tree2 = (f_ptr2->flags3 & (FF3_TREE)) != 0;
+	s16b this_o_idx, next_o_idx = 0;
 
-	bool climb = (f_ptr->flags2 & (FF2_CAN_CLIMB)) !=0;
-	bool climb2 = (f_ptr2->flags2 & (FF2_CAN_CLIMB)) !=0;
+	/* Paranoia */
+	if ((feat > z_info->f_max) || (y < 0) || (y > DUNGEON_HGT) || (x < 0) || (x > DUNGEON_WID))
+	{
+		msg_format("Error: Setting invalid feat %d at (%d, %d).", feat, y, x);
+		return;
+	}
 
-	bool los =  (f_ptr->flags1 & (FF1_LOS)) !=0;
-	bool los2 =  (f_ptr2->flags1 & (FF1_LOS)) !=0;
+	/* Paranoia */
+	if (((f_info[feat].flags1 & (FF1_ENTER)) != 0) && ((level_flag & (LF1_TOWN)) == 0))
+	{
+		msg_format("BUG: Setting store %d at (%d, %d) outside of a town level.", feat, y, x);
+		return;
+	}
 
-	bool project =  (f_ptr->flags1 & (FF1_PROJECT)) !=0;
-	bool project2 =  (f_ptr2->flags1 & (FF1_PROJECT)) !=0;
+	/* Really set the feature */
+	cave_feat[y][x] = feat;
 
-	bool trap = (f_ptr->flags1 & (FF1_TRAP)) !=0;
-	bool trap2 = (f_ptr2->flags1 & (FF1_TRAP)) !=0;
+	/* Terrain has changed */
+	cave_feat_epoch++;
 
-	bool chasm_edge = ((f_ptr->flags2 & (FF2_CHASM | FF2_COVERED)) ==0) && (cave_feat[y][x] != FEAT_NONE);
-	bool chasm_edge2 = (f_ptr2->flags2 & (FF2_CHASM | FF2_COVERED)) ==0;
+	/* Update passability */
+	cave_pass_update(y, x);
 
-	/* Change the feature */
-	cave_set_feat_aux(y,x,feat);
+#ifdef MONSTER_FLOW
+	/* Update the flow (noise) costs */
+	update_noise_grid(y, x);
+#endif /* MONSTER_FLOW */
 
-	/* Handle destroying "glowing" terrain */
-	if (halo && !halo2)
+	/* Check for line of sight */
+	if (f_ptr->flags1 & (FF1_LOS))
 	{
-		check_attribute_lost(y, x, 2, CAVE_XLOS, require_halo, has_halo, redraw_halo_loss, remove_halo, reapply_halo);
+		cave_info[y][x] &= ~(CAVE_XLOS);
 	}
 
-	/* Handle destroying "outside" terrain */
-	if (dlit && !dlit2)
+	/* Handle wall grids */
+	else
 	{
-		check_attribute_lost(y, x, 2, CAVE_XLOS, require_daylight, has_daylight, redraw_daylight_loss, remove_daylight, reapply_daylight);
+		cave_info[y][x] |= (CAVE_XLOS);
 	}
 
-	/* Handle destroying "climb-able terrain */
-	if (climb && !climb2)
+	/* Check for line of fire */
+	if (f_ptr->flags1 & (FF1_PROJECT))
 	{
-		check_attribute_lost(y, x, 1, 0, require_climb, has_climb, redraw_climb_loss, remove_climb, reapply_climb);
+		cave_info[y][x] &= ~(CAVE_XLOF);
 	}
 
-	/* Handle removing chasms */
-	if (chasm_edge && !chasm_edge2)
+	/* Handle wall grids */
+	else
 	{
-		check_attribute_lost(y, x, 1, 0, require_chasm_edge, has_chasm_edge, redraw_chasm_edge_loss, remove_chasm_edge, reapply_chasm_edge);
+		cave_info[y][x] |= (CAVE_XLOF);
 	}
 
-	/* Handle destroying "need_tree" terrain */
-	if (tree && !tree2)
-	{
-		/* For correctness, we need to check if daylight is added to any adjacent location by branches falling */
-		/* Should check more than this if we ever really mess with terrain.txt XXX */
-		byte dlit_adj = 0;
+	/* Check for change to boring grid */
+	if (!(f_ptr->flags1 & (FF1_REMEMBER))) play_info[y][x] &= ~(PLAY_MARK);
 
-		/* If in daylight on surface */
-		if (daytime && surface) for (i = 0; i < 8; i++)
-		{
-			int yy = y + ddy_ddd[i];
-			int xx = x + ddx_ddd[i];
+	/* Check for change to out of sight grid */
+	else if (!(player_can_see_bold(y,x))) play_info[y][x] &= ~(PLAY_MARK);
 
-     		/* Ignore annoying locations */
-			if (!in_bounds_fully(yy, xx)) continue;
+	/* Check if adding to dynamic list */
+	if (!dyna && (f_ptr->flags3 & (FF3_DYNAMIC_MASK)))
+	{
+		if (dyna_n >= (DYNA_MAX -1))
+		{
+			dyna_full = TRUE;
 
-			/* Record daylight */
-			if ((f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE)) != 0)
-				dlit_adj |= 1 << i;
+			/* Hack to force rebuild */
+			dyna_cent_y = 255;
+			dyna_cent_x = 255;
 		}
-
-		/* Cause branches to fall */
-		check_attribute_lost(y, x, 1, 0, require_tree, has_tree, redraw_tree_loss, remove_tree, reapply_tree);
-
-		/* Check if daylight added */
-		if (daytime && surface) for (i = 0; i < 8; i++)
+		else
 		{
-			int yy = y + ddy_ddd[i];
-			int xx = x + ddx_ddd[i];
-
-     		/* Ignore annoying locations */
-			if (!in_bounds_fully(yy, xx)) continue;
+			dyna_g[dyna_n++] = GRID(y,x);
+		}
+	}
+	/* Check if removing from dynamic list */
+	else if (dyna && !(f_ptr->flags3 & (FF3_DYNAMIC_MASK)))
+	{
+		int i;
 
-			/* Check if additional daylight */
-			if (((dlit_adj & (1 << i)) != 0) && ((f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE)) != 0))
-			{
-				/* Add more light */
-				gain_attribute(yy, xx, 2, CAVE_XLOS, apply_daylight, redraw_daylight_gain);
-			}
+		for (i = 0; i < dyna_n; i++)
+		if (dyna_g[i] == GRID(y,x))
+		{
+			dyna_n--;
+			dyna_g[i] = dyna_g[dyna_n];
 		}
 	}
 
-	/* Handle disarming traps if required */
-	if (trap && !trap2)
+	/* Check to see if monster exposed by change */
+	if (cave_m_idx[y][x] > 0)
 	{
-		for (i = 0; i < region_max; i++)
+		monster_type *m_ptr = &m_list[cave_m_idx[y][x]];
+
+		bool hidden = ((m_ptr->mflag & (MFLAG_HIDE)) != 0);
+
+		if (hidden)
 		{
-			/* Get the region */
-			region_type *r_ptr = &region_list[i];
+			monster_hide(y, x, place_monster_here(y, x, m_ptr->r_idx), m_ptr);
 
-			/* Delete traps */
-			if (((r_ptr->flags1 & (RE1_HIT_TRAP)) != 0) && (r_ptr->y0 == y) && (r_ptr->x0 == x))
+			if (!(m_ptr->mflag & (MFLAG_HIDE)))
 			{
-				/* Kill the region */
-				region_terminate(i);
+				/* And update */
+				update_mon(cave_m_idx[y][x],FALSE);
 
-				continue;
+				/* Hack --- tell the player if something unhides */
+				if (m_ptr->ml)
+				{
+					char m_name[80];
+
+					/* Get the monster name */
+					monster_desc(m_name, sizeof(m_name), cave_m_idx[y][x], 0);
+
+					msg_format("%^s emerges from %s%s.",m_name,
+						((f_info[cave_feat[m_ptr->fy][m_ptr->fx]].flags2 & (FF2_FILLED))?"":"the "),
+						f_name+f_info[cave_feat[m_ptr->fy][m_ptr->fx]].name);
+				}
+
+				/* Disturb on "move" */
+				if ((m_ptr->ml &&
+				    (disturb_move ||
+				     ((m_ptr->mflag & (MFLAG_VIEW)) &&
+				      disturb_near)))
+				      	&& ((m_ptr->mflag & (MFLAG_ALLY)) == 0))
+
+				{
+					/* Disturb */
+					disturb(0, 0);
+				}
 			}
 		}
 	}
 
-	/* Handle updating regions if required */
-	if ((los && !los2) || (!los && los2) || (project && !project2) || (!project && project2))
+	/* Scan all objects in the grid */
+	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
 	{
-		s16b this_region_piece, next_region_piece = 0;
-
-		for (this_region_piece = cave_region_piece[y][x]; this_region_piece; this_region_piece = next_region_piece)
-		{
-			/* Get the region piece */
-			region_piece_type *rp_ptr = &region_piece_list[this_region_piece];
-
-			/* Get the region */
-			region_type *r_ptr = &region_list[rp_ptr->region];
+		object_type *o_ptr;
 
-			/* Get the method */
-			method_type *method_ptr = &method_info[r_ptr->method];
+		/* Get the object */
+		o_ptr = &o_list[this_o_idx];
 
-			/* Get the next object */
-			next_region_piece = rp_ptr->next_in_grid;
+		/* Get the next object */
+		next_o_idx = o_ptr->next_o_idx;
 
-			/* Skip regions that don't need updating */
-			if (((r_ptr->flags1 & (RE1_PROJECTION)) == 0) || ((r_ptr->flags1 & (RE1_LINGER)) != 0)) continue;
+		/* Hide stuff */
+		if ((!hide_item) && (f_ptr->flags2 & (FF2_HIDE_ITEM)))
+		{
+			/* Hide it */
+			o_ptr->ident &= ~(IDENT_MARKED);
+		}
 
-			/* Refresh the region if projection changes */
-			if ((project != project2) && ((method_ptr->flags1 & (PROJECT_LOS | PROJECT_PASS)) == 0))
+		/* Destroy stored items */
+		if (o_ptr->ident & (IDENT_STORE))
+		{
+			/* Destroy anything that has a 'used' object that never really exists */
+			if (use_feat && (!(f_ptr->flags3 & (FF3_USE_FEAT)) || (use_feat != f_ptr->k_idx)))
 			{
-				/* Update the region */
-				region_update(rp_ptr->region);
+				  delete_object_idx(this_o_idx);
 			}
-			/* Use line of sight instead */
-			else if ((los != los2) && ((method_ptr->flags1 & (PROJECT_LOS)) != 0))
+			/* Reveal other objects from e.g. traps */
+			else if (!use_feat)
 			{
-				/* Update the region */
-				region_update(rp_ptr->region);
+				o_ptr->ident &= ~IDENT_STORE;
+
+				/* Window flags */
+				p_ptr->window |= (PW_ITEMLIST);
 			}
+			continue;
 		}
 	}
 
-	/* Set the level flags based on the feature */
-	set_level_flags(feat);
-
-	/* Handle creating "glowing" terrain */
-	if (!halo && halo2)
-	{
-		gain_attribute(y, x, 2, CAVE_XLOS, apply_halo, redraw_halo_gain);
-	}
-
-	/* Handle creating terrain lit by "daylight" */
-	if (!dlit && dlit2)
+	/* Check if los has changed */
+	if ((los) && (player_has_los_bold(y,x)) && !(cave_floor_bold(y,x)))
 	{
-		gain_attribute(y, x, 1, CAVE_XLOS, apply_daylight, redraw_daylight_gain);
+		/* Update the visuals */
+		p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 	}
-
-	/* Handle creating "climb-able terrain */
-	if (!climb && climb2)
+	else if ((!los) && (player_has_los_bold(y,x)) && (cave_floor_bold(y,x)))
 	{
-		gain_attribute(y, x, 2, 0, apply_climb, redraw_climb_gain);
+		/* Update the visuals */
+		p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 	}
 
-	/* Handle creating chasms */
-	if (!chasm_edge && chasm_edge2)
+	/* Check if location changed under player */
+	if ((p_ptr->py == y) && (p_ptr->px == x))
 	{
-		gain_attribute(y, x, 1, 0, apply_chasm_edge, redraw_chasm_edge_gain);
-	}
+		bool outside = (level_flag & (LF1_SURFACE)) &&
+			(f_info[feat].flags3 & (FF3_OUTSIDE));
 
-	/* Handle gold/items */
-	if (((f_ptr->flags1 & FF1_HAS_ITEM) && !(f_ptr2->flags1 & (FF1_HAS_ITEM)))
-		|| ((f_ptr->flags1 & FF1_HAS_GOLD) && !(f_ptr2->flags1 & (FF1_HAS_GOLD))))
-	{
-		int number = 0;
-		int j;
+		/* Recalculate bonuses */
+		p_ptr->update |= (PU_BONUS);
 
-		bool good = (f_ptr->flags3 & (FF3_DROP_GOOD)) ? TRUE : FALSE;
-		bool great = (f_ptr->flags3 & (FF3_DROP_GREAT)) ? TRUE : FALSE;
+		/* Changed inside/outside */
+		if (outside != p_ptr->outside)
+		{
+ 			p_ptr->redraw |= (PR_MAP);
 
-		bool do_item = ((f_ptr->flags1 & FF1_HAS_ITEM) && !(f_ptr->flags2 & (FF1_HAS_ITEM)));
-		bool do_gold = ((f_ptr->flags1 & FF1_HAS_GOLD) && !(f_ptr->flags2 & (FF1_HAS_GOLD)));
+ 			p_ptr->window |= (PW_OVERHEAD | PW_MAP);
+		}
 
-		object_type *i_ptr;
-		object_type object_type_body;
+		/* Change state */
+		p_ptr->outside = outside;
+	}
 
-		if (f_ptr->flags3 & (FF3_DROP_1D2)) number += damroll(1, 2);
-		if (f_ptr->flags3 & (FF3_DROP_1D3)) number += damroll(1, 3);
+	if (player_has_los_bold(y,x))
+	{
+		/* Notice */
+		note_spot(y, x);
 
-		/* Always drop something */
-		if (!number) number = 1;
+		/* Redraw */
+		lite_spot(y, x);
+	}
 
-		/* Opening a chest -- this forces tval_drop_idx to be set after first item selected */
-		opening_chest = TRUE;
+	/* XXX XXX Disabled the following because it still causes infinite loops */
+#if 0
 
-		/* Drop some objects */
-		for (j = 0; j < number; j++)
+	/* Apply terrain damage to all objects and player in the grid */
+	/* XXX Don't call project as we may be getting called from there. */
+	/* XXX Don't apply damage to monsters as we may lose out on getting experience */
+	/* XXX XXX Be aware, that project_o can cause subsequent changes in terrain type,
+	   resulting in recursion back here. However, we shouldn't have any dangerous
+	   dangling pointers because project_o just marks objects for subsequent destruction,
+	   and careful terrain design should hopefully pick up any infinite loops. */
+	if (f_ptr->blow.effect)
+	{
+		project_o(0, y, x, damroll(f_ptr->blow.d_dice,f_ptr->blow.d_side), f_ptr->blow.effect);
+		project_p(0, y, x, damroll(f_ptr->blow.d_dice,f_ptr->blow.d_side), f_ptr->blow.effect);
+		project_t(0, y, x, damroll(f_ptr->blow.d_dice,f_ptr->blow.d_side), f_ptr->blow.effect);
+	}
+
+#endif
+}
+
+/*
+ * Check adjacent locations to see if an attribute that a feature applies
+ * to these locations still applies.
+ *
+ * This occurs for cave edges, trees, locations lit by daylight, locations lit by
+ * glowing features etc.
+ */
+void check_attribute_lost(const int y, const int x, const int r, const byte los, tester_attribute_func require_attribute, tester_attribute_func has_attribute,
+	tester_attribute_func redraw_attribute, modify_attribute_func_remove remove_attribute,	modify_attribute_func_reapply reapply_attribute)
+{
+	int yy, xx;
+	int yyy, xxx;
+
+	for (yy = y - r; yy <= y + r; yy++)
+	{
+		for (xx = x - r; xx <= x + r; xx++)
 		{
-			/* Get local object */
-			i_ptr = &object_type_body;
+			/* Ignore annoying locations */
+			if (!in_bounds_fully(yy, xx)) continue;
 
-			/* Wipe the object */
-			object_wipe(i_ptr);
+			/* Ignore distance locations */
+			if ((r > 1) && (distance(y, x, yy, xx) > r)) continue;
 
-			/* Make Gold */
-			if (do_gold && (!do_item || (rand_int(100) < 50)))
+			/* Was destroyed grid only one 'holding this one up' */
+			if (require_attribute(yy, xx))
 			{
-				/* Make some gold */
-				if (!make_gold(i_ptr, good, great)) continue;
-			}
+				/* Temporarily remove the attribute from the grid */
+				int rr = remove_attribute(yy, xx);
 
-			/* Make Object */
-			else
-			{
-				/* Make an object */
-				if (!make_object(i_ptr, good, great)) continue;
-			}
+				/* Check nearby grids to reapply it */
+				for (yyy = yy - r; yyy <= yy + r; yyy++)
+				{
+					for (xxx = x - r; xxx <= x + r; xxx++)
+					{
+						/* Ignore annoying locations */
+						if (!in_bounds_fully(yyy, xxx)) continue;
 
-			/* No longer opening a chest */
-			opening_chest = FALSE;
+						/* Ignore distance locations */
+						if ((r > 1) && (distance(yy, xx, yyy, xxx) > r)) continue;
 
-			/* Mark the origin */
-			i_ptr->origin = ORIGIN_FEAT;
-			i_ptr->origin_depth = p_ptr->depth;
+						/* Ensure grid has line of sight if required */
+						if ((r > 1) && (los) && !(generic_los(yy, xx, yyy, xxx, los))) continue;
 
-			/* Drop it in the dungeon */
-			drop_near(i_ptr, -1, y, x, TRUE);
-		}
+						/* Is supports the 'affected' grid */
+						if (has_attribute(yyy,xxx))
+						{
+							reapply_attribute(yy, xx, rr);
 
-		/* Clear drop restriction */
-		tval_drop_idx = 0;
+							break;
+						}
+					}
+
+					/* Require redraw */
+					if (redraw_attribute(yy,xx))
+					{
+						note_spot(yy, xx);
+						lite_spot(yy, xx);
+					}
+				}
+			}
+		}
 	}
 }
 
 
 /*
- * Take a feature, determine what that feature becomes
- * through applying the given action.
+ * Apply an attribute to nearby locations
  */
-int feat_state(int feat, int action)
+void gain_attribute(int y, int x, int r, byte los, modify_attribute_func apply_attribute, tester_attribute_func redraw_attribute)
 {
-	int newfeat=feat;
-	int i;
-
-	/* Permanent stuff never gets changed */
-	/* Hack -- ignore for less and more. This is required to reverse stair directions. */
-	if ((f_info[feat].flags1 & FF1_PERMANENT) && (action != FS_LESS) && (action != FS_MORE)) return (feat);
-
-	/* Set default feat */
-	newfeat = f_info[feat].defaults;
+	int yy, xx;
 
-	/* Get the new feature */
-	for (i=0;i<MAX_FEAT_STATES;i++)
+	for (yy = y - r; yy <= y + r; yy++)
 	{
-		if (f_info[feat].state[i].action == action)
+		for (xx = x - r; xx <= x + r; xx++)
 		{
-			newfeat = f_info[feat].state[i].result;
-			break;
+			/* Ignore annoying locations */
+			if (!in_bounds_fully(yy, xx)) continue;
+
+			/* Ignore distance locations */
+			if ((r > 1) && (distance(y, x, yy, xx) > r)) continue;
+
+			/* Ensure grid has line of sight if required */
+			if ((r > 1) && (los) && !(generic_los(y, x, yy, xx, los))) continue;
+
+			/* Apply attribute */
+			apply_attribute(yy, xx);
+
+			/* Require redraw */
+			if (redraw_attribute(yy, xx))
+			{
+				note_spot(yy, xx);
+				lite_spot(yy, xx);
+			}
 		}
 	}
+}
 
-	/* Paranoia */
-	if (newfeat > z_info->f_max)
+
+
+/*
+ * Halo functions
+ */
+bool require_halo(int y, int x)
+{
+	return ((cave_info[y][x] & (CAVE_HALO)) != 0);
+}
+
+bool has_halo(int y, int x)
+{
+	int this_o_idx, next_o_idx = 0;
+
+	/* Glowing feature */
+	if ((f_info[cave_feat[y][x]].flags2 & (FF2_GLOW)) != 0) return TRUE;
+
+	/* Scan all objects in the grid */
+	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
 	{
-		msg_format("Error: %d transitioning to %d by action %d out of bounds.", feat, newfeat, action);
-		return (feat);
+		object_type *o_ptr;
+
+		/* Get the object */
+		o_ptr = &o_list[this_o_idx];
+
+		/* Get the next object */
+		next_o_idx = o_ptr->next_o_idx;
+
+		/* Check object lite */
+		if (check_object_lite(o_ptr)) return TRUE;
 	}
 
-	/* Change in state */
-	return (newfeat);
-}
+	return FALSE;
+}
+
+bool redraw_halo_loss(int y, int x)
+{
+	return (((play_info[y][x] & (PLAY_VIEW)) && (play_info[y][x] & (PLAY_SEEN))
+	&& !(cave_info[y][x] & (CAVE_LITE)))
+	 || ((view_glowing_lite) && ((cave_info[y][x] & (CAVE_HALO)) == 0)));
+}
+
+bool redraw_halo_gain(int y, int x)
+{
+	return (((play_info[y][x] & (PLAY_VIEW)) && !(play_info[y][x] & (PLAY_SEEN)))
+	 || ((view_glowing_lite) && ((cave_info[y][x] & (CAVE_HALO)) != 0)));
+}
+
+void apply_halo(int y, int x)
+{
+	cave_info[y][x] |= (CAVE_HALO);
+	if ((play_info[y][x] & (PLAY_VIEW)) && !(p_ptr->timed[TMD_BLIND])) play_info[y][x] |= (PLAY_SEEN);
+}
+
+int remove_halo(int y, int x)
+{
+	cave_info[y][x] &= ~(CAVE_HALO);
+	if (!(play_info[y][x] & (PLAY_LITE)) && !(cave_info[y][x] & (CAVE_LITE))) play_info[y][x] &= ~(PLAY_SEEN);	
+	
+	return (0);
+}
+
+void reapply_halo(int y, int x, int r)
+{
+	(void)r;
+	
+	cave_info[y][x] |= (CAVE_HALO);
+	if ((play_info[y][x] & (PLAY_VIEW)) && !(p_ptr->timed[TMD_BLIND])) play_info[y][x] |= (PLAY_SEEN);
+}
+
+
+/*
+ * Daylight functions
+ */
+bool require_daylight(int y, int x)
+{
+	return ((cave_info[y][x] & (CAVE_DLIT)) != 0);
+}
+
+bool has_daylight(int y, int x)
+{
+	bool daytime = is_daytime();
+	bool outside = (level_flag & (LF1_SURFACE))
+		&& (f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE));
+
+	return (daytime && outside);
+}
+
+bool redraw_daylight_loss(int y, int x)
+{
+	return (((play_info[y][x] & (PLAY_VIEW)) && (play_info[y][x] & (PLAY_SEEN))
+	&& !(cave_info[y][x] & (CAVE_LITE)))
+	 || ((view_glowing_lite) && ((cave_info[y][x] & (CAVE_DLIT)) == 0)));
+}
+
+bool redraw_daylight_gain(int y, int x)
+{
+	return (((play_info[y][x] & (PLAY_VIEW)) && !(play_info[y][x] & (PLAY_SEEN)))
+	 || ((view_glowing_lite) && ((cave_info[y][x] & (CAVE_DLIT)) != 0)));
+}
+
+void apply_daylight(int y, int x)
+{
+	cave_info[y][x] |= (CAVE_HALO);
+	if ((play_info[y][x] & (PLAY_VIEW)) && !(p_ptr->timed[TMD_BLIND])) play_info[y][x] |= (PLAY_SEEN);
+}
+
+int remove_daylight(int y, int x)
+{
+	cave_info[y][x] &= ~(CAVE_DLIT);
+	if (!(play_info[y][x] & (PLAY_LITE)) && !(cave_info[y][x] & (CAVE_LITE))) play_info[y][x] &= ~(PLAY_SEEN);
+	
+	return (0);
+}
+
+void reapply_daylight(int y, int x, int r)
+{
+	(void)r;
+	
+	cave_info[y][x] |= (CAVE_DLIT);
+	if ((play_info[y][x] & (PLAY_VIEW)) && !(p_ptr->timed[TMD_BLIND])) play_info[y][x] |= (PLAY_SEEN);
+}
+
+
+/*
+ * Climb-able functions
+ *
+ * Optimisation for placement of monsters which can climb terrain.
+ */
+bool require_climb(int y, int x)
+{
+	return ((cave_info[y][x] & (CAVE_CLIM)) != 0);
+}
+
+bool has_climb(int y, int x)
+{
+	return ((f_info[cave_feat[y][x]].flags2 & (FF2_CAN_CLIMB)) != 0);
+}
+
+bool redraw_climb_loss(int y, int x)
+{
+	(void)y;
+	(void)x;
+	return FALSE;
+}
+
+bool redraw_climb_gain(int y, int x)
+{
+	(void)y;
+	(void)x;
+	return FALSE;
+}
+
+void apply_climb(int y, int x)
+{
+	cave_info[y][x] |= (CAVE_CLIM);
+}
+
+int remove_climb(int y, int x)
+{
+	cave_info[y][x] &= ~(CAVE_CLIM);
+	
+	return (0);
+}
+
+void reapply_climb(int y, int x, int r)
+{
+	(void)r;
+	
+	cave_info[y][x] |= (CAVE_CLIM);
+}
+
+
+/*
+ * Chasm edge -> chasm functions
+ */
+bool require_chasm_edge(int y, int x)
+{
+	return (((f_info[cave_feat[y][x]].flags2 & (FF2_CHASM)) != 0) && (cave_feat[y][x] != FEAT_CHASM));
+}
+
+bool has_chasm_edge(int y, int x)
+{
+	return ((cave_feat[y][x] != FEAT_NONE) &&
+			((f_info[cave_feat[y][x]].flags2 & (FF2_CHASM)) == 0) &&
+			 ((f_info[cave_feat[y][x]].flags2 & (FF2_COVERED)) == 0));
+}
+
+bool redraw_chasm_edge_loss(int y, int x)
+{
+	(void)y;
+	(void)x;
+
+	return (FALSE);
+}
+
+bool redraw_chasm_edge_gain(int y, int x)
+{
+	(void)y;
+	(void)x;
+
+	return (FALSE);
+}
+
+void apply_chasm_edge(int y, int x)
+{
+	if (cave_feat[y][x] == FEAT_CHASM)
+	{
+		cave_set_feat_aux(y, x, FEAT_CHASM_E);
+	}
+}
+
+int remove_chasm_edge(int y, int x)
+{
+	int r = cave_feat[y][x];
+
+	cave_set_feat_aux(y, x, FEAT_CHASM);
+	
+	return (r);
+}
+
+void reapply_chasm_edge(int y, int x, int r)
+{
+	cave_set_feat_aux(y, x, r);
+}
+
+
+/*
+ * Need tree functions
+ */
+bool require_tree(int y, int x)
+{
+	return ((f_info[cave_feat[y][x]].flags3 & (FF3_NEED_TREE)) != 0);
+}
+
+bool has_tree(int y, int x)
+{
+	return (((f_info[cave_feat[y][x]].flags3 & (FF3_TREE)) !=0) && (rand_int(100) < 50));
+}
+
+bool redraw_tree_loss(int y, int x)
+{
+	(void)y;
+	(void)x;
+
+	return (FALSE);
+}
+
+bool redraw_tree_gain(int y, int x)
+{
+	(void)y;
+	(void)x;
+
+	return (FALSE);
+}
+
+int remove_tree(int y, int x)
+{
+	int r = cave_feat[y][x];
+
+	cave_set_feat_aux(y, x, feat_state(r, FS_NEED_TREE));
+	
+	return (r);
+}
+
+void reapply_tree(int y, int x, int r)
+{
+	cave_set_feat_aux(y, x, r);
+}
+
+
+void set_level_flags(int feat)
+{
+	feature_type *f_ptr = &f_info[feat];
+
+	/* Set the level type */
+	if (f_ptr->flags2 & (FF2_WATER)) level_flag |= (LF1_WATER);
+	if (f_ptr->flags2 & (FF2_LAVA)) level_flag |= (LF1_LAVA);
+	if (f_ptr->flags2 & (FF2_ICE)) level_flag |= (LF1_ICE);
+	if (f_ptr->flags2 & (FF2_ACID)) level_flag |= (LF1_ACID);
+	if (f_ptr->flags2 & (FF2_OIL)) level_flag |= (LF1_OIL);
+	if (f_ptr->flags2 & (FF2_CHASM)) level_flag |= (LF1_CHASM);
+	if (f_ptr->flags3 & (FF3_LIVING)) level_flag |= (LF1_LIVING);
+}
+
+
+
+/*
+ * Change the "feat" flag for a grid, and notice/redraw the grid
+ */
+void cave_set_feat(const int y, const int x, int feat)
+{
+	int i;
+
+	int oldfeat = cave_feat[y][x];
+
+	feature_type *f_ptr = &f_info[oldfeat];
+	feature_type *f_ptr2 = &f_info[feat];
+
+	bool surface = (bool)((level_flag & (LF1_SURFACE)));
+	bool daytime = (bool)(level_flag & (LF1_DAYLIGHT));
+
+	bool halo = (f_ptr->flags2 & FF2_GLOW) != 0;
+	bool halo2 = (f_ptr2->flags2 & FF2_GLOW) != 0;
+
+	bool dlit = daytime && surface && (f_ptr->flags3 & (FF3_OUTSIDE));
+	bool dlit2 = daytime && surface && (f_ptr2->flags3 & (FF3_OUTSIDE));
+
+	bool tree = (f_ptr->flags3 & (FF3_TREE)) !=0;
+	bool tree2 = (f_ptr2->flags3 & (FF3_TREE)) != 0;
+
+	bool climb = (f_ptr->flags2 & (FF2_CAN_CLIMB)) !=0;
+	bool climb2 = (f_ptr2->flags2 & (FF2_CAN_CLIMB)) !=0;
+
+	bool los =  (f_ptr->flags1 & (FF1_LOS)) !=0;
+	bool los2 =  (f_ptr2->flags1 & (FF1_LOS)) !=0;
+
+	bool project =  (f_ptr->flags1 & (FF1_PROJECT)) !=0;
+	bool project2 =  (f_ptr2->flags1 & (FF1_PROJECT)) !=0;
+
+	bool trap = (f_ptr->flags1 & (FF1_TRAP)) !=0;
+	bool trap2 = (f_ptr2->flags1 & (FF1_TRAP)) !=0;
+
+	bool chasm_edge = ((f_ptr->flags2 & (FF2_CHASM | FF2_COVERED)) ==0) && (cave_feat[y][x] != FEAT_NONE);
+	bool chasm_edge2 = (f_ptr2->flags2 & (FF2_CHASM | FF2_COVERED)) ==0;
+
+	/* Change the feature */
+	cave_set_feat_aux(y,x,feat);
+
+	/* Handle destroying "glowing" terrain */
+	if (halo && !halo2)
+	{
+		check_attribute_lost(y, x, 2, CAVE_XLOS, require_halo, has_halo, redraw_halo_loss, remove_halo, reapply_halo);
+	}
+
+	/* Handle destroying "outside" terrain */
+	if (dlit && !dlit2)
+	{
+		check_attribute_lost(y, x, 2, CAVE_XLOS, require_daylight, has_daylight, redraw_daylight_loss, remove_daylight, reapply_daylight);
+	}
+
+	/* Handle destroying "climb-able terrain */
+	if (climb && !climb2)
+	{
+		check_attribute_lost(y, x, 1, 0, require_climb, has_climb, redraw_climb_loss, remove_climb, reapply_climb);
+	}
+
+	/* Handle removing chasms */
+	if (chasm_edge && !chasm_edge2)
+	{
+		check_attribute_lost(y, x, 1, 0, require_chasm_edge, has_chasm_edge, redraw_chasm_edge_loss, remove_chasm_edge, reapply_chasm_edge);
+	}
+
+	/* Handle destroying "need_tree" terrain */
+	if (tree && !tree2)
+	{
+		/* For correctness, we need to check if daylight is added to any adjacent location by branches falling */
+		/* Should check more than this if we ever really mess with terrain.txt XXX */
+		byte dlit_adj = 0;
+
+		/* If in daylight on surface */
+		if (daytime && surface) for (i = 0; i < 8; i++)
+		{
+			int yy = y + ddy_ddd[i];
+			int xx = x + ddx_ddd[i];
+
+     		/* Ignore annoying locations */
+			if (!in_bounds_fully(yy, xx)) continue;
+
+			/* Record daylight */
+			if ((f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE)) != 0)
+				dlit_adj |= 1 << i;
+		}
+
+		/* Cause branches to fall */
+		check_attribute_lost(y, x, 1, 0, require_tree, has_tree, redraw_tree_loss, remove_tree, reapply_tree);
+
+		/* Check if daylight added */
+		if (daytime && surface) for (i = 0; i < 8; i++)
+		{
+			int yy = y + ddy_ddd[i];
+			int xx = x + ddx_ddd[i];
+
+     		/* Ignore annoying locations */
+			if (!in_bounds_fully(yy, xx)) continue;
+
+			/* Check if additional daylight */
+			if (((dlit_adj & (1 << i)) != 0) && ((f_info[cave_feat[y][x]].flags3 & (FF3_OUTSIDE)) != 0))
+			{
+				/* Add more light */
+				gain_attribute(yy, xx, 2, CAVE_XLOS, apply_daylight, redraw_daylight_gain);
+			}
+		}
+	}
+
+	/* Handle disarming traps if required */
+	if (trap && !trap2)
+	{
+		for (i = 0; i < region_max; i++)
+		{
+			/* Get the region */
+			region_type *r_ptr = &region_list[i];
+
+			/* Delete traps */
+			if (((r_ptr->flags1 & (RE1_HIT_TRAP)) != 0) && (r_ptr->y0 == y) && (r_ptr->x0 == x))
+			{
+				/* Kill the region */
+				region_terminate(i);
+
+				continue;
+			}
+		}
+	}
+
+	/* Handle updating regions if required */
+	if ((los && !los2) || (!los && los2) || (project && !project2) || (!project && project2))
+	{
+		s16b this_region_piece, next_region_piece = 0;
+
+		for (this_region_piece = cave_region_piece[y][x]; this_region_piece; this_region_piece = next_region_piece)
+		{
+			/* Get the region piece */
+			region_piece_type *rp_ptr = &region_piece_list[this_region_piece];
+
+			/* Get the region */
+			region_type *r_ptr = &region_list[rp_ptr->region];
+
+			/* Get the method */
+			method_type *method_ptr = &method_info[r_ptr->method];
+
+			/* Get the next object */
+			next_region_piece = rp_ptr->next_in_grid;
+
+			/* Skip regions that don't need updating */
+			if (((r_ptr->flags1 & (RE1_PROJECTION)) == 0) || ((r_ptr->flags1 & (RE1_LINGER)) != 0)) continue;
+
+			/* Refresh the region if projection changes */
+			if ((project != project2) && ((method_ptr->flags1 & (PROJECT_LOS | PROJECT_PASS)) == 0))
+			{
+				/* Update the region */
+				region_update(rp_ptr->region);
+			}
+			/* Use line of sight instead */
+			else if ((los != los2) && ((method_ptr->flags1 & (PROJECT_LOS)) != 0))
+			{
+				/* Update the region */
+				region_update(rp_ptr->region);
+			}
+		}
+	}
+
+	/* Set the level flags based on the feature */
+	set_level_flags(feat);
+
+	/* Handle creating "glowing" terrain */
+	if (!halo && halo2)
+	{
+		gain_attribute(y, x, 2, CAVE_XLOS, apply_halo, redraw_halo_gain);
+	}
+
+	/* Handle creating terrain lit by "daylight" */
+	if (!dlit && dlit2)
+	{
+		gain_attribute(y, x, 1, CAVE_XLOS, apply_daylight, redraw_daylight_gain);
+	}
+
+	/* Handle creating "climb-able terrain */
+	if (!climb && climb2)
+	{
+		gain_attribute(y, x, 2, 0, apply_climb, redraw_climb_gain);
+	}
+
+	/* Handle creating chasms */
+	if (!chasm_edge && chasm_edge2)
+	{
+		gain_attribute(y, x, 1, 0, apply_chasm_edge, redraw_chasm_edge_gain);
+	}
+
+	/* Handle gold/items */
+	if (((f_ptr->flags1 & FF1_HAS_ITEM) && !(f_ptr2->flags1 & (FF1_HAS_ITEM)))
+		|| ((f_ptr->flags1 & FF1_HAS_GOLD) && !(f_ptr2->flags1 & (FF1_HAS_GOLD))))
+	{
+		int number = 0;
+		int j;
+
+		bool good = (f_ptr->flags3 & (FF3_DROP_GOOD)) ? TRUE : FALSE;
+		bool great = (f_ptr->flags3 & (FF3_DROP_GREAT)) ? TRUE : FALSE;
+
+		bool do_item = ((f_ptr->flags1 & FF1_HAS_ITEM) && !(f_ptr->flags2 & (FF1_HAS_ITEM)));
+		bool do_gold = ((f_ptr->flags1 & FF1_HAS_GOLD) && !(f_ptr->flags2 & (FF1_HAS_GOLD)));
+
+		object_type *i_ptr;
+		object_type object_type_body;
+
+		if (f_ptr->flags3 & (FF3_DROP_1D2)) number += damroll(1, 2);
+		if (f_ptr->flags3 & (FF3_DROP_1D3)) number += damroll(1, 3);
+
+		/* Always drop something */
+		if (!number) number = 1;
+
+		/* Opening a chest -- this forces tval_drop_idx to be set after first item selected */
+		opening_chest = TRUE;
+
+		/* Drop some objects */
+		for (j = 0; j < number; j++)
+		{
+			/* Get local object */
+			i_ptr = &object_type_body;
+
+			/* Wipe the object */
+			object_wipe(i_ptr);
+
+			/* Make Gold */
+			if (do_gold && (!do_item || (rand_int(100) < 50)))
+			{
+				/* Make some gold */
+				if (!make_gold(i_ptr, good, great)) continue;
+			}
+
+			/* Make Object */
+			else
+			{
+				/* Make an object */
+				if (!make_object(i_ptr, good, great)) continue;
+			}
+
+			/* No longer opening a chest */
+			opening_chest = FALSE;
+
+			/* Mark the origin */
+			i_ptr->origin = ORIGIN_FEAT;
+			i_ptr->origin_depth = p_ptr->depth;
+
+			/* Drop it in the dungeon */
+			drop_near(i_ptr, -1, y, x, TRUE);
+		}
+
+		/* Clear drop restriction */
+		tval_drop_idx = 0;
+	}
+}
+
+
+/*
+ * Take a feature, determine what that feature becomes
+ * through applying the given action.
+ */
+int feat_state(int feat, int action)
+{
+	int newfeat=feat;
+	int i;
+
+	/* Permanent stuff never gets changed */
+	/* Hack -- ignore for less and more. This is required to reverse stair directions. */
+	if ((f_info[feat].flags1 & FF1_PERMANENT) && (action != FS_LESS) && (action != FS_MORE)) return (feat);
+
+	/* Set default feat */
+	newfeat = f_info[feat].defaults;
+
+	/* Get the new feature */
+	for (i=0;i<MAX_FEAT_STATES;i++)
+	{
+		if (f_info[feat].state[i].action == action)
+		{
+			newfeat = f_info[feat].state[i].result;
+			break;
+		}
+	}
+
+	/* Paranoia */
+	if (newfeat > z_info->f_max)
+	{
+		msg_format("Error: %d transitioning to %d by action %d out of bounds.", feat, newfeat, action);
+		return (feat);
+	}
+
+	/* Change in state */
+	return (newfeat);
+}
+
+/*
+ * Takes a location and action and changes the feature at that
+ * location through applying the given action.
+ */
+void cave_alter_feat(const int y, const int x, int action)
+{
+	int newfeat;
+
+	/* Set old feature */
+	int oldfeat = cave_feat[y][x];
+
+	/* Get the new feat */
+	newfeat = feat_state(cave_feat[y][x],action);
+
+	/* Invisible trap */
+	if (newfeat == oldfeat)
+	{
+		if (f_info[oldfeat].flags3 & (FF3_PICK_TRAP))
+		{
+			/* Pick a trap */
+			pick_trap(y, x, FALSE);
+
+			/* Update new feature */
+			newfeat = cave_feat[y][x];
+
+			/* Disturb */
+			disturb(0, 0);
+		}
+		else if (f_info[oldfeat].flags3 & (FF3_PICK_DOOR))
+		{
+			/* Pick a trap */
+			pick_door(y, x);
+
+			/* Update new feature */
+			newfeat = cave_feat[y][x];
+
+			/* Disturb */
+			disturb(0, 0);
+		}
+		else
+		{
+			return;
+		}
+	}
+
+	/* Other stuff */
+	else
+	{
+		/* Set the new feature */
+		cave_set_feat(y,x,newfeat);
+	}
+
+	/* Notice */
+	note_spot(y, x);
+
+	/* Redraw */
+	lite_spot(y, x);
+
+}
+
+/* Check to see whether a monster or player blocks a path */
+/* Player always blocks, monster blocks if not hidden */
+#define monster_block(Y, X) \
+	((cave_m_idx[(Y)][(X)] < 0) || \
+	((cave_m_idx[(Y)][(X)] > 0) && \
+	 ((m_list[cave_m_idx[(Y)][(X)]].mflag & (MFLAG_HIDE)) == 0)))
+
+
+/*
+ * Collect the grids containing the line(s) of fire from (y1,x1) to (y2,x2)
+ * into "tmp_grids", in order of distance from the start.  See
+ * project_path_aux() for the meaning of "require_strict_lof".
+ *
+ * This depends only on the terrain and (for strict paths) on the field of
+ * view, never on monsters or the range of the projection.
+ *
+ * Returns the number of grids, or -1 if the end point cannot be found.
+ */
+static int project_path_lof_aux(u16b *tmp_grids, int octant, int y1, int x1, int y2, int x2,
+	u32b flg, bool require_strict_lof)
+{
+	int i, j;
+	int grids = 0;
+	bool line_fire;
+
+	int y = 0, old_y = 0;
+	int x = 0, old_x = 0;
+
+	/* Start with all lines of sight unobstructed */
+	u32b bits0 = VINFO_BITS_0;
+	u32b bits1 = VINFO_BITS_1;
+	u32b bits2 = VINFO_BITS_2;
+	u32b bits3 = VINFO_BITS_3;
+
+	int slope_fire1 = -1, slope_fire2 = 0;
+
+	bool really_require_strict_lof = FALSE;
+	bool allow_los = (flg & (PROJECT_LOS)) != 0;
+
+	/* Initial grid */
+	s16b g0 = GRID(y1, x1);
+
+	s16b g;
+
+	/* Pointer to vinfo data */
+	vinfo_type *p;
+
+	/* Scan the octant, find the grid corresponding to the end point */
+	for (j = 1; j < VINFO_MAX_GRIDS; j++)
+	{
+		s16b vy, vx;
+
+		/* Point to this vinfo record */
+		p = &vinfo[j];
+
+		/* Extract grid value */
+		g = g0 + p->grid[octant];
+
+		/* Get axis coordinates */
+		vy = GRID_Y(g);
+		vx = GRID_X(g);
+
+		/* Allow for negative values XXX XXX XXX */
+		if (vy > 256 * 127) vy = vy - (256 * 256);
+		if (vx > x1 + 127)
+		{
+			vy++;
+			vx = vx - 256;
+		}
+
+		/* Require that grid be correct */
+		if ((vy != y2) || (vx != x2)) continue;
+
+		/* Store lines of fire */
+		slope_fire1 = p->slope_fire_index1;
+		slope_fire2 = p->slope_fire_index2;
+
+		break;
+	}
+
+	/* Note failure XXX XXX */
+	if (slope_fire1 == -1) return (-1);
+
+	/* Scan the octant, collect all grids having the correct line of fire */
+	for (j = 1; j < VINFO_MAX_GRIDS; j++)
+	{
+		line_fire = FALSE;
+
+		/* Point to this vinfo record */
+		p = &vinfo[j];
+
+		/* See if any lines of sight pass through this grid */
+		if (!((bits0 & (p->bits_0)) ||
+			   (bits1 & (p->bits_1)) ||
+			   (bits2 & (p->bits_2)) ||
+			   (bits3 & (p->bits_3))))
+		{
+			continue;
+		}
+
+		/*
+		 * Extract grid value.  Use pointer shifting to get the
+		 * correct grid offset for this octant.
+		 */
+		g = g0 + *((s16b*)(((byte*)(p)) + (octant * 2)));
+
+		y = GRID_Y(g);
+		x = GRID_X(g);
+
+		/* Must be legal (this is important) */
+		if (!in_bounds_fully(y, x)) continue;
+
+		/* Check for first possible line of fire */
+		i = slope_fire1;
+
+		/* Check line(s) of fire */
+		while (TRUE)
+		{
+			switch (i / 32)
+			{
+				case 3:
+				{
+					if (bits3 & (1L << (i % 32)))
+					{
+						if (p->bits_3 & (1L << (i % 32))) line_fire = TRUE;
+					}
+					break;
+				}
+				case 2:
+				{
+					if (bits2 & (1L << (i % 32)))
+					{
+						if (p->bits_2 & (1L << (i % 32))) line_fire = TRUE;
+					}
+					break;
+				}
+				case 1:
+				{
+					if (bits1 & (1L << (i % 32)))
+					{
+						if (p->bits_1 & (1L << (i % 32))) line_fire = TRUE;
+					}
+					break;
+				}
+				case 0:
+				{
+					if (bits0 & (1L << (i % 32)))
+					{
+						if (p->bits_0 & (1L << (i % 32))) line_fire = TRUE;
+					}
+					break;
+				}
+			}
+
+			/* We're done if no second LOF exists, or when we've checked it */
+			if ((!slope_fire2) || (i == slope_fire2)) break;
+
+			/* Check second possible line of fire */
+			i = slope_fire2;
+		}
+
+		/* This grid contains at least one of the lines of fire */
+		if (line_fire)
+		{
+			/* Do not accept breaks in the series of grids  XXX XXX */
+			if ((grids) && ((ABS(y - old_y) > 1) || (ABS(x - old_x) > 1)))
+			{
+				break;
+			}
+
+			/* Optionally, require strict line of fire */
+			if ((!require_strict_lof) || (play_info[y][x] & (PLAY_FIRE))
+				|| ((allow_los) && (play_info[y][x] & (PLAY_VIEW))))
+			{
+				/* Hack - only end on a LOF exception */
+				if (really_require_strict_lof)
+				{
+					grids--;
+					really_require_strict_lof = FALSE;
+				}
+				
+				/* Store grid value */
+				tmp_grids[grids++] = g;
+			}
+			/* Really require strict lof. We allow exceptions for a final
+			 * grid which blocks line of fire. */
+			else if ((require_strict_lof) && !(really_require_strict_lof)
+					&& !(cave_project_bold(y, x))
+							&& (!(allow_los) || !(cave_los_bold(y, x))))
+			{
+				/* Store grid value */
+				tmp_grids[grids++] = g;
+				
+				/* Great variable name */
+				really_require_strict_lof = TRUE;
+			}
+
+			/* Remember previous coordinates */
+			old_y = y;
+			old_x = x;
+		}
+
+		/*
+		 * Handle wall (unless ignored).  Walls can be in a projection path,
+		 * but the path cannot pass through them.
+		 */
+		if (!(flg & (PROJECT_PASS)) && !cave_project_bold(y, x)
+				&& ((!allow_los) || !(cave_los_bold(y, x))))
+		{
+			/* Clear any lines of sight passing through this grid */
+			bits0 &= ~(p->bits_0);
+			bits1 &= ~(p->bits_1);
+			bits2 &= ~(p->bits_2);
+			bits3 &= ~(p->bits_3);
+		}
+	}
+
+	return (grids);
+}
+
+
+#ifdef PATH_CACHE
+
+/*
+ * Remembered lines of fire, one per hash bucket.
+ *
+ * An entry is good only while "feat_epoch" matches cave_feat_epoch and,
+ * for paths to or from the character, while "view_epoch" matches
+ * play_view_epoch.  An unused entry has no "grids", which no call can
+ * ever ask for, as projections of zero length are never looked up.
+ */
+typedef struct path_cache_type path_cache_type;
+
+struct path_cache_type
+{
+	u32b feat_epoch;	/* Terrain epoch when worked out */
+	u32b view_epoch;	/* View epoch when worked out */
+	u32b grids;		/* Source and target grids */
+	u32b flg;		/* PROJECT_PASS / PROJECT_LOS */
+	bool strict;		/* Strict line of fire */
+	s16b num;		/* Number of grids, or -1 */
+	u16b path[80];		/* Grids in the line(s) of fire */
+};
+
+static path_cache_type path_cache[PATH_CACHE_SIZE];
+
+#endif /* PATH_CACHE */
+
 
 /*
- * Takes a location and action and changes the feature at that
- * location through applying the given action.
+ * Collect the grids containing the line(s) of fire, as above.
+ *
+ * Monsters casting spells and choosing targets, and the character firing
+ * missiles, ask for the same lines of fire over and over again, so we
+ * remember recent ones until the terrain or the view next changes.
  */
-void cave_alter_feat(const int y, const int x, int action)
+static int project_path_lof(u16b *tmp_grids, int octant, int y1, int x1, int y2, int x2,
+	u32b flg, bool require_strict_lof)
 {
-	int newfeat;
+#ifdef PATH_CACHE
+	path_cache_type *c_ptr;
+	u32b grids;
 
-	/* Set old feature */
-	int oldfeat = cave_feat[y][x];
+	/* Only these flags change the line of fire */
+	flg &= (PROJECT_PASS | PROJECT_LOS);
 
-	/* Get the new feat */
-	newfeat = feat_state(cave_feat[y][x],action);
+	/* Paranoia -- keys only hold legal grids */
+	if (!in_bounds(y2, x2))
+		return (project_path_lof_aux(tmp_grids, octant, y1, x1, y2, x2, flg, require_strict_lof));
 
-	/* Invisible trap */
-	if (newfeat == oldfeat)
-	{
-		if (f_info[oldfeat].flags3 & (FF3_PICK_TRAP))
-		{
-			/* Pick a trap */
-			pick_trap(y, x, FALSE);
+	/* Pack the grids into a key */
+	grids = ((u32b)((y1 << 8) | x1) << 16) | (u32b)((y2 << 8) | x2);
 
-			/* Update new feature */
-			newfeat = cave_feat[y][x];
+	/* Find the bucket */
+	c_ptr = &path_cache[((grids * 2654435761UL + flg + require_strict_lof) & 0xFFFFFFFFUL) >> (32 - PATH_CACHE_BITS)];
 
-			/* Disturb */
-			disturb(0, 0);
-		}
-		else if (f_info[oldfeat].flags3 & (FF3_PICK_DOOR))
-		{
-			/* Pick a trap */
-			pick_door(y, x);
+	/* Remembered */
+	if ((c_ptr->feat_epoch == cave_feat_epoch) && (c_ptr->grids == grids) &&
+	    (c_ptr->flg == flg) && (c_ptr->strict == require_strict_lof) &&
+	    ((!require_strict_lof) || (c_ptr->view_epoch == play_view_epoch)))
+	{
+		path_cache_hit++;
 
-			/* Update new feature */
-			newfeat = cave_feat[y][x];
+		if (c_ptr->num > 0) C_COPY(tmp_grids, c_ptr->path, c_ptr->num, u16b);
 
-			/* Disturb */
-			disturb(0, 0);
-		}
-		else
-		{
-			return;
-		}
+		return (c_ptr->num);
 	}
 
-	/* Other stuff */
-	else
-	{
-		/* Set the new feature */
-		cave_set_feat(y,x,newfeat);
-	}
+	path_cache_miss++;
 
-	/* Notice */
-	note_spot(y, x);
+	/* Work it out, and remember it */
+	c_ptr->feat_epoch = cave_feat_epoch;
+	c_ptr->view_epoch = play_view_epoch;
+	c_ptr->grids = grids;
+	c_ptr->flg = flg;
+	c_ptr->strict = require_strict_lof;
+	c_ptr->num = project_path_lof_aux(tmp_grids, octant, y1, x1, y2, x2, flg, require_strict_lof);
 
-	/* Redraw */
-	lite_spot(y, x);
+	if (c_ptr->num > 0) C_COPY(c_ptr->path, tmp_grids, c_ptr->num, u16b);
+
+	return (c_ptr->num);
 
+#else /* PATH_CACHE */
+
+	return (project_path_lof_aux(tmp_grids, octant, y1, x1, y2, x2, flg, require_strict_lof));
+
+#endif /* PATH_CACHE */
 }
 
-/* Check to see whether a monster or player blocks a path */
-/* Player always blocks, monster blocks if not hidden */
-#define monster_block(Y, X) \
-	((cave_m_idx[(Y)][(X)] < 0) || \
-	((cave_m_idx[(Y)][(X)] > 0) && \
-	 ((m_list[cave_m_idx[(Y)][(X)]].mflag & (MFLAG_HIDE)) == 0)))
+
+/*
+ * Forget everything worked out from the terrain, the view and the
+ * scent clock, as at the start of a new game.
+ *
+ * The epochs go back to zero, so the caches keyed on them must be
+ * emptied as well.
+ */
+void wipe_cave_caches(void)
+{
+	/* Restart the clocks */
+	cave_feat_epoch = 0;
+	play_view_epoch = 0;
+
+#ifdef LOS_CACHE
+	/* Forget the lines of sight */
+	C_WIPE(los_cache, LOS_CACHE_SIZE, los_cache_type);
+#endif /* LOS_CACHE */
+
+#ifdef PATH_CACHE
+	/* Forget the lines of fire */
+	C_WIPE(path_cache, PATH_CACHE_SIZE, path_cache_type);
+#endif /* PATH_CACHE */
+
+#ifdef MONSTER_FLOW
+	/* No noise yet */
+	flow_dirty = FALSE;
+	cost_at_center = 0;
+	flow_center_y = flow_center_x = 0;
+	update_center_y = update_center_x = 0;
+
+	/* No scent yet */
+	scent_when = SMELL_FADE;
+	scent_mask_y = scent_mask_x = -1;
+	scent_mask_epoch = 0;
+#endif /* MONSTER_FLOW */
+}
 
 
 /*
@@ -6196,28 +7389,18 @@ int project_path_aux(u16b *gp, int range, int y1, int x1, int *y2, int *x2, u32b
 	int i, j, k;
 	int dy, dx;
 	int num, dist, octant;
-	int grids = 0;
-	bool line_fire;
+	int grids;
 	bool full_stop = FALSE;
 
 	int y_a, x_a, y_b, x_b;
-	int y = 0, old_y = 0;
-	int x = 0, old_x = 0;
-
-	/* Start with all lines of sight unobstructed */
-	u32b bits0 = VINFO_BITS_0;
-	u32b bits1 = VINFO_BITS_1;
-	u32b bits2 = VINFO_BITS_2;
-	u32b bits3 = VINFO_BITS_3;
-
-	int slope_fire1 = -1, slope_fire2 = 0;
+	int y = 0;
+	int x = 0;
 
 	/* Projections are either vertical or horizontal */
 	bool vertical;
 
 	/* Require projections to be strictly LOF when possible  XXX XXX */
 	bool require_strict_lof = FALSE;
-	bool really_require_strict_lof = FALSE;
 	bool allow_los = (flg & (PROJECT_LOS)) != 0;
 
 	/* Count of grids in LOF, storage of LOF grids */
@@ -6232,14 +7415,6 @@ int project_path_aux(u16b *gp, int range, int y1, int x1, int *y2, int *x2, u32b
 	/* Assume no monsters in way */
 	bool monster_in_way = FALSE;
 
-	/* Initial grid */
-	s16b g0 = GRID(y1, x1);
-
-	s16b g;
-
-	/* Pointer to vinfo data */
-	vinfo_type *p;
-
 	/* Handle projections of zero length */
 	if ((range <= 0) || ((*y2 == y1) && (*x2 == x1))) return (0);
 
@@ -6319,175 +7494,11 @@ int project_path_aux(u16b *gp, int range, int y1, int x1, int *y2, int *x2, u32b
 	}
 
 
-	/* Scan the octant, find the grid corresponding to the end point */
-	for (j = 1; j < VINFO_MAX_GRIDS; j++)
-	{
-		s16b vy, vx;
-
-		/* Point to this vinfo record */
-		p = &vinfo[j];
-
-		/* Extract grid value */
-		g = g0 + p->grid[octant];
-
-		/* Get axis coordinates */
-		vy = GRID_Y(g);
-		vx = GRID_X(g);
-
-		/* Allow for negative values XXX XXX XXX */
-		if (vy > 256 * 127) vy = vy - (256 * 256);
-		if (vx > x1 + 127)
-		{
-			vy++;
-			vx = vx - 256;
-		}
-
-		/* Require that grid be correct */
-		if ((vy != *y2) || (vx != *x2)) continue;
-
-		/* Store lines of fire */
-		slope_fire1 = p->slope_fire_index1;
-		slope_fire2 = p->slope_fire_index2;
-
-		break;
-	}
+	/* Collect the grids in the line(s) of fire */
+	grids = project_path_lof(tmp_grids, octant, y1, x1, *y2, *x2, flg, require_strict_lof);
 
 	/* Note failure XXX XXX */
-	if (slope_fire1 == -1) return (0);
-
-	/* Scan the octant, collect all grids having the correct line of fire */
-	for (j = 1; j < VINFO_MAX_GRIDS; j++)
-	{
-		line_fire = FALSE;
-
-		/* Point to this vinfo record */
-		p = &vinfo[j];
-
-		/* See if any lines of sight pass through this grid */
-		if (!((bits0 & (p->bits_0)) ||
-			   (bits1 & (p->bits_1)) ||
-			   (bits2 & (p->bits_2)) ||
-			   (bits3 & (p->bits_3))))
-		{
-			continue;
-		}
-
-		/*
-		 * Extract grid value.  Use pointer shifting to get the
-		 * correct grid offset for this octant.
-		 */
-		g = g0 + *((s16b*)(((byte*)(p)) + (octant * 2)));
-
-		y = GRID_Y(g);
-		x = GRID_X(g);
-
-		/* Must be legal (this is important) */
-		if (!in_bounds_fully(y, x)) continue;
-
-		/* Check for first possible line of fire */
-		i = slope_fire1;
-
-		/* Check line(s) of fire */
-		while (TRUE)
-		{
-			switch (i / 32)
-			{
-				case 3:
-				{
-					if (bits3 & (1L << (i % 32)))
-					{
-						if (p->bits_3 & (1L << (i % 32))) line_fire = TRUE;
-					}
-					break;
-				}
-				case 2:
-				{
-					if (bits2 & (1L << (i % 32)))
-					{
-						if (p->bits_2 & (1L << (i % 32))) line_fire = TRUE;
-					}
-					break;
-				}
-				case 1:
-				{
-					if (bits1 & (1L << (i % 32)))
-					{
-						if (p->bits_1 & (1L << (i % 32))) line_fire = TRUE;
-					}
-					break;
-				}
-				case 0:
-				{
-					if (bits0 & (1L << (i % 32)))
-					{
-						if (p->bits_0 & (1L << (i % 32))) line_fire = TRUE;
-					}
-					break;
-				}
-			}
-
-			/* We're done if no second LOF exists, or when we've checked it */
-			if ((!slope_fire2) || (i == slope_fire2)) break;
-
-			/* Check second possible line of fire */
-			i = slope_fire2;
-		}
-
-		/* This grid contains at least one of the lines of fire */
-		if (line_fire)
-		{
-			/* Do not accept breaks in the series of grids  XXX XXX */
-			if ((grids) && ((ABS(y - old_y) > 1) || (ABS(x - old_x) > 1)))
-			{
-				break;
-			}
-
-			/* Optionally, require strict line of fire */
-			if ((!require_strict_lof) || (play_info[y][x] & (PLAY_FIRE))
-				|| ((allow_los) && (play_info[y][x] & (PLAY_VIEW))))
-			{
-				/* Hack - only end on a LOF exception */
-				if (really_require_strict_lof)
-				{
-					grids--;
-					really_require_strict_lof = FALSE;
-				}
-				
-				/* Store grid value */
-				tmp_grids[grids++] = g;
-			}
-			/* Really require strict lof. We allow exceptions for a final
-			 * grid which blocks line of fire. */
-			else if ((require_strict_lof) && !(really_require_strict_lof)
-					&& !(cave_project_bold(y, x))
-							&& (!(allow_los) || !(cave_los_bold(y, x))))
-			{
-				/* Store grid value */
-				tmp_grids[grids++] = g;
-				
-				/* Great variable name */
-				really_require_strict_lof = TRUE;
-			}
-
-			/* Remember previous coordinates */
-			old_y = y;
-			old_x = x;
-		}
-
-		/*
-		 * Handle wall (unless ignored).  Walls can be in a projection path,
-		 * but the path cannot pass through them.
-		 */
-		if (!(flg & (PROJECT_PASS)) && !cave_project_bold(y, x)
-				&& ((!allow_los) || !(cave_los_bold(y, x))))
-		{
-			/* Clear any lines of sight passing through this grid */
-			bits0 &= ~(p->bits_0);
-			bits1 &= ~(p->bits_1);
-			bits2 &= ~(p->bits_2);
-			bits3 &= ~(p->bits_3);
-		}
-	}
+	if (grids < 0) return (0);
 
 	/* Scan the grids along the line(s) of fire */
 	for (step = 0, j = 0; j < grids;)
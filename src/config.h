@@ -334,6 +334,45 @@
  */
 #define MONSTER_AI
 
+/*
+ * OPTION: Keep the most recently visited levels in memory, so that
+ * going back up or down a connected staircase returns to the level
+ * the character just left instead of generating a new one.
+ *
+ * LEVEL_CACHE_MAX is the number of levels kept, and LEVEL_CACHE_MEMORY
+ * the most memory (in bytes) they may use between them.  The least
+ * recently visited level is thrown away first.
+ *
+ * This changes the game: by default every staircase leads to a newly
+ * generated level, as it always has.
+ */
+/* #define LEVEL_CACHE */
+#define LEVEL_CACHE_MAX		4
+#define LEVEL_CACHE_MEMORY	(2048L * 1024L)
+
+/*
+ * OPTION: Remember the results of generic_los() until the terrain next
+ * changes.  LOS_CACHE_BITS sets the number of entries (as a power of two).
+ */
+#define LOS_CACHE
+#define LOS_CACHE_BITS		12
+#define LOS_CACHE_SIZE		(1L << LOS_CACHE_BITS)
+
+/*
+ * OPTION: Remember the lines of fire worked out by project_path() until
+ * the terrain or the view next changes.  PATH_CACHE_BITS sets the number
+ * of entries (as a power of two).
+ */
+#define PATH_CACHE
+#define PATH_CACHE_BITS		9
+#define PATH_CACHE_SIZE		(1L << PATH_CACHE_BITS)
+
+/*
+ * OPTION: Let project() hold back the map redraws caused by its effects,
+ * and redraw each changed grid once when it is done.
+ */
+#define LITE_SPOT_BATCH
+
 
 /*
  * OPTION: Support multiple "player" grids in "map_info()"
@@ -347,6 +386,14 @@
 /* #define UPDATE_VIEW_COMPLEX_WALL_ILLUMINATION */
 
 
+/*
+ * OPTION: Include the symmetric shadowcasting field of view, which is
+ * used instead of the "vinfo" table when "view_shadowcast" is set (with
+ * the "-c" command line option).
+ */
+#define VIEW_SHADOWCAST
+
+
 /*
  * OPTION: Gamma correct colours (with X11)
  */
@@ -359,6 +406,30 @@
 #define CHECK_MODIFICATION_TIME
 
 
+/*
+ * OPTION: Keep all of the *_info arrays in a single binary image,
+ * "info.raw", and map it into memory at startup instead of reading and
+ * copying each *_info.raw file.
+ */
+#define INFO_IMAGE
+
+
+/*
+ * OPTION: When some *_info.raw files are out of date, parse the *.txt
+ * files which need no other arrays on threads of their own, while the
+ * rest are loaded.  This needs POSIX threads ("HAVE_PTHREAD").
+ */
+#define PARSE_THREADS
+
+
+/*
+ * OPTION: Write autosaves ("autosave_backup") on a thread of their own,
+ * so the game does not stop while the savefile goes to disk.  This
+ * needs POSIX threads ("HAVE_PTHREAD").
+ */
+#define ASYNC_AUTOSAVE
+
+
 /*
  * OPTION: Enable the "smart_learn" and "smart_cheat" options.
  * They let monsters make more "intelligent" choices about attacks
@@ -563,12 +634,28 @@
 # undef ALLOW_SPOILERS
 # undef ALLOW_TEMPLATES
 # undef MONSTER_AI
+# undef LEVEL_CACHE
 # undef DELAY_LOAD_R_TEXT
 # undef ALLOW_OBJECT_INFO_MORE
 # undef USE_CLASS_PRETTY_NAMES
 # define DELAY_LOAD_R_TEXT
 #endif
 
+/*
+ * Hack -- Files can only be parsed on other threads if there are threads,
+ * and if there are files to parse
+ */
+#if !defined(HAVE_PTHREAD) || !defined(ALLOW_TEMPLATES)
+# undef PARSE_THREADS
+#endif
+
+/*
+ * Hack -- Background autosaves need threads
+ */
+#ifndef HAVE_PTHREAD
+# undef ASYNC_AUTOSAVE
+#endif
+
 
 
 /*
@@ -67,7 +67,7 @@
 #define VERSION_MAJOR	0
 #define VERSION_MINOR	7
 #define VERSION_PATCH	0
-#define VERSION_EXTRA	0
+#define VERSION_EXTRA	2
 
 /*
  * Oldest version number that can still be imported
@@ -78,6 +78,19 @@
 #define OLD_VERSION_EXTRA	20
 
 
+/*
+ * Sections of a savefile (0.7.0.1 and up)
+ */
+#define SF_HEADER	0
+#define SF_PLAYER	1
+#define SF_DUNGEON	2
+#define SF_LORE		3
+#define SF_STORES	4
+#define SF_RANDARTS	5
+#define SF_MESSAGES	6
+#define SF_MAX		7
+
+
 /*
  * Number of grids in each block (vertically)
  * Probably hard-coded to 11, see "generate.c"
@@ -154,9 +167,39 @@
  */
 #define DUNGEON_WID		198
 
+/*
+ * Row stride of the grid arrays of a level (see "level_type")
+ * Must be at least DUNGEON_WID, and 256 for the GRID() macros
+ */
+#define LEVEL_STRIDE	256
+
+/*
+ * Alignment of the grid arrays of a level (one cache line)
+ */
+#define LEVEL_ALIGN		64
+
 #define TOWN_WID 66
 #define TOWN_HGT 21
 
+/*
+ * Monsters are bucketed into blocks of (1 << MON_BLOCK_SHIFT) grids on
+ * a side, so that monsters near a grid can be found quickly
+ */
+#define MON_BLOCK_SHIFT	3
+#define MON_BLOCK_HGT	((DUNGEON_HGT >> MON_BLOCK_SHIFT) + 1)
+#define MON_BLOCK_WID	((DUNGEON_WID >> MON_BLOCK_SHIFT) + 1)
+
+/*
+ * Index of the monster block containing a grid
+ */
+#define MON_BLOCK(Y,X) \
+	((((Y) >> MON_BLOCK_SHIFT) * MON_BLOCK_WID) + ((X) >> MON_BLOCK_SHIFT))
+
+/*
+ * Number of words of "mon_wait" flags, one bit for each monster
+ */
+#define MON_WAIT_WORDS	((z_info->m_max + 31) / 32)
+
 /*
  * Maximum numbers of rooms along each axis (currently 6x18)
  * Now defined in defines.h
@@ -236,8 +279,13 @@
  * Maximum size of the "view" array (see "cave.c")
  * Note that the "view radius" will NEVER exceed 20, and even if the "view"
  * was octagonal, we would never require more than 1520 entries in the array.
+ * Shadowcasting has no such limit, so allow for the whole level.
  */
+#ifdef VIEW_SHADOWCAST
+#define VIEW_MAX (DUNGEON_HGT * DUNGEON_WID)
+#else /* VIEW_SHADOWCAST */
 #define VIEW_MAX 1536
+#endif /* VIEW_SHADOWCAST */
 
 /*
  * Maximum size of the "temp" array (see "cave.c")
@@ -455,6 +503,21 @@ enum
  */
 #define SMELL_STRENGTH 60
 
+/*
+ * Scent older than this has faded away completely.
+ *
+ * Scent used to be wiped every (250 - SMELL_STRENGTH) character turns,
+ * except for scent no older than SMELL_STRENGTH, which lasted until the
+ * next wipe.  Scent laid down at a random time thus lasted for
+ * (250 + SMELL_STRENGTH) / 2 turns on average, which is kept here.
+ */
+#define SMELL_FADE ((250 + SMELL_STRENGTH) / 2)
+
+/*
+ * The scent clock is started again before it passes this
+ */
+#define SMELL_CLOCK_MAX 65535
+
 /*
  * Player constants
  */
@@ -2690,6 +2753,26 @@ enum
 /* Cave lit by any form of light - except player torch */
 #define CAVE_LITE		(CAVE_GLOW | CAVE_DLIT | CAVE_TLIT | CAVE_HALO)
 
+/*
+ * Passability bitmaps, worked out from the terrain (see "cave_pass")
+ */
+#define PASS_WALK		0	/* feature has FF1_MOVE */
+#define PASS_SWIM		1	/* feature has FF2_CAN_SWIM */
+#define PASS_FLY		2	/* feature has FF2_CAN_FLY */
+#define PASS_CLIMB		3	/* feature has FF3_EASY_CLIMB */
+#define PASS_WALL		4	/* feature has FF2_CAN_PASS */
+#define PASS_DIG		5	/* feature has FF2_CAN_DIG */
+#define PASS_OOZE		6	/* feature has FF2_CAN_OOZE */
+#define PASS_MOVE		7	/* some monster may move here without passing walls */
+#define PASS_SAFE		8	/* known feature is safe for the player to walk on */
+#define PASS_ALTER		9	/* known feature can be easily altered by the player */
+#define PASS_MAX		10
+
+/*
+ * Number of words in each row of a passability bitmap
+ */
+#define PASS_WORDS		((DUNGEON_WID + 31) / 32)
+
 /*
  * Special player grid flags
  */
@@ -4624,6 +4707,15 @@ enum
 	 (!(cave_info[(Y)][(X)] & (((R) & (PROJECT_LOS)) != 0 ? CAVE_XLOS : CAVE_XLOF))))
 
 
+/*
+ * Determine if a "legal" grid is in a passability bitmap
+ *
+ * Note the use of the "cave_pass" bitmaps, one of "PASS_*".
+ */
+#define cave_pass_bold(P,Y,X) \
+	((cave_pass[P][Y][(X) >> 5] & (1L << ((X) & 31))) != 0)
+
+
 
 /*
  * Determine if a "legal" grid is a "clean" floor grid
@@ -5124,15 +5216,10 @@ enum
 /* Returns TRUE if the given queue is full */
 #define GRID_QUEUE_FULL(Q) ((((Q)->tail + 1) % (Q)->max_size) == (Q)->head)
 
-/*
- * Maximum size around the player to consider in the pathfinder
- */
-#define MAX_PF_RADIUS 50
-
 /*
  * Maximum distance to consider in the pathfinder
  */
-#define MAX_PF_LENGTH 250
+#define MAX_PF_LENGTH 1000
 
 
 /*
@@ -3646,6 +3646,10 @@ static void dungeon(void)
 		{
 
 			/* process monster with even more energy first */
+#ifdef ALLOW_BORG
+			if (borg_headless) borg_process_monsters((byte)(p_ptr->energy + 1));
+			else
+#endif
 			process_monsters((byte)(p_ptr->energy + 1));
 
 			/* if still alive */
@@ -3678,6 +3682,10 @@ static void dungeon(void)
 		if (p_ptr->leaving) break;
 
 		/* Process monsters */
+#ifdef ALLOW_BORG
+		if (borg_headless) borg_process_monsters(0);
+		else
+#endif
 		process_monsters(0);
 
 		/* Reset Monsters */
@@ -3828,7 +3836,13 @@ void play_game(bool new_game)
 	/* Hack -- Turn off the cursor */
 	(void)Term_set_cursor(0);
 
+#ifdef ALLOW_BORG
+	/* The headless borg never touches the savefile */
+	if (borg_headless) character_loaded = FALSE;
+
 	/* Attempt to load */
+	else
+#endif
 	if (!load_player())
 	{
 		/* Oops */
@@ -4061,7 +4075,16 @@ void play_game(bool new_game)
 	/* Generate familiar attributes */
 	generate_familiar();
 
+#ifdef LEVEL_CACHE
+	/* Forget the levels of any earlier character */
+	level_cache_wipe();
+#endif /* LEVEL_CACHE */
+
 	/* Generate a dungeon level if needed */
+#ifdef ALLOW_BORG
+	if (borg_headless && !character_dungeon) borg_generate_cave();
+	else
+#endif
 	if (!character_dungeon) generate_cave();
 
 	/* Character is now "complete" */
@@ -4080,6 +4103,12 @@ void play_game(bool new_game)
 	while (TRUE)
 	{
 
+#ifdef LEVEL_CACHE
+		/* Remember which level this is */
+		int old_dungeon = p_ptr->dungeon;
+		int old_depth = p_ptr->depth;
+#endif /* LEVEL_CACHE */
+
 		/* Process the level */
 		dungeon();
 
@@ -4110,6 +4139,10 @@ void play_game(bool new_game)
 		/* Handle "quit and save" */
 		if (!p_ptr->playing && !p_ptr->is_dead) break;
 
+#ifdef LEVEL_CACHE
+		/* Keep the old cave for a quick return */
+		if (!p_ptr->is_dead) level_cache_save(old_dungeon, old_depth);
+#endif /* LEVEL_CACHE */
 
 		/* Erase the old cave */
 		wipe_o_list();
@@ -4184,9 +4217,32 @@ void play_game(bool new_game)
 		if (p_ptr->is_dead) break;
 
 		/* Make a new level */
+#ifdef ALLOW_BORG
+		if (borg_headless) borg_generate_cave();
+		else
+#endif
 		generate_cave();
 	}
 
+#ifdef ALLOW_BORG
+	/* The headless borg just walks away from the character */
+	if (borg_headless)
+	{
+		/* Erase the old cave */
+		wipe_o_list();
+		wipe_m_list();
+		wipe_region_piece_list();
+		wipe_region_list();
+
+		/* Allow another game */
+		character_generated = FALSE;
+		character_dungeon = FALSE;
+		p_ptr->playing = FALSE;
+
+		return;
+	}
+#endif
+
 	/* Close stuff */
 	close_game();
 
@@ -210,6 +210,10 @@ extern sint view_n;
 extern u16b *view_g;
 extern sint fire_n;
 extern u16b *fire_g;
+#ifdef VIEW_SHADOWCAST
+extern u16b *view_old_g;
+extern bool view_shadowcast;
+#endif
 extern sint temp_n;
 extern u16b *temp_g;
 extern byte *temp_y;
@@ -219,12 +223,24 @@ extern u16b *dyna_g;
 extern byte dyna_cent_y;
 extern byte dyna_cent_x;
 extern bool dyna_full;
-extern byte (*cave_info)[256];
-extern byte (*play_info)[256];
-extern s16b (*cave_feat)[DUNGEON_WID];
-extern s16b (*cave_o_idx)[DUNGEON_WID];
-extern s16b (*cave_m_idx)[DUNGEON_WID];
-extern s16b (*cave_region_piece)[DUNGEON_WID];
+extern level_type *cave_level;
+extern byte (*cave_info)[LEVEL_STRIDE];
+extern byte (*play_info)[LEVEL_STRIDE];
+extern s16b (*cave_feat)[LEVEL_STRIDE];
+extern u32b cave_feat_epoch;
+extern u32b play_view_epoch;
+#ifdef LOS_CACHE
+extern u32b los_cache_hit;
+extern u32b los_cache_miss;
+#endif
+#ifdef PATH_CACHE
+extern u32b path_cache_hit;
+extern u32b path_cache_miss;
+#endif
+extern u32b cave_pass[PASS_MAX][DUNGEON_HGT][PASS_WORDS];
+extern s16b (*cave_o_idx)[LEVEL_STRIDE];
+extern s16b (*cave_m_idx)[LEVEL_STRIDE];
+extern s16b (*cave_region_piece)[LEVEL_STRIDE];
 extern region_piece_type *region_piece_list;
 extern int region_piece_max;
 extern int region_piece_cnt;
@@ -235,10 +251,10 @@ extern void (*modify_grid_adjacent_hook)(byte *a, char *c, int y, int x, byte ad
 extern void (*modify_grid_boring_hook)(byte *a, char *c, int y, int x, byte cinfo, byte pinfo);
 extern void (*modify_grid_unseen_hook)(byte *a, char *c);
 extern void (*modify_grid_interesting_hook)(byte *a, char *c, int y, int x, byte cinfo, byte pinfo);
-extern byte (*cave_cost)[DUNGEON_WID];
-extern byte (*cave_when)[DUNGEON_WID];
+extern byte (*cave_cost)[LEVEL_STRIDE];
+extern u16b (*cave_when)[LEVEL_STRIDE];
 extern maxima *z_info;
-extern int scent_when;
+extern u16b scent_when;
 extern int flow_center_y;
 extern int flow_center_x;
 extern int update_center_y;
@@ -248,6 +264,18 @@ extern room_info_type room_info[DUN_ROOMS];
 extern byte dun_room[MAX_ROOMS_ROW][MAX_ROOMS_COL];
 extern object_type *o_list;
 extern monster_type *m_list;
+extern s16b *mon_live;
+extern s16b *mon_live_slot;
+extern s16b mon_live_n;
+extern u32b *mon_vis_key;
+extern s16b *mon_vis_race;
+extern u32b *mon_vis_new;
+extern u32b *mon_wait;
+extern byte *mon_wait_energy;
+extern s16b mon_block[MON_BLOCK_HGT * MON_BLOCK_WID];
+extern s16b *mon_block_next;
+extern s16b *mon_block_prev;
+extern s16b *mon_block_of;
 extern monster_lore *l_list;
 extern object_info *a_list;
 extern object_lore *e_list;
@@ -415,6 +443,9 @@ extern void big_putch(int x, int y, byte a, char c);
 extern void print_rel(char c, byte a, int y, int x);
 extern void note_spot(int y, int x);
 extern void lite_spot(int y, int x);
+extern void lite_spot_flush(void);
+extern void lite_spot_hold(void);
+extern void lite_spot_release(void);
 extern void prt_map(void);
 extern void prt_item_list(void);
 extern void display_map(int *cy, int *cx);
@@ -422,8 +453,12 @@ extern void do_cmd_view_map(void);
 extern errr vinfo_init(void);
 extern void forget_view(void);
 extern void update_view(void);
+#ifdef VIEW_SHADOWCAST
+extern void view_benchmark(int step, clock_t clocks[2], u32b *views, u32b *differ);
+#endif
 extern void update_dyna(void);
 extern void update_noise(void);
+extern void wipe_cave_caches(void);
 extern void update_smell(void);
 extern bool map_home(int m_idx);
 extern void map_area(void);
@@ -442,6 +477,12 @@ extern int remove_halo(int y, int x);
 extern void reapply_halo(int y, int x, int r);
 extern void apply_climb(int y, int x);
 extern void set_level_flags(int feat);
+extern level_type *level_alloc(void);
+extern void level_free(level_type *l);
+extern void level_wipe(level_type *l);
+extern void cave_level_set(level_type *l);
+extern void cave_pass_update(int y, int x);
+extern void cave_pass_rebuild(void);
 extern void cave_set_feat_aux(const int y, const int x, int feat);
 extern void cave_set_feat(const int y, const int x, int feat);
 extern int feat_state(int feat, int action);
@@ -660,6 +701,10 @@ extern void display_scores_aux(int from, int to, int note, high_score *score);
 
 /* generate.c */
 extern void generate_cave(void);
+#ifdef LEVEL_CACHE
+extern void level_cache_save(int dungeon, int depth);
+extern void level_cache_wipe(void);
+#endif /* LEVEL_CACHE */
 
 /* info.c */
 extern bool spell_desc(spell_type *s_ptr, const cptr intro, int level, bool detail, int target);
@@ -708,11 +753,13 @@ extern void init_file_paths(char *path);
 extern void create_user_dirs(void);
 extern void init_angband(void);
 extern void cleanup_angband(void);
+extern bool info_in_image(vptr p);
 void ang_atexit(void (*arg)(void));
 
 
 /* load.c */
 extern bool load_player(void);
+extern bool savefile_describe(cptr name, char *buf, int max);
 
 /* melee1.c */
 extern bool monster_scale(monster_race *n_ptr, int m_idx, int depth);
@@ -767,7 +814,11 @@ extern void delete_monster(int y, int x);
 extern void delete_monster_lite(int i);
 extern void compact_monsters(int size);
 extern void wipe_m_list(void);
+#ifdef LEVEL_CACHE
+extern void relink_m_list(void);
+#endif /* LEVEL_CACHE */
 extern s16b m_pop(void);
+extern void mon_wait_remove(int m_idx);
 extern errr get_mon_num_prep(void);
 extern s16b get_mon_num(int level);
 extern void display_monlist(int row, unsigned int width, int mode, bool command, bool force);
@@ -936,6 +987,8 @@ extern bool do_quest_resolution(void);
 /* save.c */
 extern bool save_player(void);
 extern bool save_player_bkp(bool bkp);
+extern void save_wait(void);
+extern void save_finish(void);
 
 /* spells1.c */
 extern u32b player_smart_flags(u32b f1,u32b f2,u32b f3, u32b f4);
@@ -1070,6 +1123,7 @@ extern void process_regions(void);
 extern void do_cmd_store(void);
 extern void store_shuffle(int store_index);
 extern void store_maint(int store_index);
+extern void wipe_store_list(void);
 extern int store_init(int feat);
 extern int store_carry(object_type *o_ptr, int store_index);
 
@@ -1285,6 +1339,19 @@ extern int count_change_level;   /* Turns to next level change */
 extern int count_teleport;       /* Turns to next teleport */
 extern byte allowed_depth[2];    /* Minimum and maximum depths */
 extern byte borg_dir;            /* Current direction */
+extern bool borg_headless;       /* Playing without a display */
+extern u32b borg_count_turns;    /* Turns taken by the borg */
+extern u32b borg_count_levels;   /* Levels generated for the borg */
+extern clock_t borg_clock_monsters;  /* Time spent processing monsters */
+extern clock_t borg_clock_generate;  /* Time spent generating levels */
+#ifdef VIEW_SHADOWCAST
+extern clock_t borg_clock_view[2];   /* Time spent on each view engine */
+extern u32b borg_count_views;        /* Views compared */
+extern u32b borg_count_view_differ;  /* Grids seen by only one engine */
+#endif
+extern void borg_setup(u32b turns, int stay, int min_depth, int max_depth);
+extern void borg_process_monsters(byte minimum_energy);
+extern void borg_generate_cave(void);
 #endif
 
 
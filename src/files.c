@@ -6721,7 +6721,13 @@ void close_game(void)
 void exit_game_panic(void)
 {
 	/* If nothing important has happened, just quit */
-	if (!character_generated || character_saved) quit("panic");
+	if (!character_generated || character_saved)
+	{
+		/* Let the autosave finish */
+		save_finish();
+
+		quit("panic");
+	}
 
 	/* Mega-Hack -- see "msg_print()" */
 	msg_flag = FALSE;
@@ -6745,7 +6751,14 @@ void exit_game_panic(void)
 	my_strcpy(p_ptr->died_from, "(panic save)", sizeof(p_ptr->died_from));
 
 	/* Panic save, or get worried */
-	if (!save_player()) quit("panic save failed!");
+	if (!save_player())
+	{
+		save_finish();
+		quit("panic save failed!");
+	}
+
+	/* Let the autosave finish */
+	save_finish();
 
 	/* Successful panic save */
 	quit("panic save succeeded!");
@@ -6841,7 +6854,13 @@ static void handle_signal_simple(int sig)
 
 
 	/* Nothing to save, just quit */
-	if (!character_generated || character_saved) quit(NULL);
+	if (!character_generated || character_saved)
+	{
+		/* Let the autosave finish */
+		save_finish();
+
+		quit(NULL);
+	}
 
 
 	/* Count the signals */
@@ -6924,7 +6943,13 @@ static void handle_signal_abort(int sig)
 
 
 	/* Nothing to save, just quit */
-	if (!character_generated || character_saved) quit(NULL);
+	if (!character_generated || character_saved)
+	{
+		/* Let the autosave finish */
+		save_finish();
+
+		quit(NULL);
+	}
 
 
 	/* Clear the bottom line */
@@ -6964,6 +6989,9 @@ static void handle_signal_abort(int sig)
 	/* Flush output */
 	Term_fresh();
 
+	/* Let the autosave finish */
+	save_finish();
+
 	/* Quit */
 	quit("software bug");
 }
@@ -2671,10 +2671,21 @@ static bool generate_cellular_cave(int y1, int x1, int y2, int x2, s16b wall, s1
 		grid2[yi] = C_ZNEW(size_x, byte);
 	}
 	
-	/* Initialise the starting grids randomly */
-	for(yi=1; yi<size_y-1; yi++)
-	for(xi=1; xi<size_x-1; xi++)
-		grid[yi][xi] = rand_int(100) < wall_prob ? GRID_WALL : GRID_FLOOR;
+	/* Initialise the starting grids randomly, a row of draws at a time */
+	if (size_x > 2)
+	{
+		u32b *roll = C_ZNEW(size_x - 2, u32b);
+
+		for(yi=1; yi<size_y-1; yi++)
+		{
+			Rand_fill(roll, size_x - 2, 100);
+
+			for(xi=1; xi<size_x-1; xi++)
+				grid[yi][xi] = roll[xi - 1] < (u32b)wall_prob ? GRID_WALL : GRID_FLOOR;
+		}
+
+		FREE(roll);
+	}
 	
 	/* Initialise the destination grids - for paranoia */
 	for(yi=0; yi<size_y; yi++)
@@ -3848,7 +3859,11 @@ static void generate_patt(int y1, int x1, int y2, int x2, s16b feat, u32b flag,
 						/* Hack -- if we are placing one feature, we replace it with a solid wall to ensure that it
 						 * is not overwritten later on. We take advantage of the dun->next array to do this.
 						 */
-						if ((k == 0) && (dun->next_n < NEXT_MAX)) cave_feat[y][x] = FEAT_WALL_SOLID;
+						if ((k == 0) && (dun->next_n < NEXT_MAX))
+						{
+							cave_feat[y][x] = FEAT_WALL_SOLID;
+							cave_pass_update(y, x);
+						}
 
 						/* Preserve the 'solid' status of a wall */
 						if (cave_feat[y][x] == FEAT_WALL_SOLID)
@@ -13560,6 +13575,7 @@ static void build_streamer(int feat)
 				{
 					time_to_treas = randint(chance * 2);
 					cave_feat[y][dx] = feat_state(feat, FS_STREAMER);
+					cave_pass_update(y, dx);
 				}
 			}
 		}
@@ -13594,6 +13610,7 @@ static void build_streamer(int feat)
 				{
 					time_to_treas = randint(chance * 2);
 					cave_feat[dy][x] = feat_state(feat, FS_STREAMER);
+					cave_pass_update(dy, x);
 				}
 			}
 		}
@@ -14194,6 +14211,7 @@ static void place_boundary_walls()
 		y = 0;
 
 		cave_feat[y][x] = FEAT_PERM_SOLID;
+		cave_pass_update(y, x);
 
 		cave_info[y][x] |= (CAVE_XLOS);
 		cave_info[y][x] |= (CAVE_XLOF);
@@ -14205,6 +14223,7 @@ static void place_boundary_walls()
 		y = DUNGEON_HGT-1;
 
 		cave_feat[y][x] = FEAT_PERM_SOLID;
+		cave_pass_update(y, x);
 
 		cave_info[y][x] |= (CAVE_XLOS);
 		cave_info[y][x] |= (CAVE_XLOF);
@@ -14216,6 +14235,7 @@ static void place_boundary_walls()
 		x = 0;
 
 		cave_feat[y][x] = FEAT_PERM_SOLID;
+		cave_pass_update(y, x);
 
 		cave_info[y][x] |= (CAVE_XLOS);
 		cave_info[y][x] |= (CAVE_XLOF);
@@ -14227,10 +14247,14 @@ static void place_boundary_walls()
 		x = DUNGEON_WID-1;
 
 		cave_feat[y][x] = FEAT_PERM_SOLID;
+		cave_pass_update(y, x);
 
 		cave_info[y][x] |= (CAVE_XLOS);
 		cave_info[y][x] |= (CAVE_XLOF);
 	}
+
+	/* New terrain */
+	cave_feat_epoch++;
 }
 
 
@@ -14460,7 +14484,7 @@ static bool place_tunnels()
 			}
 			
 			/* Try 'forcing' way into irregular rooms */
-			if (((retries > 5 * DUN_TRIES) && (room_info[r1].type > ROOM_HUGE_CENTRE)) || (retries > 6 * DUN_TRIES))
+			if ((r1 >= 0) && (((retries > 5 * DUN_TRIES) && (room_info[r1].type > ROOM_HUGE_CENTRE)) || (retries > 6 * DUN_TRIES)))
 			{
 				/* Ignore outer walls */
 				if ((room_info[r1].flags & (ROOM_EDGED)) == 0)
@@ -15821,66 +15845,12 @@ static bool town_gen(void)
 
 
 /*
- * Generate a random dungeon level
- *
- * Hack -- regenerate any "overflow" levels
- *
- * Note that this function resets "cave_feat" and "cave_info" directly.
+ * Make a new level for the current dungeon and depth, retrying until
+ * a valid one is made.
  */
-void generate_cave(void)
+static void generate_level(void)
 {
-	int i, j, y, x, num;
-
-	quest_event event;
-
-	/* Use this to allow quests to succeed or fail */
-	WIPE(&event, quest_event);
-
-	/* Set up departure event */
-	event.flags = EVENT_TRAVEL;
-	event.dungeon = p_ptr->dungeon;
-	event.level = p_ptr->depth;
-
-	/* Reset the monster generation level; make level feeling interesting */
-	monster_level = p_ptr->depth >= 4 ? p_ptr->depth + 2 :
-		(p_ptr->depth >= 2 ? p_ptr->depth + 1 : p_ptr->depth);
-
-	/* The dungeon is not ready */
-	character_dungeon = FALSE;
-
-	/* Important - prevent getting stuck in rock */
-	p_ptr->word_return = 0;
-	p_ptr->return_y = 0;
-	p_ptr->return_x = 0;
-
-	/* Generating */
-	if (cheat_room) message_add(format("Generating new level (level %d in %s)", p_ptr->depth, t_name + t_info[p_ptr->dungeon].name), MSG_GENERIC);
-
-	/* Reset level flags */
-	level_flag = 0;
-
-	/* Hack -- ensure quest monsters not randomly generated */
-	for (i = 0; i < MAX_Q_IDX; i++)
-	{
-		quest_type *q_ptr = &q_list[i];
-		quest_event *qe_ptr = &(q_ptr->event[q_ptr->stage]);
-
-		/* Hack -- player's actions don't change level */
-		if (q_ptr->stage == QUEST_ACTION) continue;
-
-		/* Hack: Quest occurs anywhere - don't force quest items on the level. */
-		if (!qe_ptr->dungeon) continue;
-
-		/* Quest doesn't occur on this level */
-		else if ((qe_ptr->dungeon != p_ptr->dungeon) ||
-			(qe_ptr->level != (p_ptr->depth - min_depth(p_ptr->dungeon)))) continue;
-
-		/* Mark the level as a quest level */
-		level_flag |= (LF1_QUEST);
-
-		/* Mark questors - features take precedence */
-		if ((!qe_ptr->feat) && (qe_ptr->race)) r_info[qe_ptr->race].flags1 |= (RF1_QUESTOR);
-	}
+	int i, j, num;
 
 	/* Are we using seeded dungeon generation? */
 	if (seed_dungeon)
@@ -15903,6 +15873,9 @@ void generate_cave(void)
 		o_max = 1;
 		m_max = 1;
 
+		/* New terrain */
+		cave_feat_epoch++;
+
 		/* There is no dynamic terrain */
 		dyna_full = FALSE;
 		dyna_n = 0;
@@ -15917,31 +15890,11 @@ void generate_cave(void)
 			r_info[i].cur_num = 0;
 		}
 
-		/* Start with a blank cave */
-		for (y = 0; y < DUNGEON_HGT; y++)
-		{
-			for (x = 0; x < DUNGEON_WID; x++)
-			{
-				/* No flags */
-				cave_info[y][x] = 0;
-
-				/* No flags */
-				play_info[y][x] = 0;
-
-				/* No features */
-				cave_feat[y][x] = 0;
-
-				/* No objects */
-				cave_o_idx[y][x] = 0;
-
-				/* No monsters */
-				cave_m_idx[y][x] = 0;
+		/* Start with a blank cave -- no flags, features, objects, monsters or flow */
+		level_wipe(cave_level);
 
-				/* No flow */
-				cave_cost[y][x] = 0;
-				cave_when[y][x] = 0;
-			}
-		}
+		/* Reset passability */
+		cave_pass_rebuild();
 
 		/* Clear room info */
 		for (i = 0; i < DUN_ROOMS; i++)
@@ -16078,7 +16031,522 @@ void generate_cave(void)
 			p_ptr->depth = 0;
 		}
 	}
+}
+
+
+#ifdef LEVEL_CACHE
+
+/*
+ * A level kept in memory after the character has left it.
+ */
+typedef struct level_cache_type level_cache_type;
+
+struct level_cache_type
+{
+	s16b dungeon;		/* Dungeon the level is in */
+	s16b depth;			/* Depth of the level */
+
+	u32b stamp;			/* When the level was last left */
+	u32b size;			/* Memory used by the level */
+
+	byte py;			/* Where the character left the level */
+	byte px;
+
+	level_type *level;	/* The grid arrays (NULL if unused) */
+
+	monster_type *mon;	/* The monsters */
+	s16b m_max;
+	s16b m_cnt;
+
+	object_type *obj;	/* The objects */
+	s16b o_max;
+	s16b o_cnt;
+
+	region_type *reg;	/* The regions */
+	int region_max;
+	int region_cnt;
+
+	region_piece_type *piece;	/* The region pieces */
+	int region_piece_max;
+	int region_piece_cnt;
+
+	u16b *dyna_g;		/* The dynamic grids */
+	sint dyna_n;
+	bool dyna_full;
+	byte dyna_cent_y;
+	byte dyna_cent_x;
+
+	room_info_type room_info[DUN_ROOMS];
+	byte dun_room[MAX_ROOMS_ROW][MAX_ROOMS_COL];
+
+	ecology_type ecology;
+
+	u32b level_flag;
+	byte feeling;
+	s16b rating;
+	bool good_item_flag;
+};
+
+
+/*
+ * The level cache
+ */
+static level_cache_type level_cache[LEVEL_CACHE_MAX];
+
+/*
+ * Ticks every time a level is cached, to find the least recently used
+ */
+static u32b level_cache_stamp = 0;
+
+
+/*
+ * Free the memory used by a cached level
+ */
+static void level_cache_free(level_cache_type *c_ptr)
+{
+	/* Not in use */
+	if (!c_ptr->level) return;
+
+	/* Free the arrays */
+	level_free(c_ptr->level);
+	FREE(c_ptr->mon);
+	FREE(c_ptr->obj);
+	FREE(c_ptr->reg);
+	FREE(c_ptr->piece);
+	FREE(c_ptr->dyna_g);
+
+	/* Wipe the entry */
+	WIPE(c_ptr, level_cache_type);
+}
+
+
+/*
+ * Forget all the cached levels
+ */
+void level_cache_wipe(void)
+{
+	int i;
+
+	for (i = 0; i < LEVEL_CACHE_MAX; i++) level_cache_free(&level_cache[i]);
+}
+
+
+/*
+ * Find a level in the level cache
+ */
+static level_cache_type *level_cache_find(int dungeon, int depth)
+{
+	int i;
+
+	for (i = 0; i < LEVEL_CACHE_MAX; i++)
+	{
+		if ((level_cache[i].level) && (level_cache[i].dungeon == dungeon) &&
+			(level_cache[i].depth == depth))
+		{
+			return (&level_cache[i]);
+		}
+	}
+
+	return (NULL);
+}
+
+
+/*
+ * Get an empty level cache entry for a level, throwing away the least
+ * recently used level if need be.
+ */
+static level_cache_type *level_cache_slot(int dungeon, int depth)
+{
+	level_cache_type *c_ptr = NULL;
+
+	int i;
+
+	/* Find an empty slot, or else the least recently used */
+	for (i = 0; i < LEVEL_CACHE_MAX; i++)
+	{
+		if (!level_cache[i].level)
+		{
+			c_ptr = &level_cache[i];
+			break;
+		}
+
+		if (!c_ptr || (level_cache[i].stamp < c_ptr->stamp)) c_ptr = &level_cache[i];
+	}
+
+	/* Make room */
+	level_cache_free(c_ptr);
+
+	/* Identify the level */
+	c_ptr->dungeon = dungeon;
+	c_ptr->depth = depth;
+	c_ptr->stamp = ++level_cache_stamp;
+
+	return (c_ptr);
+}
+
+
+/*
+ * Throw away the least recently used levels until the level cache is
+ * within its memory limit.
+ */
+static void level_cache_trim(void)
+{
+	u32b total;
+
+	int i;
+
+	while (TRUE)
+	{
+		level_cache_type *old_ptr = NULL;
+
+		total = 0;
+
+		for (i = 0; i < LEVEL_CACHE_MAX; i++)
+		{
+			if (!level_cache[i].level) continue;
+
+			total += level_cache[i].size;
+
+			if (!old_ptr || (level_cache[i].stamp < old_ptr->stamp)) old_ptr = &level_cache[i];
+		}
+
+		if (total <= LEVEL_CACHE_MEMORY) break;
+
+		level_cache_free(old_ptr);
+	}
+}
+
+
+/*
+ * Copy the current level into a level cache entry
+ */
+static void level_cache_store(level_cache_type *c_ptr)
+{
+	/* Copy the grid arrays */
+	c_ptr->level = level_alloc();
+	(void)memcpy(c_ptr->level, cave_level, offsetof(level_type, block));
+
+	/* Copy the monsters */
+	c_ptr->m_max = m_max;
+	c_ptr->m_cnt = m_cnt;
+	c_ptr->mon = C_ZNEW(m_max, monster_type);
+	C_COPY(c_ptr->mon, m_list, m_max, monster_type);
+
+	/* Copy the objects */
+	c_ptr->o_max = o_max;
+	c_ptr->o_cnt = o_cnt;
+	c_ptr->obj = C_ZNEW(o_max, object_type);
+	C_COPY(c_ptr->obj, o_list, o_max, object_type);
+
+	/* Copy the regions */
+	c_ptr->region_max = region_max;
+	c_ptr->region_cnt = region_cnt;
+	c_ptr->reg = C_ZNEW(region_max, region_type);
+	C_COPY(c_ptr->reg, region_list, region_max, region_type);
+
+	c_ptr->region_piece_max = region_piece_max;
+	c_ptr->region_piece_cnt = region_piece_cnt;
+	c_ptr->piece = C_ZNEW(region_piece_max, region_piece_type);
+	C_COPY(c_ptr->piece, region_piece_list, region_piece_max, region_piece_type);
+
+	/* Copy the dynamic grids */
+	c_ptr->dyna_n = dyna_n;
+	c_ptr->dyna_full = dyna_full;
+	c_ptr->dyna_cent_y = dyna_cent_y;
+	c_ptr->dyna_cent_x = dyna_cent_x;
+	c_ptr->dyna_g = C_ZNEW(dyna_n + 1, u16b);
+	C_COPY(c_ptr->dyna_g, dyna_g, dyna_n, u16b);
+
+	/* Copy the rooms and ecology */
+	C_COPY(c_ptr->room_info, room_info, DUN_ROOMS, room_info_type);
+	C_COPY(c_ptr->dun_room, dun_room, MAX_ROOMS_ROW, byte[MAX_ROOMS_COL]);
+	COPY(&c_ptr->ecology, &cave_ecology, ecology_type);
+
+	/* Copy the level type */
+	c_ptr->level_flag = level_flag;
+	c_ptr->feeling = feeling;
+	c_ptr->rating = rating;
+	c_ptr->good_item_flag = good_item_flag;
+
+	/* Work out the memory used */
+	c_ptr->size = sizeof(level_cache_type) + sizeof(level_type) + LEVEL_ALIGN +
+		m_max * sizeof(monster_type) + o_max * sizeof(object_type) +
+		region_max * sizeof(region_type) +
+		region_piece_max * sizeof(region_piece_type) +
+		(dyna_n + 1) * sizeof(u16b);
+}
+
+
+/*
+ * Copy a level cache entry back into the current level
+ */
+static void level_cache_fetch(level_cache_type *c_ptr)
+{
+	/* Copy the level type */
+	level_flag = c_ptr->level_flag;
+	feeling = c_ptr->feeling;
+	rating = c_ptr->rating;
+	good_item_flag = c_ptr->good_item_flag;
+
+	/* Copy the grid arrays */
+	(void)memcpy(cave_level, c_ptr->level, offsetof(level_type, block));
+
+	/* Copy the rooms and ecology */
+	C_COPY(room_info, c_ptr->room_info, DUN_ROOMS, room_info_type);
+	C_COPY(dun_room, c_ptr->dun_room, MAX_ROOMS_ROW, byte[MAX_ROOMS_COL]);
+	COPY(&cave_ecology, &c_ptr->ecology, ecology_type);
+
+	/* Copy the dynamic grids */
+	dyna_n = c_ptr->dyna_n;
+	dyna_full = c_ptr->dyna_full;
+	dyna_cent_y = c_ptr->dyna_cent_y;
+	dyna_cent_x = c_ptr->dyna_cent_x;
+	C_COPY(dyna_g, c_ptr->dyna_g, dyna_n, u16b);
+
+	/* Copy the regions */
+	region_max = c_ptr->region_max;
+	region_cnt = c_ptr->region_cnt;
+	C_COPY(region_list, c_ptr->reg, region_max, region_type);
+
+	region_piece_max = c_ptr->region_piece_max;
+	region_piece_cnt = c_ptr->region_piece_cnt;
+	C_COPY(region_piece_list, c_ptr->piece, region_piece_max, region_piece_type);
+
+	/* Copy the objects */
+	o_max = c_ptr->o_max;
+	o_cnt = c_ptr->o_cnt;
+	C_COPY(o_list, c_ptr->obj, o_max, object_type);
+
+	/* Copy the monsters */
+	m_max = c_ptr->m_max;
+	m_cnt = c_ptr->m_cnt;
+	C_COPY(m_list, c_ptr->mon, m_max, monster_type);
+}
+
+
+/*
+ * Keep a copy of the current level in the level cache.
+ *
+ * This is called when the character leaves a level, before the
+ * objects, monsters and regions are wiped.  "dungeon" and "depth"
+ * describe the level being left, as the character has already
+ * moved on to the new one.
+ *
+ * Only levels left by stairs are kept, and then only if they can be
+ * returned to by connected stairs.  Towns, surface levels (which
+ * change with the time of day), battlefields and quest levels are
+ * always generated afresh.
+ */
+void level_cache_save(int dungeon, int depth)
+{
+	level_cache_type *c_ptr;
+
+	/* Forget any older copy of this level */
+	c_ptr = level_cache_find(dungeon, depth);
+	if (c_ptr) level_cache_free(c_ptr);
+
+	/* Level cannot be returned to */
+	if (adult_no_stairs || !p_ptr->create_stair) return;
+
+	/* Level is always generated afresh */
+	if (level_flag & (LF1_TOWN | LF1_SURFACE | LF1_BATTLE | LF1_QUEST)) return;
+
+	/* Paranoia -- the character is not on the level */
+	if (!in_bounds_fully(p_ptr->py, p_ptr->px)) return;
+
+	/* Get a slot */
+	c_ptr = level_cache_slot(dungeon, depth);
+
+	/* Remember where the character left */
+	c_ptr->py = p_ptr->py;
+	c_ptr->px = p_ptr->px;
+
+	/* Copy the level */
+	level_cache_store(c_ptr);
+
+	/* The character is not on the level */
+	c_ptr->level->cave_m_idx[c_ptr->py][c_ptr->px] = 0;
+
+	/* Stay within the memory limit */
+	level_cache_trim();
+}
+
+
+/*
+ * Try to restore the current level from the level cache.
+ *
+ * The character must have arrived by connected stairs, and the level
+ * must have been left by a staircase of the kind the character would
+ * otherwise have been placed on.
+ *
+ * Returns TRUE if the level was restored.
+ */
+static bool level_cache_load(void)
+{
+	level_cache_type *c_ptr;
+
+	int i, py, px;
+
+	/* Did not arrive by connected stairs */
+	if (adult_no_stairs || !p_ptr->create_stair) return (FALSE);
+
+	/* Quest levels are always generated afresh */
+	if (level_flag & (LF1_QUEST)) return (FALSE);
+
+	/* Find the level */
+	c_ptr = level_cache_find(p_ptr->dungeon, p_ptr->depth);
+
+	/* Not cached */
+	if (!c_ptr) return (FALSE);
+
+	/* Character left by a different kind of staircase */
+	if (!(f_info[c_ptr->level->cave_feat[c_ptr->py][c_ptr->px]].flags1 &
+		f_info[p_ptr->create_stair].flags1 & (FF1_LESS | FF1_MORE)))
+	{
+		level_cache_free(c_ptr);
+		return (FALSE);
+	}
+
+	/* Remember where the character left */
+	py = c_ptr->py;
+	px = c_ptr->px;
+
+	/* New terrain */
+	cave_feat_epoch++;
+
+	/* Copy the level */
+	level_cache_fetch(c_ptr);
+
+#ifdef MONSTER_FLOW
+	/* Forget the old flow and scent */
+	C_WIPE(cave_cost, DUNGEON_HGT, byte[LEVEL_STRIDE]);
+	C_WIPE(cave_when, DUNGEON_HGT, u16b[LEVEL_STRIDE]);
+#endif /* MONSTER_FLOW */
+
+	/* Done with the cached copy */
+	level_cache_free(c_ptr);
+
+	/* Reset 'quest' status of monsters */
+	for (i = 0; i < z_info->r_max; i++)
+	{
+		r_info[i].flags1 &= ~(RF1_QUESTOR);
+	}
+
+	/* Relink the monsters */
+	relink_m_list();
+
+	/* Unknown artifacts were released when the level was left */
+	for (i = 1; i < o_max; i++)
+	{
+		object_type *o_ptr = &o_list[i];
+
+		/* Skip dead objects */
+		if (!o_ptr->k_idx) continue;
+
+		/* Only unknown artifacts */
+		if (!artifact_p(o_ptr) || object_known_p(o_ptr)) continue;
+
+		/* Artifact has been made again elsewhere */
+		if (a_info[o_ptr->name1].cur_num) delete_object_idx(i);
+
+		/* Claim the artifact back */
+		else a_info[o_ptr->name1].cur_num = 1;
+	}
+
+	/* Hack -- illegal panel */
+	p_ptr->wy = DUNGEON_HGT;
+	p_ptr->wx = DUNGEON_WID;
+
+	/* Reset the object generation level */
+	object_level = p_ptr->depth;
+
+	/* Place the character where they left */
+	(void)player_place(py, px, FALSE);
+
+	/* The staircase is already here */
+	p_ptr->create_stair = 0;
+
+	/* Success */
+	return (TRUE);
+}
+
+#endif /* LEVEL_CACHE */
+
+
+/*
+ * Generate a random dungeon level
+ *
+ * Hack -- regenerate any "overflow" levels
+ *
+ * Note that this function resets "cave_feat" and "cave_info" directly.
+ */
+void generate_cave(void)
+{
+	int i;
+
+	bool cached = FALSE;
+
+	quest_event event;
+
+	/* Use this to allow quests to succeed or fail */
+	WIPE(&event, quest_event);
+
+	/* Set up departure event */
+	event.flags = EVENT_TRAVEL;
+	event.dungeon = p_ptr->dungeon;
+	event.level = p_ptr->depth;
+
+	/* Reset the monster generation level; make level feeling interesting */
+	monster_level = p_ptr->depth >= 4 ? p_ptr->depth + 2 :
+		(p_ptr->depth >= 2 ? p_ptr->depth + 1 : p_ptr->depth);
+
+	/* The dungeon is not ready */
+	character_dungeon = FALSE;
+
+	/* Important - prevent getting stuck in rock */
+	p_ptr->word_return = 0;
+	p_ptr->return_y = 0;
+	p_ptr->return_x = 0;
+
+	/* Generating */
+	if (cheat_room) message_add(format("Generating new level (level %d in %s)", p_ptr->depth, t_name + t_info[p_ptr->dungeon].name), MSG_GENERIC);
+
+	/* Reset level flags */
+	level_flag = 0;
+
+	/* Hack -- ensure quest monsters not randomly generated */
+	for (i = 0; i < MAX_Q_IDX; i++)
+	{
+		quest_type *q_ptr = &q_list[i];
+		quest_event *qe_ptr = &(q_ptr->event[q_ptr->stage]);
+
+		/* Hack -- player's actions don't change level */
+		if (q_ptr->stage == QUEST_ACTION) continue;
+
+		/* Hack: Quest occurs anywhere - don't force quest items on the level. */
+		if (!qe_ptr->dungeon) continue;
+
+		/* Quest doesn't occur on this level */
+		else if ((qe_ptr->dungeon != p_ptr->dungeon) ||
+			(qe_ptr->level != (p_ptr->depth - min_depth(p_ptr->dungeon)))) continue;
+
+		/* Mark the level as a quest level */
+		level_flag |= (LF1_QUEST);
+
+		/* Mark questors - features take precedence */
+		if ((!qe_ptr->feat) && (qe_ptr->race)) r_info[qe_ptr->race].flags1 |= (RF1_QUESTOR);
+	}
+
+#ifdef LEVEL_CACHE
+	/* Return to a level we have just left */
+	cached = level_cache_load();
+#endif /* LEVEL_CACHE */
+
+	/* Make a new level */
+	if (!cached) generate_level();
 
+	/* Catch terrain that was set directly */
+	cave_pass_rebuild();
 
 	/* The dungeon is ready */
 	character_dungeon = TRUE;
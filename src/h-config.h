@@ -255,6 +255,24 @@
 # endif
 #endif
 
+/*
+ * OPTION: Define "HAVE_MMAP" only if "mmap()" exists.
+ *
+ * (Set in autoconf.h when HAVE_CONFIG_H -- i.e. when configure is used.)
+ */
+#if defined(SET_UID) && !defined(HAVE_CONFIG_H)
+# define HAVE_MMAP
+#endif
+
+/*
+ * OPTION: Define "HAVE_FSYNC" only if "fsync()" exists.
+ *
+ * (Set in autoconf.h when HAVE_CONFIG_H -- i.e. when configure is used.)
+ */
+#if defined(SET_UID) && !defined(HAVE_CONFIG_H)
+# define HAVE_FSYNC
+#endif
+
 
 
 #endif
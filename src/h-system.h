@@ -18,6 +18,7 @@
 
 
 #include <stdio.h>
+#include <stddef.h>
 #include <ctype.h>
 #include <errno.h>
 #include <assert.h>
@@ -91,6 +92,12 @@
 
 # include <sys/stat.h>
 
+# include <dirent.h>
+
+# ifdef HAVE_MMAP
+#  include <sys/mman.h>
+# endif
+
 # if defined(SOLARIS)
 #  include <netdb.h>
 # endif
@@ -105,6 +112,11 @@
 
 #include <stdarg.h>
 
+#ifdef HAVE_PTHREAD
+# include <pthread.h>
+# include <signal.h>
+#endif
+
 
 #endif
 
@@ -123,6 +123,9 @@ typedef signed long s32b;
 typedef unsigned long u32b;
 #endif
 
+/* Unsigned 64 bit value */
+typedef uint64_t u64b;
+
 
 #endif
 
@@ -162,10 +162,16 @@ extern errr emit_u_info_index(FILE *fp, header *head, int i);
 
 
 /*
- * Error tracking
+ * Error tracking (each thread which parses files has its own)
  */
-extern int error_idx;
-extern int error_line;
+#ifdef PARSE_THREADS
+# define PARSE_LOCAL	__thread
+#else /* PARSE_THREADS */
+# define PARSE_LOCAL
+#endif /* PARSE_THREADS */
+
+extern PARSE_LOCAL int error_idx;
+extern PARSE_LOCAL int error_line;
 
 #endif /* ALLOW_TEMPLATES */
 
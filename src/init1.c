@@ -1401,6 +1401,187 @@ static cptr quest_event_info_flags[] =
 
 
 
+/*** Flag name lookup ***/
+
+
+/*
+ * Perfect hash tables for the tables of 32 flag names.
+ *
+ * Each table of flag names gets FLAG_HASH_SIZE slots, and a seed for
+ * which no two different names hash into the same slot.  Finding a name
+ * then takes one hash and at most one string comparison, instead of a
+ * comparison with each of the 32 names in turn.  The same tables of names
+ * are used by the template output code, which goes from flag to name.
+ *
+ * The seeds are searched for the first time a "*.txt" file is parsed.
+ * With four slots for every name, a seed without collisions turns up
+ * after about fifty tries.  If no seed is found, the names are simply
+ * searched in turn.
+ */
+#define FLAG_HASH_SIZE	128
+#define FLAG_HASH_TRIES	10000
+
+typedef struct flag_hash_type flag_hash_type;
+
+struct flag_hash_type
+{
+	cptr *names;			/* The table of 32 flag names */
+
+	u32b seed;			/* Seed without collisions, or zero */
+
+	byte slot[FLAG_HASH_SIZE];	/* Index + 1 of the name in each slot */
+};
+
+static flag_hash_type flag_hash[] =
+{
+	{ d_info_sflags },
+	{ d_info_pflags },
+	{ d_info_lflags },
+	{ method_info_flags1 },
+	{ method_info_flags2 },
+	{ region_info_flags1 },
+	{ f_info_flags1 },
+	{ f_info_flags2 },
+	{ f_info_flags3 },
+	{ r_info_flags1 },
+	{ r_info_flags2 },
+	{ r_info_flags3 },
+	{ r_info_flags4 },
+	{ r_info_flags5 },
+	{ r_info_flags6 },
+	{ r_info_flags7 },
+	{ r_info_flags8 },
+	{ r_info_flags9 },
+	{ k_info_flags1 },
+	{ k_info_flags2 },
+	{ k_info_flags3 },
+	{ k_info_flags4 },
+	{ k_info_flags5 },
+	{ k_info_flags6 },
+	{ s_info_flags1 },
+	{ s_info_flags2 },
+	{ s_info_flags3 },
+	{ quest_event_info_flags },
+	{ NULL }
+};
+
+/*
+ * Find the perfect hash table of a table of names by its address
+ */
+#define FLAG_HASH_INDEX	64
+
+static flag_hash_type *flag_hash_index[FLAG_HASH_INDEX];
+
+#ifdef PARSE_THREADS
+static pthread_once_t flag_hash_once = PTHREAD_ONCE_INIT;
+#else /* PARSE_THREADS */
+static bool flag_hash_done = FALSE;
+#endif /* PARSE_THREADS */
+
+
+/*
+ * Hash a flag name (FNV-1a, with the seed mixed in)
+ */
+static u32b flag_hash_string(cptr s, u32b seed)
+{
+	u32b h = 2166136261UL ^ seed;
+
+	while (*s) h = ((h ^ (byte)*s++) * 16777619UL) & 0xFFFFFFFFUL;
+
+	return (h ^ (h >> 15));
+}
+
+
+/*
+ * Find the perfect hash table for a table of names, if any
+ */
+static flag_hash_type *flag_hash_find(cptr names[])
+{
+	int i = (int)(((size_t)names >> 3) % FLAG_HASH_INDEX);
+
+	while (flag_hash_index[i])
+	{
+		if (flag_hash_index[i]->names == names) return (flag_hash_index[i]);
+
+		i = (i + 1) % FLAG_HASH_INDEX;
+	}
+
+	return (NULL);
+}
+
+
+/*
+ * Search for a seed which puts every name in a slot of its own
+ */
+static void flag_hash_build(flag_hash_type *fh)
+{
+	bool repeat[32];
+
+	u32b seed;
+	int i, j, k;
+
+	/* Only the first of several equal names can ever be found */
+	for (i = 0; i < 32; i++)
+	{
+		repeat[i] = FALSE;
+
+		for (j = 0; j < i; j++)
+		{
+			if (streq(fh->names[i], fh->names[j])) repeat[i] = TRUE;
+		}
+	}
+
+	for (seed = 1; seed <= FLAG_HASH_TRIES; seed++)
+	{
+		C_WIPE(fh->slot, FLAG_HASH_SIZE, byte);
+
+		for (i = 0; i < 32; i++)
+		{
+			if (repeat[i]) continue;
+
+			k = flag_hash_string(fh->names[i], seed) % FLAG_HASH_SIZE;
+
+			/* Collision */
+			if (fh->slot[k]) break;
+
+			fh->slot[k] = i + 1;
+		}
+
+		/* Success */
+		if (i == 32)
+		{
+			fh->seed = seed;
+			return;
+		}
+	}
+
+	/* Failure -- search the names in turn */
+	fh->seed = 0;
+}
+
+
+/*
+ * Build the perfect hash tables for all the tables of flag names
+ */
+static void init_flag_hash(void)
+{
+	int i, j;
+
+	for (i = 0; flag_hash[i].names; i++)
+	{
+		flag_hash_build(&flag_hash[i]);
+
+		/* Index it by address */
+		j = (int)(((size_t)flag_hash[i].names >> 3) % FLAG_HASH_INDEX);
+
+		while (flag_hash_index[j]) j = (j + 1) % FLAG_HASH_INDEX;
+
+		flag_hash_index[j] = &flag_hash[i];
+	}
+}
+
+
+
 /*** Initialize from ascii template files ***/
 
 
@@ -1421,6 +1602,14 @@ errr init_info_txt(FILE *fp, char *buf, header *head,
 	/* Just before the first line */
 	error_line = 0;
 
+	/* Prepare the flag names, once */
+#ifdef PARSE_THREADS
+	(void)pthread_once(&flag_hash_once, init_flag_hash);
+#else /* PARSE_THREADS */
+	if (!flag_hash_done) init_flag_hash();
+	flag_hash_done = TRUE;
+#endif /* PARSE_THREADS */
+
 
 	/* Prepare the "fake" stuff */
 	head->name_size = 0;
@@ -1924,27 +2113,50 @@ errr parse_z_info(char *buf, header *head)
 
 
 /*
- * Grab one flag from a textual string
+ * Find the index of a flag name in a table of 32 flag names
  */
-static errr grab_one_flag(u32b *flags, cptr names[], cptr what)
+static int flag_name_index(cptr names[], cptr what)
 {
+	flag_hash_type *fh = flag_hash_find(names);
+
 	int i;
 
+	/* Use the perfect hash table */
+	if (fh && fh->seed)
+	{
+		i = fh->slot[flag_hash_string(what, fh->seed) % FLAG_HASH_SIZE];
+
+		/* Check the only name which can match */
+		if (i && streq(what, names[i - 1])) return (i - 1);
+
+		return (-1);
+	}
+
 	/* Check flags */
 	for (i = 0; i < 32; i++)
 	{
-		if (streq(what, names[i]))
-		{
-			*flags |= (1L << i);
-
-			return (0);
-		}
+		if (streq(what, names[i])) return (i);
 	}
 
 	return (-1);
 }
 
 
+/*
+ * Grab one flag from a textual string
+ */
+static errr grab_one_flag(u32b *flags, cptr names[], cptr what)
+{
+	int i = flag_name_index(names, what);
+
+	if (i < 0) return (-1);
+
+	*flags |= (1L << i);
+
+	return (0);
+}
+
+
 
 /*
  * Grab one level flag in an vault_type from a textual string
@@ -2913,16 +3125,12 @@ errr parse_region_info(char *buf, header *head)
  */
 static errr grab_one_offset(byte *offset, cptr names[], cptr what)
 {
-	int i;
+	int i = flag_name_index(names, what);
 
-	/* Check flags */
-	for (i = 0; i < 32; i++)
+	if (i >= 0)
 	{
-		if (streq(what, names[i]))
-		{
-			*offset = *offset+i;
-			return (0);
-		}
+		*offset = *offset+i;
+		return (0);
 	}
 
 	*offset = *offset+32;
@@ -2935,16 +3143,12 @@ static errr grab_one_offset(byte *offset, cptr names[], cptr what)
  */
 static errr grab_one_offset_u16b(u16b *offset, cptr names[], cptr what)
 {
-	int i;
+	int i = flag_name_index(names, what);
 
-	/* Check flags */
-	for (i = 0; i < 32; i++)
+	if (i >= 0)
 	{
-		if (streq(what, names[i]))
-		{
-			*offset = *offset + i;
-			return (0);
-		}
+		*offset = *offset + i;
+		return (0);
 	}
 
 	*offset = *offset + 32;
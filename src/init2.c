@@ -330,8 +330,8 @@ void create_user_dirs(void)
 /*
  * Hack -- help give useful error messages
  */
-int error_idx;
-int error_line;
+PARSE_LOCAL int error_idx;
+PARSE_LOCAL int error_line;
 
 
 /*
@@ -394,6 +394,22 @@ header rsv_head;
 /*** Initialize from binary image files ***/
 
 
+/*
+ * Check that a header read from a binary image fits a "*_info" array
+ */
+static bool init_info_test(const header *test, const header *head)
+{
+	return ((test->v_major == head->v_major) &&
+	        (test->v_minor == head->v_minor) &&
+	        (test->v_patch == head->v_patch) &&
+	        (test->v_extra == head->v_extra) &&
+	        (test->info_num == head->info_num) &&
+	        (test->info_len == head->info_len) &&
+	        (test->head_size == head->head_size) &&
+	        (test->info_size == head->info_size));
+}
+
+
 /*
  * Initialize a "*_info" array, by parsing a binary "image" file
  */
@@ -404,14 +420,7 @@ static errr init_info_raw(int fd, header *head)
 
 	/* Read and verify the header */
 	if (fd_read(fd, (char*)(&test), sizeof(header)) ||
-	    (test.v_major != head->v_major) ||
-	    (test.v_minor != head->v_minor) ||
-	    (test.v_patch != head->v_patch) ||
-	    (test.v_extra != head->v_extra) ||
-	    (test.info_num != head->info_num) ||
-	    (test.info_len != head->info_len) ||
-	    (test.head_size != head->head_size) ||
-	    (test.info_size != head->info_size))
+	    !init_info_test(&test, head))
 	{
 		/* Error */
 		return (-1);
@@ -451,6 +460,458 @@ static errr init_info_raw(int fd, header *head)
 }
 
 
+#ifdef INFO_IMAGE
+
+/*
+ * All of the "*_info" arrays can also be kept in a single binary image,
+ * "info.raw", which is mapped straight into memory at startup (or read
+ * in one go, where "mmap()" is missing).  The arrays are then used where
+ * they lie, without any allocation or copying.
+ *
+ * The image starts with an "info_image_head", followed by one entry for
+ * each array.  Each array is stored exactly as in its own "*.raw" file,
+ * starting on a page boundary.  The mapping is private, so changes made
+ * to the arrays during play are never written back, and the pages that
+ * are never changed (most of them) are shared with other running games.
+ *
+ * The checksum covers the image head and the table of entries, and so
+ * guards the whole layout at once.  Each array still has its header
+ * checked as it is used, which costs next to nothing.
+ *
+ * Whenever an array cannot be taken from the image (because there is no
+ * image, or the "*.txt" file is newer, or the array has changed size) it
+ * is loaded in the old way, and a new image is written once all of the
+ * arrays are ready.
+ */
+
+#define INFO_IMAGE_MAX		32
+#define INFO_IMAGE_ALIGN	4096L
+
+typedef struct info_image_head info_image_head;
+
+struct info_image_head
+{
+	char magic[4];		/* "INFO" */
+
+	byte v_major;		/* Version -- major */
+	byte v_minor;		/* Version -- minor */
+	byte v_patch;		/* Version -- patch */
+	byte v_extra;		/* Version -- extra */
+
+	u16b num;		/* Number of arrays */
+	u16b head_size;		/* Size of each array "header" */
+
+	u32b size;		/* Size of the whole image */
+	u32b check;		/* Checksum of everything before the arrays */
+};
+
+typedef struct info_image_entry info_image_entry;
+
+struct info_image_entry
+{
+	char name[16];		/* Name of the "*.txt" file */
+
+	u32b offset;		/* Start of the array in the image */
+	u32b size;		/* Size of the array, including its header */
+};
+
+
+/*
+ * The current image, if any
+ */
+static char *info_image = NULL;
+static u32b info_image_size = 0L;
+static bool info_image_mapped = FALSE;
+
+/*
+ * The image file is kept open until all of the arrays are ready, so that
+ * its modification date can be checked
+ */
+static int info_image_fd = -1;
+
+/*
+ * The arrays which go into the next image, in order of initialization
+ */
+static int info_image_num = 0;
+static cptr info_image_name[INFO_IMAGE_MAX];
+static header *info_image_list[INFO_IMAGE_MAX];
+
+/*
+ * Some array could not be taken from the image
+ */
+static bool info_image_stale = FALSE;
+
+
+/*
+ * Work out the checksum of an image head and its table of entries
+ */
+static u32b info_image_check(const info_image_head *ih, const info_image_entry *ie)
+{
+	const byte *p;
+	size_t i, n;
+
+	u32b check = 2166136261UL;
+
+	/* Everything in the head except the checksum itself */
+	p = (const byte *)ih;
+	n = sizeof(info_image_head) - sizeof(u32b);
+
+	for (i = 0; i < n; i++) check = (check ^ p[i]) * 16777619UL;
+
+	/* The table of entries */
+	p = (const byte *)ie;
+	n = ih->num * sizeof(info_image_entry);
+
+	for (i = 0; i < n; i++) check = (check ^ p[i]) * 16777619UL;
+
+	return (check);
+}
+
+
+/*
+ * Forget the current image
+ */
+static void close_info_image(void)
+{
+	if (info_image_fd >= 0) fd_close(info_image_fd);
+	info_image_fd = -1;
+
+	if (!info_image) return;
+
+#ifdef HAVE_MMAP
+	if (info_image_mapped) (void)munmap(info_image, info_image_size);
+#endif /* HAVE_MMAP */
+
+	if (!info_image_mapped) FREE(info_image);
+
+	info_image = NULL;
+	info_image_size = 0L;
+	info_image_mapped = FALSE;
+}
+
+
+/*
+ * Load the image, and check that it holds together
+ */
+static void init_info_image(void)
+{
+	char buf[1024];
+
+	info_image_head ih;
+	info_image_entry *ie;
+
+	int i;
+
+	/* Until shown otherwise */
+	info_image_stale = TRUE;
+
+	/* Build the filename */
+	path_build(buf, 1024, ANGBAND_DIR_DATA, "info.raw");
+
+	/* Attempt to open the image */
+	info_image_fd = fd_open(buf, O_RDONLY);
+	if (info_image_fd < 0) return;
+
+	/* Read and verify the head */
+	if (fd_read(info_image_fd, (char*)(&ih), sizeof(info_image_head)) ||
+	    (memcmp(ih.magic, "INFO", 4) != 0) ||
+	    (ih.v_major != VERSION_MAJOR) ||
+	    (ih.v_minor != VERSION_MINOR) ||
+	    (ih.v_patch != VERSION_PATCH) ||
+	    (ih.v_extra != VERSION_EXTRA) ||
+	    (ih.head_size != sizeof(header)) ||
+	    (ih.num > INFO_IMAGE_MAX) ||
+	    (ih.size < sizeof(info_image_head) + ih.num * sizeof(info_image_entry)))
+	{
+		close_info_image();
+		return;
+	}
+
+#ifdef HAVE_MMAP
+	{
+		struct stat st;
+
+		/* Map the whole image, if it is all there */
+		if (!fstat(info_image_fd, &st) && (st.st_size >= (off_t)ih.size))
+		{
+			vptr p = mmap(NULL, ih.size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			              info_image_fd, 0);
+
+			if (p != MAP_FAILED)
+			{
+				info_image = (char *)p;
+				info_image_mapped = TRUE;
+			}
+		}
+	}
+#endif /* HAVE_MMAP */
+
+	/* Read the whole image instead */
+	if (!info_image)
+	{
+		info_image = C_ZNEW(ih.size, char);
+
+		if (fd_seek(info_image_fd, 0L) ||
+		    fd_read(info_image_fd, info_image, ih.size))
+		{
+			FREE(info_image);
+			info_image = NULL;
+		}
+	}
+
+	/* Failure */
+	if (!info_image)
+	{
+		close_info_image();
+		return;
+	}
+
+	info_image_size = ih.size;
+
+	/* Verify the checksum */
+	ie = (info_image_entry *)(info_image + sizeof(info_image_head));
+
+	if (info_image_check(&ih, ie) != ih.check)
+	{
+		close_info_image();
+		return;
+	}
+
+	/* Verify the table of entries */
+	for (i = 0; i < ih.num; i++)
+	{
+		if ((ie[i].offset % INFO_IMAGE_ALIGN) ||
+		    (ie[i].size < sizeof(header)) ||
+		    (ie[i].offset > ih.size) ||
+		    (ie[i].size > ih.size - ie[i].offset))
+		{
+			close_info_image();
+			return;
+		}
+	}
+
+	/* So far so good */
+	info_image_stale = FALSE;
+}
+
+
+/*
+ * Initialize a "*_info" array from the image, if it is there
+ */
+static errr init_info_image_aux(cptr filename, header *head)
+{
+	info_image_head *ih;
+	info_image_entry *ie;
+
+	header *test;
+
+	int i;
+
+	/* No image */
+	if (!info_image) return (-1);
+
+	ih = (info_image_head *)info_image;
+	ie = (info_image_entry *)(info_image + sizeof(info_image_head));
+
+	/* Find the array */
+	for (i = 0; i < ih->num; i++)
+	{
+		if (streq(ie[i].name, filename)) break;
+	}
+
+	/* Not there */
+	if (i == ih->num) return (-1);
+
+#ifdef ALLOW_TEMPLATES
+#ifdef CHECK_MODIFICATION_TIME
+
+	/* The "*.txt" file has changed */
+	if (check_modification_date(info_image_fd, format("%s.txt", filename))) return (-1);
+
+#endif /* CHECK_MODIFICATION_TIME */
+#endif /* ALLOW_TEMPLATES */
+
+	/* Verify the header */
+	test = (header *)(info_image + ie[i].offset);
+
+	if (!init_info_test(test, head) ||
+	    (ie[i].size != test->head_size + test->info_size +
+	                   test->name_size + test->text_size))
+	{
+		return (-1);
+	}
+
+	/* Accept the sizes */
+	head->name_size = test->name_size;
+	head->text_size = test->text_size;
+
+	/* Use the arrays in place */
+	head->info_ptr = info_image + ie[i].offset + test->head_size;
+
+	if (head->name_size)
+		head->name_ptr = (char *)head->info_ptr + head->info_size;
+
+	if (head->text_size)
+		head->text_ptr = (char *)head->info_ptr + head->info_size + head->name_size;
+
+	/* Success */
+	return (0);
+}
+
+
+/*
+ * Write a new image, holding every "*_info" array as it stands.
+ *
+ * This is done once all the arrays are loaded, and before anything
+ * has had a chance to change them.  The image is written to a new file
+ * and then moved into place, so that an old image which is still mapped
+ * is never changed underneath us.
+ */
+static void save_info_image(void)
+{
+	char buf[1024];
+	char tmp[1024];
+
+	info_image_head ih;
+	info_image_entry ie[INFO_IMAGE_MAX];
+
+	char *pad;
+
+	u32b pos, end;
+
+	int fd, i;
+
+	errr err = 0;
+
+	/* Too many arrays */
+	if (info_image_num > INFO_IMAGE_MAX) return;
+
+	/* Prepare the head */
+	WIPE(&ih, info_image_head);
+	C_WIPE(ie, INFO_IMAGE_MAX, info_image_entry);
+
+	memcpy(ih.magic, "INFO", 4);
+	ih.v_major = VERSION_MAJOR;
+	ih.v_minor = VERSION_MINOR;
+	ih.v_patch = VERSION_PATCH;
+	ih.v_extra = VERSION_EXTRA;
+	ih.num = info_image_num;
+	ih.head_size = sizeof(header);
+
+	/* Lay out the arrays */
+	end = sizeof(info_image_head) + info_image_num * sizeof(info_image_entry);
+
+	for (i = 0; i < info_image_num; i++)
+	{
+		header *head = info_image_list[i];
+
+		my_strcpy(ie[i].name, info_image_name[i], sizeof(ie[i].name));
+
+		ie[i].offset = (end + INFO_IMAGE_ALIGN - 1) & ~(INFO_IMAGE_ALIGN - 1);
+		ie[i].size = head->head_size + head->info_size +
+		             head->name_size + head->text_size;
+
+		end = ie[i].offset + ie[i].size;
+	}
+
+	ih.size = end;
+	ih.check = info_image_check(&ih, ie);
+
+	/* File type is "DATA" */
+	FILE_TYPE(FILE_TYPE_DATA);
+
+	/* Build the filenames */
+	path_build(buf, 1024, ANGBAND_DIR_DATA, "info.raw");
+	path_build(tmp, 1024, ANGBAND_DIR_DATA, "info.new");
+
+	/* Grab permissions */
+	safe_setuid_grab();
+
+	/* Create a new file */
+	(void)fd_kill(tmp);
+	fd = fd_make(tmp, 0644);
+
+	/* Drop permissions */
+	safe_setuid_drop();
+
+	/* The image is only a convenience */
+	if (fd < 0) return;
+
+	/* Dump the head and the table of entries */
+	err = fd_write(fd, (cptr)&ih, sizeof(info_image_head));
+	if (!err) err = fd_write(fd, (cptr)ie, info_image_num * sizeof(info_image_entry));
+
+	pos = sizeof(info_image_head) + info_image_num * sizeof(info_image_entry);
+
+	pad = C_ZNEW(INFO_IMAGE_ALIGN, char);
+
+	/* Dump the arrays */
+	for (i = 0; !err && (i < info_image_num); i++)
+	{
+		header *head = info_image_list[i];
+
+		/* Pad to the start of the array */
+		err = fd_write(fd, pad, ie[i].offset - pos);
+
+		/* Dump it, just like a "*.raw" file */
+		if (!err) err = fd_write(fd, (cptr)head, head->head_size);
+		if (!err) err = fd_write(fd, (char*)head->info_ptr, head->info_size);
+		if (!err && head->name_size) err = fd_write(fd, head->name_ptr, head->name_size);
+		if (!err && head->text_size) err = fd_write(fd, head->text_ptr, head->text_size);
+
+		pos = ie[i].offset + ie[i].size;
+	}
+
+	FREE(pad);
+
+	/* Close */
+	fd_close(fd);
+
+	/* Grab permissions */
+	safe_setuid_grab();
+
+	/* Replace the old image, or throw away a bad new one */
+	if (!err) (void)fd_move(tmp, buf);
+	else (void)fd_kill(tmp);
+
+	/* Drop permissions */
+	safe_setuid_drop();
+}
+
+
+/*
+ * All of the arrays are ready.  Write a new image if needed.
+ */
+static void finish_info_image(void)
+{
+	if (info_image_stale) save_info_image();
+
+	/* The file itself is no longer needed */
+	if (info_image_fd >= 0) fd_close(info_image_fd);
+	info_image_fd = -1;
+}
+
+#endif /* INFO_IMAGE */
+
+
+/*
+ * Is some memory part of the image of the "*_info" arrays?
+ *
+ * Such memory must never be freed.
+ */
+bool info_in_image(vptr p)
+{
+#ifdef INFO_IMAGE
+	return (info_image && ((char *)p >= info_image) &&
+	        ((char *)p < info_image + info_image_size));
+#else /* INFO_IMAGE */
+	(void)p;
+
+	return (FALSE);
+#endif /* INFO_IMAGE */
+}
+
+
 /*
  * Initialize the header of an *_info.raw file.
  */
@@ -499,6 +960,237 @@ static void display_parse_error(cptr filename, errr err, cptr buf)
 	quit_fmt("Error in '%s.txt' file.", filename);
 }
 
+
+/*
+ * Parse an ascii template file into a new set of "fake" arrays.
+ *
+ * Returns -1 if the file cannot be opened.  On any other error, "buf"
+ * holds the line which caused it.
+ *
+ * This may be called on a thread other than the main one, and so
+ * must not use "format()".
+ */
+static errr init_info_parse(cptr filename, header *head, char *buf)
+{
+	FILE *fp;
+
+	errr err;
+
+	char name[80];
+
+
+	/*** Make the fake arrays ***/
+
+	/* Allocate the "*_info" array */
+	head->info_ptr = C_ZNEW(head->info_size, char);
+
+	/* MegaHack -- make "fake" arrays */
+	if (z_info)
+	{
+		head->name_ptr = C_ZNEW(z_info->fake_name_size, char);
+		head->text_ptr = C_ZNEW(z_info->fake_text_size, char);
+	}
+
+
+	/*** Load the ascii template file ***/
+
+	/* Build the filename */
+	strnfmt(name, sizeof(name), "%s.txt", filename);
+	path_build(buf, 1024, ANGBAND_DIR_EDIT, name);
+
+	/* Open the file */
+	fp = my_fopen(buf, "r");
+
+	/* No file */
+	if (!fp) return (-1);
+
+	/* Parse it */
+	err = init_info_txt(fp, buf, head, head->parse_info_txt);
+
+	/* Close it */
+	my_fclose(fp);
+
+	return (err);
+}
+
+
+#ifdef PARSE_THREADS
+
+/*
+ * When some "*.raw" files are out of date, the "*.txt" files which can
+ * be parsed without looking at any other array are parsed ahead of time,
+ * each on a thread of its own, while the main thread goes on loading
+ * (or parsing) everything else in the usual order.
+ *
+ * Each thread parses into a private copy of the header, so nothing it
+ * does is seen until "init_info()" joins it.  Evaluation (for example
+ * "eval_r_power()"), template output and the dumping of the "*.raw"
+ * file all happen after the join, on the main thread, in the usual
+ * order.  The parsers keep their place in "error_idx" and "error_line",
+ * of which each thread has its own.
+ */
+
+typedef struct parse_job parse_job;
+
+struct parse_job
+{
+	cptr filename;		/* Name of the "*.txt" file */
+	header *head;		/* The real header */
+	header work;		/* Private copy of the header */
+
+	pthread_t thread;	/* The parsing thread */
+
+	errr err;		/* Result of parsing */
+	int error_idx;		/* Place of the error, if any */
+	int error_line;
+
+	char buf[1024];		/* The last line parsed */
+};
+
+#define PARSE_JOB_MAX	32
+
+static parse_job parse_jobs[PARSE_JOB_MAX];
+static int parse_job_num = 0;
+
+/*
+ * Hack -- "init_info()" should only start parsing the files which are
+ * out of date
+ */
+static bool parse_ahead = FALSE;
+
+
+/*
+ * Parse a file on a thread of its own
+ */
+static void *parse_job_run(void *arg)
+{
+	parse_job *job = (parse_job *)arg;
+
+	/* Parse it */
+	job->err = init_info_parse(job->filename, &job->work, job->buf);
+
+	/* Remember where any error happened */
+	job->error_idx = error_idx;
+	job->error_line = error_line;
+
+	return (NULL);
+}
+
+
+/*
+ * Start parsing a file ahead of time
+ */
+static void parse_job_start(cptr filename, header *head)
+{
+	parse_job *job;
+
+	/* Too many files -- parse it later */
+	if (parse_job_num >= PARSE_JOB_MAX) return;
+
+	job = &parse_jobs[parse_job_num];
+
+	job->filename = filename;
+	job->head = head;
+
+	/* Work on a copy of the header */
+	COPY(&job->work, head, header);
+
+	/* No thread -- parse it later */
+	if (pthread_create(&job->thread, NULL, parse_job_run, job)) return;
+
+	parse_job_num++;
+}
+
+
+/*
+ * Wait until a file which was parsed ahead of time is done, and take the
+ * results.  Returns FALSE if the file was not parsed ahead of time.
+ */
+static bool parse_job_join(header *head, char *buf, errr *err)
+{
+	int i;
+
+	for (i = 0; i < parse_job_num; i++)
+	{
+		parse_job *job = &parse_jobs[i];
+
+		/* Not this file */
+		if (job->head != head) continue;
+
+		/* Wait for it */
+		(void)pthread_join(job->thread, NULL);
+
+		/* Forget it */
+		job->head = NULL;
+
+		/* Take the "fake" arrays */
+		head->info_ptr = job->work.info_ptr;
+		head->name_ptr = job->work.name_ptr;
+		head->text_ptr = job->work.text_ptr;
+		head->name_size = job->work.name_size;
+		head->text_size = job->work.text_size;
+
+		/* Take the result */
+		my_strcpy(buf, job->buf, 1024);
+		error_idx = job->error_idx;
+		error_line = job->error_line;
+
+		*err = job->err;
+
+		return (TRUE);
+	}
+
+	return (FALSE);
+}
+
+
+/*
+ * Check whether an array can be loaded without parsing its "*.txt" file
+ */
+static bool init_info_fresh(cptr filename, header *head)
+{
+	char buf[1024];
+
+	header test;
+
+	int fd;
+
+	bool fresh = TRUE;
+
+#ifdef INFO_IMAGE
+
+	/* The image will do */
+	if (!init_info_image_aux(filename, head)) return (TRUE);
+
+#endif /* INFO_IMAGE */
+
+	/* Build the filename */
+	path_build(buf, 1024, ANGBAND_DIR_DATA, format("%s.raw", filename));
+
+	/* Attempt to open the "raw" file */
+	fd = fd_open(buf, O_RDONLY);
+
+	/* No file */
+	if (fd < 0) return (FALSE);
+
+#ifdef CHECK_MODIFICATION_TIME
+
+	fresh = !check_modification_date(fd, format("%s.txt", filename));
+
+#endif /* CHECK_MODIFICATION_TIME */
+
+	/* Verify the header */
+	if (fresh) fresh = (!fd_read(fd, (char*)(&test), sizeof(header)) &&
+	                    init_info_test(&test, head));
+
+	/* Close it */
+	fd_close(fd);
+
+	return (fresh);
+}
+
+#endif /* PARSE_THREADS */
+
 #endif /* ALLOW_TEMPLATES */
 
 
@@ -514,11 +1206,8 @@ static errr init_info(cptr filename, header *head)
 
 	errr err = 1;
 
-#ifdef ALLOW_TEMPLATES
-	FILE *fp;
-#endif
-
 #ifdef ALLOW_TEMPLATES_OUTPUT
+	FILE *fp;
 	FILE *fpout;
 #endif
 
@@ -526,6 +1215,39 @@ static errr init_info(cptr filename, header *head)
 	char buf[1024];
 
 
+#ifdef PARSE_THREADS
+
+	/* Hack -- only start parsing the files which are out of date */
+	if (parse_ahead)
+	{
+		if (!init_info_fresh(filename, head)) parse_job_start(filename, head);
+
+		return (0);
+	}
+
+#endif /* PARSE_THREADS */
+
+#ifdef INFO_IMAGE
+
+	/*** Use the image of all the arrays ***/
+
+	/* Remember the array for the next image */
+	if (info_image_num < INFO_IMAGE_MAX)
+	{
+		info_image_name[info_image_num] = filename;
+		info_image_list[info_image_num] = head;
+	}
+
+	info_image_num++;
+
+	/* Use the image */
+	if (!init_info_image_aux(filename, head)) return (0);
+
+	/* The image needs to be written again */
+	info_image_stale = TRUE;
+
+#endif /* INFO_IMAGE */
+
 #ifdef ALLOW_TEMPLATES
 
 	/*** Load the binary image file ***/
@@ -556,35 +1278,19 @@ static errr init_info(cptr filename, header *head)
 	/* Do we have to parse the *.txt file? */
 	if (err)
 	{
-		/*** Make the fake arrays ***/
-
-		/* Allocate the "*_info" array */
-		head->info_ptr = C_ZNEW(head->info_size, char);
-
-		/* MegaHack -- make "fake" arrays */
-		if (z_info)
-		{
-			head->name_ptr = C_ZNEW(z_info->fake_name_size, char);
-			head->text_ptr = C_ZNEW(z_info->fake_text_size, char);
-		}
-
-
-		/*** Load the ascii template file ***/
-
-		/* Build the filename */
-		path_build(buf, 1024, ANGBAND_DIR_EDIT, format("%s.txt", filename));
-
-		/* Open the file */
-		fp = my_fopen(buf, "r");
+		/*** Parse the ascii template file ***/
 
+#ifdef PARSE_THREADS
+		/* Take the results of parsing ahead of time, or parse it now */
+		if (!parse_job_join(head, buf, &err))
+			err = init_info_parse(filename, head, buf);
+#else /* PARSE_THREADS */
 		/* Parse it */
-		if (!fp) quit(format("Cannot open '%s.txt' file.", filename));
+		err = init_info_parse(filename, head, buf);
+#endif /* PARSE_THREADS */
 
-		/* Parse and output the files */
-		err = init_info_txt(fp, buf, head, head->parse_info_txt);
-
-		/* Close it */
-		my_fclose(fp);
+		/* No file */
+		if (err < 0) quit(format("Cannot open '%s.txt' file.", filename));
 
 		/* Errors */
 		if (err) display_parse_error(filename, err, buf);
@@ -746,13 +1452,13 @@ static errr init_info(cptr filename, header *head)
  */
 static errr free_info(header *head)
 {
-	if (head->info_size)
+	if (head->info_size && !info_in_image(head->info_ptr))
 		FREE(head->info_ptr);
 
-	if (head->name_size)
+	if (head->name_size && !info_in_image(head->name_ptr))
 		FREE(head->name_ptr);
 
-	if (head->text_size)
+	if (head->text_size && !info_in_image(head->text_ptr))
 		FREE(head->text_ptr);
 
 	/* Success */
@@ -1549,6 +2255,24 @@ static errr init_q_info(void)
 	return (err);
 }
 
+
+#ifdef PARSE_THREADS
+
+/*
+ * The arrays whose "*.txt" files can be parsed ahead of time, because
+ * their parsers look at no other arrays (apart from "z_info")
+ */
+static errr (*parse_ahead_info[])(void) =
+{
+	init_effect_info, init_k_info, init_a_info, init_n_info,
+	init_e_info, init_x_info, init_v_info, init_h_info,
+	init_c_info, init_w_info, init_y_info, init_u_info,
+	init_b_info, init_g_info, init_rsv_info, init_q_info,
+	NULL
+};
+
+#endif /* PARSE_THREADS */
+
 /*** Initialize others ***/
 
 errr init_slays(void)
@@ -1613,12 +2337,20 @@ static errr init_other(void)
 	/* Array of grids */
 	fire_g = C_ZNEW(VIEW_MAX, u16b);
 
+#ifdef VIEW_SHADOWCAST
+	/* Array of grids */
+	view_old_g = C_ZNEW(VIEW_MAX, u16b);
+#endif /* VIEW_SHADOWCAST */
+
 	/* Array of grids */
 	temp_g = C_ZNEW(TEMP_MAX, u16b);
 
-	/* Hack -- use some memory twice */
-	temp_y = ((byte*)(temp_g)) + 0;
-	temp_x = ((byte*)(temp_g)) + TEMP_MAX;
+	/*
+	 * Arrays of grids -- these must not share memory with "temp_g", as
+	 * "update_view()" uses that in the middle of a projection.
+	 */
+	temp_y = C_ZNEW(TEMP_MAX, byte);
+	temp_x = C_ZNEW(TEMP_MAX, byte);
 
 	/* Array of grids */
 	dyna_g = C_ZNEW(DYNA_MAX, u16b);
@@ -1631,29 +2363,11 @@ static errr init_other(void)
 
 	/*** Prepare dungeon arrays ***/
 
-	/* Padded into array */
-	cave_info = C_ZNEW(DUNGEON_HGT, byte_256);
-
-	/* Padded into array */
-	play_info = C_ZNEW(DUNGEON_HGT, byte_256);
-
-	/* Region piece array */
-	cave_region_piece = C_ZNEW(DUNGEON_HGT, s16b_wid);
-
-	/* Feature array */
-	cave_feat = C_ZNEW(DUNGEON_HGT, s16b_wid);
+	/* All the grid arrays of the level */
+	cave_level = level_alloc();
 
-	/* Entity arrays */
-	cave_o_idx = C_ZNEW(DUNGEON_HGT, s16b_wid);
-	cave_m_idx = C_ZNEW(DUNGEON_HGT, s16b_wid);
-
-#ifdef MONSTER_FLOW
-
-	/* Flow arrays */
-	cave_cost = C_ZNEW(DUNGEON_HGT, byte_wid);
-	cave_when = C_ZNEW(DUNGEON_HGT, byte_wid);
-
-#endif /* MONSTER_FLOW */
+	/* Point the cave arrays into it */
+	cave_level_set(cave_level);
 
 	/*** Prepare "vinfo" array ***/
 
@@ -1669,6 +2383,24 @@ static errr init_other(void)
 	/* Monsters */
 	m_list = C_ZNEW(z_info->m_max, monster_type);
 
+	/* Live monsters */
+	mon_live = C_ZNEW(z_info->m_max, s16b);
+	mon_live_slot = C_ZNEW(z_info->m_max, s16b);
+
+	/* Monster visibility */
+	mon_vis_key = C_ZNEW(z_info->m_max, u32b);
+	mon_vis_race = C_ZNEW(z_info->m_max, s16b);
+	mon_vis_new = C_ZNEW(z_info->m_max, u32b);
+
+	/* Monsters yet to move */
+	mon_wait = C_ZNEW(MON_WAIT_WORDS, u32b);
+	mon_wait_energy = C_ZNEW(z_info->m_max, byte);
+
+	/* Monster blocks */
+	mon_block_next = C_ZNEW(z_info->m_max, s16b);
+	mon_block_prev = C_ZNEW(z_info->m_max, s16b);
+	mon_block_of = C_ZNEW(z_info->m_max, s16b);
+
 	/* Region pieces */
 	region_piece_list = C_ZNEW(z_info->region_piece_max, region_piece_type);
 
@@ -2192,6 +2924,10 @@ static void init_angband_aux(cptr why)
  */
 void init_angband(void)
 {
+#ifdef PARSE_THREADS
+	int i;
+#endif /* PARSE_THREADS */
+
 	int fd;
 
 	int mode = 0644;
@@ -2298,10 +3034,22 @@ void init_angband(void)
 
 	/*** Initialize some arrays ***/
 
+#ifdef INFO_IMAGE
+	/* Load the image of all the arrays */
+	init_info_image();
+#endif /* INFO_IMAGE */
+
 	/* Initialize size info */
 	note("[Initializing array sizes...]");
 	if (init_z_info()) quit("Cannot initialize sizes");
 
+#ifdef PARSE_THREADS
+	/* Start parsing the files which need no other arrays, if out of date */
+	parse_ahead = TRUE;
+	for (i = 0; parse_ahead_info[i]; i++) (void)(*parse_ahead_info[i])();
+	parse_ahead = FALSE;
+#endif /* PARSE_THREADS */
+
 	/* Initialize effect info */
 	note("[Initializing arrays... (effects)]");
 	if (init_effect_info()) quit("Cannot initialize effects");
@@ -2402,6 +3150,11 @@ void init_angband(void)
 	note("[Initializing arrays... (quests)]");
 	if (init_q_info()) quit("Cannot initialize quests");
 
+#ifdef INFO_IMAGE
+	/* Write a new image of all the arrays, if needed */
+	finish_info_image();
+#endif /* INFO_IMAGE */
+
 	/* Initialize some other arrays */
 	note("[Initializing arrays... (other)]");
 	if (init_other()) quit("Cannot initialize other stuff");
@@ -2454,6 +3207,9 @@ void cleanup_angband(void)
 
 	ang_atexit(0);
 
+	/* Finish any autosave */
+	save_wait();
+
 	/* Free the macros */
 	for (i = 0; i < macro__num; ++i)
 	{
@@ -2504,26 +3260,27 @@ void cleanup_angband(void)
 	/* Free the lore, monster, and object lists */
 	FREE(l_list);
 	FREE(m_list);
+	FREE(mon_live);
+	FREE(mon_live_slot);
+	FREE(mon_vis_key);
+	FREE(mon_vis_race);
+	FREE(mon_vis_new);
+	FREE(mon_wait);
+	FREE(mon_wait_energy);
+	FREE(mon_block_next);
+	FREE(mon_block_prev);
+	FREE(mon_block_of);
 	FREE(o_list);
 	FREE(region_piece_list);
 	FREE(region_list);
 
-#ifdef MONSTER_FLOW
-
-	/* Flow arrays */
-	FREE(cave_when);
-	FREE(cave_cost);
-
-#endif /* MONSTER_FLOW */
-
 	/* Free the cave */
-	FREE(cave_o_idx);
-	FREE(cave_m_idx);
-	FREE(cave_region_piece);
+	level_free(cave_level);
 
-	FREE(cave_feat);
-	FREE(cave_info);
-	FREE(play_info);
+#ifdef LEVEL_CACHE
+	/* Free the cached levels */
+	level_cache_wipe();
+#endif /* LEVEL_CACHE */
 
 	/* Free the "update_view()" array */
 	FREE(view_g);
@@ -2531,8 +3288,15 @@ void cleanup_angband(void)
 	/* Free the "update_view()" array */
 	FREE(fire_g);
 
-	/* Free the temp array */
+#ifdef VIEW_SHADOWCAST
+	/* Free the "update_view()" array */
+	FREE(view_old_g);
+#endif /* VIEW_SHADOWCAST */
+
+	/* Free the temp arrays */
 	FREE(temp_g);
+	FREE(temp_y);
+	FREE(temp_x);
 
 	/* Free the messages */
 	messages_free();
@@ -2566,6 +3330,11 @@ void cleanup_angband(void)
 	free_info(&effect_head);
 	free_info(&z_head);
 
+#ifdef INFO_IMAGE
+	/* Forget the image of the arrays */
+	close_info_image();
+#endif /* INFO_IMAGE */
+
 	/* Free the format() buffer */
 	vformat_kill();
 
@@ -46,9 +46,61 @@
 
 
 /*
- * Local "savefile" pointer
+ * The savefile, read into memory in one go
  */
-static FILE	*fff;
+static byte	*sf_file;
+static u32b	sf_file_len;
+
+/*
+ * Hack -- old savefiles are a single encoded stream
+ */
+static bool	sf_encoded;
+
+/*
+ * A section of a newer savefile, unpacked when it is first read
+ */
+typedef struct sf_part sf_part;
+
+struct sf_part
+{
+	byte *data;	/* Unpacked data, if any */
+	u32b pos;	/* Current position */
+
+	u16b codec;	/* How it is stored */
+	u32b offset;	/* Where it is stored in the file */
+	u32b packed;	/* Stored size */
+	u32b size;	/* Real size */
+	u32b check;	/* Checksum of the real data */
+};
+
+static sf_part	sf_part_list[SF_MAX];
+
+/*
+ * The section being read
+ */
+static int	sf_cur;
+
+/*
+ * The stream being read (the section, or the whole of an old savefile)
+ */
+static byte	*sf_buf;
+static u32b	sf_len;
+
+/*
+ * Current position in the stream
+ */
+static u32b	sf_pos;
+
+/*
+ * Bytes already added to the checksums
+ */
+static u32b	sf_done;
+
+/*
+ * Hack -- we tried to read past the end of the savefile, or a section
+ * of it is broken
+ */
+static bool	sf_short;
 
 /*
  * Hack -- old "encryption" byte
@@ -158,26 +210,255 @@ static bool wearable_p(const object_type *o_ptr)
 
 /*
  * The following functions are used to load the basic building blocks
- * of savefiles.  They also maintain the "checksum" info.
+ * of savefiles.  The checksums are only worked out when they are
+ * needed, by "sf_check()".
  */
 
 static byte sf_get(void)
 {
 	byte c, v;
 
-	/* Get a character, decode the value */
-	c = getc(fff) & 0xFF;
+	/* Hack -- the savefile is too short */
+	if (sf_pos >= sf_len)
+	{
+		sf_short = TRUE;
+		return (0);
+	}
+
+	/* Get a character */
+	c = sf_buf[sf_pos++];
+
+	/* Newer savefiles are not encoded */
+	if (!sf_encoded) return (c);
+
+	/* Decode the value */
 	v = c ^ xor_byte;
 	xor_byte = c;
 
-	/* Maintain the checksum info */
-	v_check += v;
-	x_check += xor_byte;
-
 	/* Return the value */
 	return (v);
 }
 
+
+#ifdef VERIFY_CHECKSUMS
+
+/*
+ * Add up the four bytes of a word
+ */
+static u32b sf_sum(u32b w)
+{
+	w = (w & 0x00FF00FFL) + ((w >> 8) & 0x00FF00FFL);
+
+	return ((w & 0xFFFFL) + ((w >> 16) & 0xFFFFL));
+}
+
+
+/*
+ * Add the bytes read since the last call to the checksums, a word at
+ * a time.  Each value is an encoded byte XORed with the one before.
+ */
+static void sf_check(void)
+{
+	byte *s = sf_buf + sf_done;
+	byte *e = sf_buf + sf_pos;
+
+	u32b w, c = s[-1];
+
+	/* Four bytes at a time */
+	for (; e - s >= 4; s += 4)
+	{
+		w = (u32b)s[0] | ((u32b)s[1] << 8) | ((u32b)s[2] << 16) |
+		    ((u32b)s[3] << 24);
+
+		x_check += sf_sum(w);
+		v_check += sf_sum(w ^ (((w << 8) | c) & 0xFFFFFFFFL));
+
+		c = s[3];
+	}
+
+	/* The leftovers */
+	for (; s < e; s++)
+	{
+		x_check += *s;
+		v_check += (*s ^ c);
+
+		c = *s;
+	}
+
+	sf_done = sf_pos;
+}
+
+#endif /* VERIFY_CHECKSUMS */
+
+
+/*
+ * Get a two byte value
+ */
+static u16b sf_u16b(const byte *s)
+{
+	return ((u16b)(s[0] | (s[1] << 8)));
+}
+
+
+/*
+ * Get a four byte value
+ */
+static u32b sf_u32b(const byte *s)
+{
+	return ((u32b)s[0] | ((u32b)s[1] << 8) | ((u32b)s[2] << 16) |
+	        ((u32b)s[3] << 24));
+}
+
+
+#ifdef VERIFY_CHECKSUMS
+
+/*
+ * Checksum a section (32 bit FNV-1a)
+ */
+static u32b sf_checksum(const byte *s, u32b len)
+{
+	u32b h = 2166136261UL;
+
+	while (len--) h = ((h ^ *s++) * 16777619UL) & 0xFFFFFFFFL;
+
+	return (h);
+}
+
+#endif /* VERIFY_CHECKSUMS */
+
+
+/*
+ * Read a packed length of 15 or more, after the 15 in the token
+ */
+static bool sf_unpack_len(const byte **ipp, const byte *end, u32b *np)
+{
+	const byte *ip = *ipp;
+	byte b;
+
+	do
+	{
+		if (ip >= end) return (FALSE);
+
+		b = *ip++;
+		*np += b;
+	}
+	while (b == 255);
+
+	*ipp = ip;
+
+	return (TRUE);
+}
+
+
+/*
+ * Unpack "len" bytes of LZ77 sequences from "ip" into exactly "size"
+ * bytes at "dst".  See "sf_pack()" in "save.c".
+ */
+static bool sf_unpack(const byte *ip, u32b len, byte *dst, u32b size)
+{
+	const byte *end = ip + len;
+
+	byte *op = dst;
+	byte *oend = dst + size;
+
+	u32b lit, mlen, dist;
+	byte token;
+
+	while (ip < end)
+	{
+		token = *ip++;
+
+		/* Literals */
+		lit = token >> 4;
+		if ((lit == 15) && !sf_unpack_len(&ip, end, &lit)) return (FALSE);
+
+		if (((u32b)(end - ip) < lit) || ((u32b)(oend - op) < lit)) return (FALSE);
+
+		C_COPY(op, ip, lit, byte);
+		op += lit;
+		ip += lit;
+
+		/* The last sequence has no match */
+		if (ip >= end) break;
+
+		/* Match */
+		if (end - ip < 2) return (FALSE);
+		dist = sf_u16b(ip);
+		ip += 2;
+
+		mlen = token & 0x0F;
+		if ((mlen == 15) && !sf_unpack_len(&ip, end, &mlen)) return (FALSE);
+		mlen += 4;
+
+		if (!dist || (dist > (u32b)(op - dst)) || (mlen > (u32b)(oend - op))) return (FALSE);
+
+		/* Copy a byte at a time, as the match may overlap */
+		for (; mlen; mlen--, op++) *op = op[-(long)dist];
+	}
+
+	return (op == oend);
+}
+
+
+/*
+ * Switch to reading section "n" of a newer savefile, unpacking it if
+ * needed.  Old savefiles are read straight through.
+ */
+static void sf_section(int n)
+{
+	sf_part *s_ptr = &sf_part_list[n];
+
+	/* Old savefile */
+	if (sf_encoded) return;
+
+	/* Put away the current section */
+	if (sf_cur >= 0) sf_part_list[sf_cur].pos = sf_pos;
+
+	/* Unpack the new one */
+	if (!s_ptr->data && s_ptr->size)
+	{
+		bool ok;
+
+		s_ptr->data = C_RNEW(s_ptr->size, byte);
+
+		/* Packed */
+		if (s_ptr->codec == 1)
+		{
+			ok = sf_unpack(sf_file + s_ptr->offset, s_ptr->packed, s_ptr->data, s_ptr->size);
+		}
+
+		/* Plain */
+		else
+		{
+			ok = ((s_ptr->codec == 0) && (s_ptr->packed == s_ptr->size));
+			if (ok) C_COPY(s_ptr->data, sf_file + s_ptr->offset, s_ptr->size, byte);
+		}
+
+#ifdef VERIFY_CHECKSUMS
+		/* Verify */
+		if (ok && (sf_checksum(s_ptr->data, s_ptr->size) != s_ptr->check))
+		{
+			ok = FALSE;
+		}
+#endif /* VERIFY_CHECKSUMS */
+
+		/* Broken section */
+		if (!ok)
+		{
+			FREE(s_ptr->data);
+			s_ptr->size = 0L;
+			sf_short = TRUE;
+		}
+	}
+
+	/* Read from it */
+	sf_cur = n;
+	sf_buf = s_ptr->data;
+	sf_len = s_ptr->size;
+	sf_pos = s_ptr->pos;
+}
+
+
 static void rd_byte(byte *ip)
 {
 	*ip = sf_get();
@@ -616,6 +897,35 @@ static void rd_monster(monster_type *m_ptr)
 
 
 
+/*
+ * Read the index of the next entry in a list of "num" lore entries,
+ * after the entry "i".
+ *
+ * Older savefiles list every entry in turn.  Newer ones only list the
+ * entries which differ from a blank baseline, each preceded by its
+ * index, and end the list with 0xFFFF.
+ *
+ * Returns -1 at the end of the list, and -2 for a bad index.
+ */
+static int rd_lore_index(int i, int num)
+{
+	u16b tmp16u;
+
+	/* Every entry in turn */
+	if (older_than(0, 7, 0, 2)) return ((i + 1 < num) ? i + 1 : -1);
+
+	rd_u16b(&tmp16u);
+
+	/* End of the list */
+	if (tmp16u == 0xFFFF) return (-1);
+
+	/* Indexes only ever go up */
+	if ((tmp16u >= num) || ((int)tmp16u <= i)) return (-2);
+
+	return (tmp16u);
+}
+
+
 /*
  * Read the monster lore
  */
@@ -895,13 +1205,33 @@ static void rd_randomizer(void)
 	/* Tmp */
 	rd_u16b(&tmp16u);
 
-	/* Place */
-	rd_u16b(&Rand_place);
+	/* Place (unused) */
+	rd_u16b(&tmp16u);
+
+	/* Clear the state */
+	for (i = 0; i < RAND_DEG; i++) Rand_state[i] = 0;
+
+	/*
+	 * State -- the 64-bit words are in 32-bit halves at the start of
+	 * the old 63 entry table.  The old table of an older savefile
+	 * makes as good a state as any.
+	 */
+	for (i = 0; i < 63; i++)
+	{
+		u32b tmp32u;
+
+		rd_u32b(&tmp32u);
+
+		if (i < RAND_DEG * 2)
+		{
+			Rand_state[i / 2] |= (u64b)(tmp32u & 0xFFFFFFFFL) << ((i % 2) * 32);
+		}
+	}
 
-	/* State */
-	for (i = 0; i < RAND_DEG; i++)
+	/* Hack -- the state must never be all zero */
+	if (!(Rand_state[0] | Rand_state[1] | Rand_state[2] | Rand_state[3]))
 	{
-		rd_u32b(&Rand_state[i]);
+		Rand_state_init(0L);
 	}
 
 	/* Accept */
@@ -1906,6 +2236,10 @@ static errr rd_dungeon(void)
 		}
 	}
 
+	/* New terrain */
+	cave_feat_epoch++;
+	cave_pass_rebuild();
+
 	/*** Player ***/
 
 	/* Fix depth */
@@ -2561,16 +2895,33 @@ static errr rd_savefile_new_aux(void)
 	note(format("Loading a %d.%d.%d.%d savefile...",
 	    sf_major, sf_minor, sf_patch, sf_extra));
 
-	/* Strip the version bytes */
-	strip_bytes(4);
+	/* Old savefile */
+	if (sf_encoded)
+	{
+		/* Strip the version bytes */
+		strip_bytes(4);
+
+		/* Hack -- decrypt */
+		xor_byte = sf_extra;
+	}
+
+	/* Newer savefile */
+	else
+	{
+		char buf[160];
 
-	/* Hack -- decrypt */
-	xor_byte = sf_extra;
+		/* The file header */
+		sf_section(SF_HEADER);
+
+		/* Skip the description */
+		rd_string(buf, sizeof(buf));
+	}
 
 
 	/* Clear the checksums */
 	v_check = 0L;
 	x_check = 0L;
+	sf_done = sf_pos;
 
 
 	/* Operating system info */
@@ -2604,6 +2955,7 @@ static errr rd_savefile_new_aux(void)
 
 
 	/* Then the "messages" */
+	sf_section(SF_MESSAGES);
 	rd_messages();
 	if (arg_fiddle) note("Loaded Messages");
 
@@ -2612,6 +2964,7 @@ static errr rd_savefile_new_aux(void)
 	if (arg_fiddle) note("Loaded Help Tips");
 
 	/* Monster Memory */
+	sf_section(SF_LORE);
 	rd_u16b(&tmp16u);
 
 	/* Incompatible save files */
@@ -2621,12 +2974,28 @@ static errr rd_savefile_new_aux(void)
 		return (-1);
 	}
 
-	/* Read the available records */
+	/* Start from a blank memory */
 	for (i = 0; i < tmp16u; i++)
+	{
+		monster_race *r_ptr = &r_info[i];
+
+		WIPE(&l_list[i], monster_lore);
+
+		r_ptr->max_num = (r_ptr->flags1 & (RF1_UNIQUE)) ? 1 : 100;
+	}
+
+	/* Read the available records */
+	for (i = -1; (i = rd_lore_index(i, tmp16u)) >= 0; )
 	{
 		/* Read the lore */
 		rd_lore(i);
 	}
+
+	if (i < -1)
+	{
+		note("Bad monster memory!");
+		return (-1);
+	}
 	if (arg_fiddle) note("Loaded Monster Memory");
 
 
@@ -2640,11 +3009,22 @@ static errr rd_savefile_new_aux(void)
 		return (-1);
 	}
 
-	/* Read the object memory */
+	/* Start from a blank memory */
 	for (i = 0; i < tmp16u; i++)
 	{
 		object_kind *k_ptr = &k_info[i];
 
+		k_ptr->aware = 0;
+		k_ptr->guess = 0;
+		k_ptr->ever_used = 0;
+		k_ptr->used = 0;
+	}
+
+	/* Read the object memory */
+	for (i = -1; (i = rd_lore_index(i, tmp16u)) >= 0; )
+	{
+		object_kind *k_ptr = &k_info[i];
+
 		byte tmp8u;
 
 		if (older_than(0,6,3,6))
@@ -2668,10 +3048,17 @@ static errr rd_savefile_new_aux(void)
 			rd_s16b(&k_ptr->used);
 		}
 	}
+
+	if (i < -1)
+	{
+		note("Bad object memory!");
+		return (-1);
+	}
 	if (arg_fiddle) note("Loaded Object Memory");
 
 
 	/* Load the Quests */
+	sf_section(SF_PLAYER);
 	rd_u16b(&tmp16u);
 
 	/* Incompatible save files */
@@ -2716,9 +3103,11 @@ static errr rd_savefile_new_aux(void)
 	if (arg_fiddle) note("Loaded Quests");
 
 	/* Read the randart seed */
+	sf_section(SF_RANDARTS);
 	rd_u32b(&seed_randart);
 
 	/* Load the Artifact lore */
+	sf_section(SF_LORE);
 	rd_u16b(&tmp16u);
 
 	/* Incompatible save files */
@@ -2730,8 +3119,17 @@ static errr rd_savefile_new_aux(void)
 
 	z_info->a_max = tmp16u;
 
-	/* Read the artifact flags */
+	/* Start from blank knowledge */
 	for (i = 0; i < tmp16u; i++)
+	{
+		WIPE(&a_list[i], object_info);
+
+		a_info[i].cur_num = 0;
+		a_info[i].activated = 0;
+	}
+
+	/* Read the artifact flags */
+	for (i = -1; (i = rd_lore_index(i, tmp16u)) >= 0; )
 	{
 		object_info *n_ptr = &a_list[i];
 
@@ -2760,6 +3158,11 @@ static errr rd_savefile_new_aux(void)
 		rd_byte(&tmp8u);
 	}
 
+	if (i < -1)
+	{
+		note("Bad artifact lore!");
+		return (-1);
+	}
 	if (arg_fiddle) note("Loaded Artifact Lore");
 
 	/* Load the Ego items */
@@ -2772,8 +3175,16 @@ static errr rd_savefile_new_aux(void)
 		return (-1);
 	}
 
-	/* Read the ego item flags */
+	/* Start from blank knowledge */
 	for (i = 0; i < tmp16u; i++)
+	{
+		WIPE(&e_list[i], object_lore);
+
+		e_info[i].aware = 0;
+	}
+
+	/* Read the ego item flags */
+	for (i = -1; (i = rd_lore_index(i, tmp16u)) >= 0; )
 	{
 		object_lore *n_ptr = &e_list[i];
 
@@ -2799,9 +3210,15 @@ static errr rd_savefile_new_aux(void)
 		rd_byte(&tmp8u);
 	}
 
+	if (i < -1)
+	{
+		note("Bad ego item lore!");
+		return (-1);
+	}
 	if (arg_fiddle) note("Loaded Ego Item Lore");
 
 	/* Read the extra stuff */
+	sf_section(SF_PLAYER);
 	if (rd_extra()) return (-1);
 	if (arg_fiddle) note("Loaded extra information");
 
@@ -2809,6 +3226,7 @@ static errr rd_savefile_new_aux(void)
 	if (!p_ptr->is_dead)
 	{
 		/* Load the Flavors */
+		sf_section(SF_LORE);
 		rd_u16b(&tmp16u);
 
 		/* Incompatible save files */
@@ -2818,8 +3236,14 @@ static errr rd_savefile_new_aux(void)
 			return (-1);
 		}
 
-		/* Read the flavor flags */
+		/* Start from blank knowledge */
 		for (i = 0; i < tmp16u; i++)
+		{
+			WIPE(&x_list[i], object_info);
+		}
+
+		/* Read the flavor flags */
+		for (i = -1; (i = rd_lore_index(i, tmp16u)) >= 0; )
 		{
 			object_info *n_ptr = &x_list[i];
 
@@ -2834,10 +3258,16 @@ static errr rd_savefile_new_aux(void)
 			rd_u32b(&n_ptr->not_flags4);
 		}
 
+		if (i < -1)
+		{
+			note("Bad flavor lore!");
+			return (-1);
+		}
 		if (arg_fiddle) note("Loaded Flavors");
 	}
 
 	/* Read random artifacts */
+	sf_section(SF_RANDARTS);
 	if (rd_randarts()) return (-1);
 	if (arg_fiddle) note("Loaded Random Artifacts");
 
@@ -2855,6 +3285,7 @@ static errr rd_savefile_new_aux(void)
 	cp_ptr = &c_info[p_ptr->pclass];
 
 	/* Read the inventory */
+	sf_section(SF_PLAYER);
 	if (rd_inventory())
 	{
 		note("Unable to read inventory");
@@ -2942,6 +3373,7 @@ static errr rd_savefile_new_aux(void)
 	if (!p_ptr->is_dead)
 	{
 		/* Read the stores */
+		sf_section(SF_STORES);
 		rd_u16b(&tmp16u);
 
 		for (i = 0; i < tmp16u; i++)
@@ -2955,6 +3387,7 @@ static errr rd_savefile_new_aux(void)
 	{
 		/* Dead players have no dungeon */
 		note("Restoring Dungeon...");
+		sf_section(SF_DUNGEON);
 		if (rd_dungeon())
 		{
 			note("Error reading dungeon data");
@@ -2988,30 +3421,36 @@ static errr rd_savefile_new_aux(void)
 
 #ifdef VERIFY_CHECKSUMS
 
-	/* Save the checksum */
-	n_v_check = v_check;
+	/* Old savefiles end with checksums (newer ones check each section) */
+	if (sf_encoded)
+	{
+		/* Save the checksum */
+		sf_check();
+		n_v_check = v_check;
 
-	/* Read the old checksum */
-	rd_u32b(&o_v_check);
+		/* Read the old checksum */
+		rd_u32b(&o_v_check);
 
-	/* Verify */
-	if (o_v_check != n_v_check)
-	{
-		note("Invalid checksum");
-		return (-1);
-	}
+		/* Verify */
+		if (o_v_check != n_v_check)
+		{
+			note("Invalid checksum");
+			return (-1);
+		}
 
-	/* Save the encoded checksum */
-	n_x_check = x_check;
+		/* Save the encoded checksum */
+		sf_check();
+		n_x_check = x_check;
 
-	/* Read the checksum */
-	rd_u32b(&o_x_check);
+		/* Read the checksum */
+		rd_u32b(&o_x_check);
 
-	/* Verify */
-	if (o_x_check != n_x_check)
-	{
-		note("Invalid encoded checksum");
-		return (-1);
+		/* Verify */
+		if (o_x_check != n_x_check)
+		{
+			note("Invalid encoded checksum");
+			return (-1);
+		}
 	}
 
 #endif
@@ -3028,17 +3467,21 @@ static errr rd_savefile_new_aux(void)
 
 
 /*
- * Actually read the savefile
+ * Read a savefile into memory, and find its sections
  */
-errr rd_savefile(void)
+static errr sf_open(cptr name)
 {
-	errr err;
+	FILE *fff;
+	long len;
+
+	u32b offset;
+	int i, num;
 
 	/* Grab permissions */
 	safe_setuid_grab();
 
 	/* The savefile is a binary file */
-	fff = my_fopen(savefile, "rb");
+	fff = my_fopen(name, "rb");
 
 	/* Drop permissions */
 	safe_setuid_drop();
@@ -3046,20 +3489,164 @@ errr rd_savefile(void)
 	/* Paranoia */
 	if (!fff) return (-1);
 
-	/* Call the sub-function */
-	err = rd_savefile_new_aux();
+	/* Find the size */
+	fseek(fff, 0L, SEEK_END);
+	len = ftell(fff);
+	fseek(fff, 0L, SEEK_SET);
 
-	/* Check for errors */
-	if (ferror(fff)) err = -1;
+	/* Paranoia */
+	if (len < 8)
+	{
+		my_fclose(fff);
+		return (-1);
+	}
+
+	/* Read it all */
+	sf_file = C_RNEW(len, byte);
+	sf_file_len = (u32b)len;
+
+	if (fread(sf_file, 1, len, fff) != (size_t)len)
+	{
+		my_fclose(fff);
+		FREE(sf_file);
+		return (-1);
+	}
 
 	/* Close the file */
 	my_fclose(fff);
 
+	/* Extract version */
+	sf_major = sf_file[0];
+	sf_minor = sf_file[1];
+	sf_patch = sf_file[2];
+	sf_extra = sf_file[3];
+
+	/* Start at the beginning */
+	sf_buf = sf_file;
+	sf_len = sf_file_len;
+	sf_pos = 0L;
+	sf_short = FALSE;
+
+	/* Forget the sections */
+	C_WIPE(sf_part_list, SF_MAX, sf_part);
+	sf_cur = -1;
+
+	/* Old savefiles are one encoded stream */
+	sf_encoded = older_than(0, 7, 0, 1);
+	if (sf_encoded) return (0);
+
+	/* Read the section table */
+	num = sf_u16b(sf_file + 4);
+	offset = 8L + num * 16L;
+
+	if (offset > sf_file_len) return (-1);
+
+	for (i = 0; i < num; i++)
+	{
+		const byte *s = sf_file + 8 + i * 16;
+		sf_part *s_ptr;
+
+		int n = sf_u16b(s);
+		u32b packed = sf_u32b(s + 4);
+
+		/* Broken table */
+		if (packed > sf_file_len - offset) return (-1);
+
+		/* Ignore unknown sections */
+		if (n < SF_MAX)
+		{
+			s_ptr = &sf_part_list[n];
+
+			s_ptr->codec = sf_u16b(s + 2);
+			s_ptr->offset = offset;
+			s_ptr->packed = packed;
+			s_ptr->size = sf_u32b(s + 8);
+			s_ptr->check = sf_u32b(s + 12);
+		}
+
+		offset += packed;
+	}
+
+	/* Nothing read yet */
+	sf_buf = NULL;
+	sf_len = 0L;
+
+	/* Success */
+	return (0);
+}
+
+
+/*
+ * Forget a savefile read by "sf_open()"
+ */
+static void sf_close(void)
+{
+	int n;
+
+	for (n = 0; n < SF_MAX; n++) FREE(sf_part_list[n].data);
+
+	FREE(sf_file);
+
+	sf_buf = NULL;
+	sf_len = 0L;
+}
+
+
+/*
+ * Actually read the savefile
+ */
+errr rd_savefile(void)
+{
+	errr err;
+
+	/* Read the file */
+	err = sf_open(savefile);
+
+	/* Call the sub-function */
+	if (!err) err = rd_savefile_new_aux();
+
+	/* Check for errors */
+	if (sf_short) err = -1;
+
+	/* Done with it */
+	sf_close();
+
 	/* Result */
 	return (err);
 }
 
 
+/*
+ * Describe the character in a savefile, without loading anything else.
+ * Only newer savefiles can be described.
+ */
+bool savefile_describe(cptr name, char *buf, int max)
+{
+	bool ok = FALSE;
+
+	/* Read the file */
+	if (sf_open(name))
+	{
+		sf_close();
+		return (FALSE);
+	}
+
+	/* Read the description from the header */
+	if (!sf_encoded)
+	{
+		sf_section(SF_HEADER);
+		rd_string(buf, max);
+
+		ok = !sf_short;
+	}
+
+	/* Done with it */
+	sf_close();
+
+	return (ok);
+}
+
+
 /*
  * Attempt to Load a "savefile"
  *
@@ -0,0 +1,370 @@
+/* File: main-nul.c */
+
+/*
+ * Copyright (c) 1997 Ben Harrison
+ *
+ * This software may be copied and distributed for educational, research,
+ * and not for profit purposes provided that this copyright and statement
+ * are included in all such copies.
+ */
+
+
+/*
+ * This file provides a "null" visual module, which displays nothing.
+ *
+ * It lets the game logic be timed without the cost of any real display,
+ * which is only any use together with the headless borg ("-b").  Nobody
+ * is around to answer questions, so every keypress is an escape, and the
+ * game refuses to use this module without the borg.
+ *
+ * Optionally ("-- -r<file>") everything the game would have drawn is
+ * recorded into a compact binary "display log".  The log can then be
+ * replayed ("-p<file>") through any other visual module, which times
+ * "Term_fresh()" and that module's drawing routines on their own.
+ *
+ * The log starts with the four bytes "NUL1" and the width and height of
+ * the window, followed by records, each starting with a byte code:
+ *
+ *	'T' x y n a c[n]	-- draw "n" chars in attr "a" ("Term_text()")
+ *	'P' x y n (a c ta tc)[n]	-- draw "n" grids ("Term_pict()")
+ *	'W' x y n		-- erase "n" grids ("Term_wipe()")
+ *	'C'			-- clear the window ("TERM_XTRA_CLEAR")
+ *	'F'			-- the end of a refresh ("TERM_XTRA_FRESH")
+ */
+
+
+#include "angband.h"
+
+
+#ifdef USE_NUL
+
+#include "main.h"
+
+
+/*
+ * The display log, if any
+ */
+static FILE *nul_log = NULL;
+
+
+/*
+ * The only "term"
+ */
+static term term_nul;
+
+
+
+/*** Function hooks needed by "Term" ***/
+
+
+/*
+ * Do a "special thing"
+ */
+static errr Term_xtra_nul(int n, int v)
+{
+	switch (n)
+	{
+		/* Wait for an event -- answer everything with an escape */
+		case TERM_XTRA_EVENT:
+		{
+			if (v) return (Term_keypress(ESCAPE));
+			return (0);
+		}
+
+		/* Clear the screen */
+		case TERM_XTRA_CLEAR:
+		{
+			if (nul_log) putc('C', nul_log);
+			return (0);
+		}
+
+		/* Flush the output */
+		case TERM_XTRA_FRESH:
+		{
+			if (nul_log) putc('F', nul_log);
+			return (0);
+		}
+	}
+
+	/* Pretend everything else worked */
+	return (0);
+}
+
+
+/*
+ * Erase some characters
+ */
+static errr Term_wipe_nul(int x, int y, int n)
+{
+	if (nul_log)
+	{
+		putc('W', nul_log);
+		putc(x, nul_log);
+		putc(y, nul_log);
+		putc(n, nul_log);
+	}
+
+	return (0);
+}
+
+
+/*
+ * Draw some text
+ */
+static errr Term_text_nul(int x, int y, int n, byte a, cptr cp)
+{
+	if (nul_log)
+	{
+		putc('T', nul_log);
+		putc(x, nul_log);
+		putc(y, nul_log);
+		putc(n, nul_log);
+		putc(a, nul_log);
+		(void)fwrite(cp, 1, n, nul_log);
+	}
+
+	return (0);
+}
+
+
+/*
+ * Draw some attr/char pairs
+ */
+static errr Term_pict_nul(int x, int y, int n, const byte *ap, const char *cp,
+	const byte *tap, const char *tcp)
+{
+	int i;
+
+	if (nul_log)
+	{
+		putc('P', nul_log);
+		putc(x, nul_log);
+		putc(y, nul_log);
+		putc(n, nul_log);
+
+		for (i = 0; i < n; i++)
+		{
+			putc(ap[i], nul_log);
+			putc(cp[i], nul_log);
+			putc(tap[i], nul_log);
+			putc(tcp[i], nul_log);
+		}
+	}
+
+	return (0);
+}
+
+
+/*
+ * Close the display log
+ */
+static void Term_nuke_nul(term *t)
+{
+	/* Unused parameter */
+	(void)t;
+
+	if (nul_log) my_fclose(nul_log);
+
+	nul_log = NULL;
+}
+
+
+
+/*** Replaying a display log ***/
+
+
+/*
+ * Replay a display log through the current "term", and report how long
+ * it took.  The contents of the log are read before the clock starts,
+ * so only "Term_fresh()" and the drawing routines of the term are timed.
+ */
+void replay_nul(cptr path)
+{
+	FILE *fff;
+
+	byte *buf;
+	long len, i;
+
+	int n, x, y, j, k;
+	u32b frames = 0L;
+
+	clock_t start;
+
+	/* Open the log */
+	fff = my_fopen(path, "rb");
+	if (!fff) quit_fmt("Cannot open display log '%s'", path);
+
+	/* Find the size */
+	fseek(fff, 0L, SEEK_END);
+	len = ftell(fff);
+	fseek(fff, 0L, SEEK_SET);
+
+	/* Read it all */
+	buf = C_ZNEW(len + 1, byte);
+	if ((len < 6) || (fread(buf, 1, len, fff) != (size_t)len) ||
+	    (memcmp(buf, "NUL1", 4) != 0))
+	{
+		quit_fmt("Bad display log '%s'", path);
+	}
+	my_fclose(fff);
+
+	/* The log must fit */
+	if ((buf[4] > Term->wid) || (buf[5] > Term->hgt))
+	{
+		quit_fmt("Display log '%s' needs a %dx%d window", path, buf[4], buf[5]);
+	}
+
+	/* Start from nothing */
+	Term_clear();
+	Term_fresh();
+
+	start = clock();
+
+	/* Replay the records */
+	for (i = 6; i < len; )
+	{
+		k = buf[i++];
+
+		/* Check the position of drawing records */
+		if ((k == 'T') || (k == 'P') || (k == 'W'))
+		{
+			if ((i + 3 > len) || (buf[i] + buf[i + 2] > Term->wid) ||
+			    (buf[i + 1] >= Term->hgt) ||
+			    (i + 3 + (k == 'T' ? buf[i + 2] + 1 : 0) +
+			     (k == 'P' ? buf[i + 2] * 4 : 0) > len))
+			{
+				quit_fmt("Bad record in display log '%s'", path);
+			}
+		}
+
+		switch (k)
+		{
+			case 'T':
+			{
+				x = buf[i++]; y = buf[i++]; n = buf[i++];
+
+				Term_queue_chars(x, y, n, buf[i], (cptr)&buf[i + 1]);
+
+				i += n + 1;
+				break;
+			}
+
+			case 'P':
+			{
+				x = buf[i++]; y = buf[i++]; n = buf[i++];
+
+				for (j = 0; j < n; j++, i += 4)
+				{
+					Term_queue_char(x + j, y, buf[i], (char)buf[i + 1],
+					                buf[i + 2], (char)buf[i + 3]);
+				}
+				break;
+			}
+
+			case 'W':
+			{
+				x = buf[i++]; y = buf[i++]; n = buf[i++];
+
+				(void)Term_erase(x, y, n);
+				break;
+			}
+
+			case 'C':
+			{
+				(void)Term_clear();
+				break;
+			}
+
+			case 'F':
+			{
+				(void)Term_fresh();
+				frames++;
+				break;
+			}
+
+			default:
+			{
+				quit_fmt("Bad record in display log '%s'", path);
+			}
+		}
+	}
+
+	start = clock() - start;
+
+	FREE(buf);
+
+	/* Shut down the display first */
+	if (quit_aux) (*quit_aux)(NULL);
+	quit_aux = NULL;
+
+	/* Report */
+	printf("Replayed %lu refreshes in %.3f seconds\n", (unsigned long)frames,
+	       (double)start / CLOCKS_PER_SEC);
+
+	quit(NULL);
+}
+
+
+
+/*** Initialization ***/
+
+
+const char help_nul[] = "No display, for the borg only (-b), subopts -r<file> to record a display log";
+
+
+/*
+ * Prepare the null display for use by the file "z-term.c"
+ */
+errr init_nul(int argc, char **argv)
+{
+	int i;
+
+	term *t = &term_nul;
+
+	/* Parse args */
+	for (i = 1; i < argc; i++)
+	{
+		if (prefix(argv[i], "-r"))
+		{
+			/* Open the display log */
+			nul_log = my_fopen(&argv[i][2], "wb");
+			if (!nul_log) quit_fmt("Cannot create display log '%s'", &argv[i][2]);
+		}
+
+		else
+			plog_fmt("Ignoring option: %s", argv[i]);
+	}
+
+	/* Initialize the term */
+	term_init(t, 80, 24, 256);
+
+	/* Use a "soft" cursor */
+	t->soft_cursor = TRUE;
+
+	/* Prepare the hooks */
+	t->nuke_hook = Term_nuke_nul;
+	t->xtra_hook = Term_xtra_nul;
+	t->wipe_hook = Term_wipe_nul;
+	t->text_hook = Term_text_nul;
+	t->pict_hook = Term_pict_nul;
+
+	/* Start the display log */
+	if (nul_log)
+	{
+		(void)fwrite("NUL1", 1, 4, nul_log);
+		putc(t->wid, nul_log);
+		putc(t->hgt, nul_log);
+	}
+
+	/* Save the term */
+	angband_term[0] = t;
+
+	/* Activate it */
+	Term_activate(t);
+
+	/* Success */
+	return (0);
+}
+
+
+#endif /* USE_NUL */
@@ -82,6 +82,10 @@ static const struct module modules[] =
 #ifdef USE_VCS
 	{ "vcs", help_vcs, init_vcs },
 #endif /* USE_VCS */
+
+#ifdef USE_NUL
+	{ "nul", help_nul, init_nul },
+#endif /* USE_NUL */
 };
 
 
@@ -305,6 +309,328 @@ static void change_path(cptr info)
 }
 
 
+#ifdef SET_UID
+
+/*
+ * List the characters in the savefile directory, without loading them
+ */
+static void list_savefiles(void)
+{
+	DIR *dir;
+	struct dirent *entry;
+
+	char path[1024];
+	char desc[160];
+
+	int n = 0;
+
+	/* Open the directory */
+	dir = opendir(ANGBAND_DIR_SAVE);
+	if (!dir) quit_fmt("Cannot read '%s'", ANGBAND_DIR_SAVE);
+
+	while ((entry = readdir(dir)) != NULL)
+	{
+		/* Skip hidden files, and files left over from saving */
+		if (entry->d_name[0] == '.') continue;
+		if (suffix(entry->d_name, ".old") || suffix(entry->d_name, ".new") ||
+		    suffix(entry->d_name, ".lok")) continue;
+
+		path_build(path, sizeof(path), ANGBAND_DIR_SAVE, entry->d_name);
+
+		/* Describe it (older savefiles cannot be described) */
+		if (!savefile_describe(path, desc, sizeof(desc))) continue;
+
+		printf("%-24s %s\n", entry->d_name, desc);
+		n++;
+	}
+
+	closedir(dir);
+
+	if (!n) puts("No savefiles to describe.");
+
+	quit(NULL);
+}
+
+#endif /* SET_UID */
+
+
+#ifdef ALLOW_BORG
+
+/*
+ * The term used by the headless borg.  It is never displayed.
+ */
+static term term_borg;
+
+
+/*
+ * Handle a "special request" for the headless borg.
+ *
+ * Nobody is around to answer any question the game asks, so every
+ * request for a keypress is answered with an escape.
+ */
+static errr Term_xtra_borg(int n, int v)
+{
+	/* Wait for an event */
+	if ((n == TERM_XTRA_EVENT) && v)
+	{
+		return (Term_keypress(ESCAPE));
+	}
+
+	/* Pretend everything else worked */
+	return (0);
+}
+
+
+/*
+ * The tables a game changes as it goes, as they were read in.  A game
+ * assigns the flavors, learns about the kinds and egos, makes artifacts,
+ * marks townsfolk and guardians and replaces dead guardians, and the next
+ * game must start from the tables as they were read in.
+ */
+static object_kind *borg_k_info;
+static flavor_type *borg_x_info;
+static ego_item_type *borg_e_info;
+static artifact_type *borg_a_info;
+static monster_race *borg_r_info;
+static town_type *borg_t_info;
+
+
+/*
+ * Let every entry of an allocation table be chosen again, as they were
+ * before any restriction was applied.
+ */
+static void borg_wipe_alloc(alloc_entry *table, int size)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+	{
+		table[i].prob2 = table[i].prob1;
+		table[i].prob3 = table[i].prob1;
+	}
+}
+
+
+/*
+ * Forget everything left over from the last borg game, so that each run
+ * plays exactly as it would in a fresh process.
+ */
+static void borg_wipe_game(void)
+{
+	/* Forget the level */
+	wipe_o_list();
+	wipe_m_list();
+	wipe_region_piece_list();
+	wipe_region_list();
+	level_wipe(cave_level);
+
+	/* Forget the rooms and the ecology */
+	C_WIPE(room_info, DUN_ROOMS, room_info_type);
+	C_WIPE(dun_room, MAX_ROOMS_ROW * MAX_ROOMS_COL, byte);
+	WIPE(&cave_ecology, ecology_type);
+	level_flag = 0;
+
+	/* Forget the last summoner */
+	summon_specific_params(0, 0, FALSE);
+	summon_strict = FALSE;
+
+#ifdef LEVEL_CACHE
+	/* Forget the levels we have been to */
+	level_cache_wipe();
+#endif /* LEVEL_CACHE */
+
+	/* Forget the stores */
+	wipe_store_list();
+
+	/* Forget the lore */
+	C_WIPE(l_list, z_info->r_max, monster_lore);
+	C_WIPE(e_list, z_info->e_max, object_lore);
+	C_WIPE(x_list, z_info->x_max, object_info);
+
+	/* Restore the tables the last game changed */
+	C_COPY(k_info, borg_k_info, z_info->k_max, object_kind);
+	C_COPY(x_info, borg_x_info, z_info->x_max, flavor_type);
+	C_COPY(e_info, borg_e_info, z_info->e_max, ego_item_type);
+	C_COPY(a_info, borg_a_info, z_info->a_max, artifact_type);
+	C_COPY(r_info, borg_r_info, z_info->r_max, monster_race);
+	C_COPY(t_info, borg_t_info, z_info->t_max, town_type);
+
+	/* Lift any restrictions on the objects, monsters and features */
+	borg_wipe_alloc(alloc_kind_table, alloc_kind_size);
+	borg_wipe_alloc(alloc_ego_table, alloc_ego_size);
+	borg_wipe_alloc(alloc_race_table, alloc_race_size);
+	borg_wipe_alloc(alloc_feat_table, alloc_feat_size);
+
+	/* Forget the caches, epochs, noise and scent */
+	wipe_cave_caches();
+}
+
+
+/*
+ * Let the "mindless borg" play throwaway characters without a display,
+ * and report how fast the game ran.
+ *
+ * Each run plays a new character for "turns" borg turns, travelling
+ * between "min_depth" and "max_depth", with the RNG seeded from "seed"
+ * plus the run number.  Runs are therefore repeatable.
+ */
+static void play_game_borg(u32b turns, int min_depth, int max_depth,
+	u32b seed, int runs)
+{
+	int run;
+
+	u32b total_turns = 0L, total_levels = 0L;
+
+	clock_t total_clock = 0, total_monsters = 0, total_generate = 0;
+
+	/* Prepare the invisible display, unless a module provides one */
+	if (!angband_term[0])
+	{
+		term_init(&term_borg, 80, 24, 256);
+		term_borg.xtra_hook = Term_xtra_borg;
+		term_borg.soft_cursor = TRUE;
+
+		/* Use it */
+		angband_term[0] = &term_borg;
+		Term_activate(&term_borg);
+	}
+
+	/* Play headless */
+	borg_headless = TRUE;
+
+	/* Initialize */
+	init_angband();
+
+	/* Never stop for messages, never save */
+	option_set(OPT_easy_more, TRUE);
+	option_set(OPT_autosave_backup, FALSE);
+
+	/* Remember the tables as they were read in */
+	borg_k_info = C_ZNEW(z_info->k_max, object_kind);
+	C_COPY(borg_k_info, k_info, z_info->k_max, object_kind);
+	borg_x_info = C_ZNEW(z_info->x_max, flavor_type);
+	C_COPY(borg_x_info, x_info, z_info->x_max, flavor_type);
+	borg_e_info = C_ZNEW(z_info->e_max, ego_item_type);
+	C_COPY(borg_e_info, e_info, z_info->e_max, ego_item_type);
+	borg_a_info = C_ZNEW(z_info->a_max, artifact_type);
+	C_COPY(borg_a_info, a_info, z_info->a_max, artifact_type);
+	borg_r_info = C_ZNEW(z_info->r_max, monster_race);
+	C_COPY(borg_r_info, r_info, z_info->r_max, monster_race);
+	borg_t_info = C_ZNEW(z_info->t_max, town_type);
+	C_COPY(borg_t_info, t_info, z_info->t_max, town_type);
+
+	/* Header */
+	printf("%4s %10s %10s %8s %10s %10s %10s\n", "run", "seed", "turns",
+	       "levels", "turns/s", "monster s", "generate s");
+
+	/* Play */
+	for (run = 0; run < runs; run++)
+	{
+		clock_t start;
+		double secs;
+
+		/* Reset statistics */
+		borg_count_turns = 0L;
+		borg_count_levels = 0L;
+		borg_clock_monsters = 0;
+		borg_clock_generate = 0;
+#ifdef LOS_CACHE
+		los_cache_hit = 0L;
+		los_cache_miss = 0L;
+#endif
+#ifdef PATH_CACHE
+		path_cache_hit = 0L;
+		path_cache_miss = 0L;
+#endif
+#ifdef VIEW_SHADOWCAST
+		borg_clock_view[0] = 0;
+		borg_clock_view[1] = 0;
+		borg_count_views = 0L;
+		borg_count_view_differ = 0L;
+#endif
+
+		/* Start from a clean slate */
+		borg_wipe_game();
+
+		/* Seed the "complex" RNG */
+		Rand_quick = FALSE;
+		Rand_state_init(seed + run);
+
+		/* Start the borg */
+		borg_setup(turns, 0, min_depth, max_depth);
+
+		/* Play the game */
+		start = clock();
+		play_game(TRUE);
+		start = clock() - start;
+
+		/* Report */
+		secs = (double)start / CLOCKS_PER_SEC;
+		printf("%4d %10lu %10lu %8lu %10.0f %10.3f %10.3f%s\n", run + 1,
+		       (unsigned long)(seed + run), (unsigned long)borg_count_turns,
+		       (unsigned long)borg_count_levels,
+		       secs > 0 ? borg_count_turns / secs : 0.0,
+		       (double)borg_clock_monsters / CLOCKS_PER_SEC,
+		       (double)borg_clock_generate / CLOCKS_PER_SEC,
+		       p_ptr->is_dead ? " (died)" : "");
+
+#ifdef LOS_CACHE
+		/* Report the line of sight cache */
+		printf("%4s %10s %10lu los cache hits, %lu misses\n", "", "",
+		       (unsigned long)los_cache_hit, (unsigned long)los_cache_miss);
+#endif
+
+#ifdef PATH_CACHE
+		/* Report the line of fire cache */
+		printf("%4s %10s %10lu path cache hits, %lu misses\n", "", "",
+		       (unsigned long)path_cache_hit, (unsigned long)path_cache_miss);
+#endif
+
+#ifdef VIEW_SHADOWCAST
+		/* Report the view engines */
+		printf("%4s %10s %10lu views: vinfo %.3f s, shadowcasting %.3f s, %lu grids differ\n",
+		       "", "", (unsigned long)borg_count_views,
+		       (double)borg_clock_view[0] / CLOCKS_PER_SEC,
+		       (double)borg_clock_view[1] / CLOCKS_PER_SEC,
+		       (unsigned long)borg_count_view_differ);
+#endif
+
+		/* Totals */
+		total_turns += borg_count_turns;
+		total_levels += borg_count_levels;
+		total_clock += start;
+		total_monsters += borg_clock_monsters;
+		total_generate += borg_clock_generate;
+	}
+
+	/* Summary */
+	if (runs > 1)
+	{
+		double secs = (double)total_clock / CLOCKS_PER_SEC;
+
+		printf("%4s %10s %10lu %8lu %10.0f %10.3f %10.3f\n", "all", "",
+		       (unsigned long)total_turns, (unsigned long)total_levels,
+		       secs > 0 ? total_turns / secs : 0.0,
+		       (double)total_monsters / CLOCKS_PER_SEC,
+		       (double)total_generate / CLOCKS_PER_SEC);
+	}
+
+	/* Free resources */
+	FREE(borg_k_info);
+	FREE(borg_x_info);
+	FREE(borg_e_info);
+	FREE(borg_a_info);
+	FREE(borg_r_info);
+	FREE(borg_t_info);
+	cleanup_angband();
+
+	/* Quit */
+	quit(NULL);
+}
+
+#endif /* ALLOW_BORG */
+
+
 /*
  * Simple "main" function for multiple platforms.
  *
@@ -322,10 +648,26 @@ int main(int argc, char *argv[])
 
 	int show_score = 0;
 
+#ifdef SET_UID
+	bool list_saves = FALSE;
+#endif /* SET_UID */
+
 	cptr mstr = NULL;
 
 	bool args = TRUE;
 
+#ifdef USE_NUL
+	/* Display log to replay */
+	cptr replay = NULL;
+#endif /* USE_NUL */
+
+#ifdef ALLOW_BORG
+	/* Headless borg parameters */
+	int borg_runs = 0;
+	unsigned long borg_turns = 10000L;
+	unsigned long borg_seed = (unsigned long)time(NULL);
+	int borg_depth[2] = { 1, MAX_DEPTH - 1 };
+#endif /* ALLOW_BORG */
 
 	/* Save the "program name" XXX XXX XXX */
 	argv0 = argv[0];
@@ -470,6 +812,15 @@ int main(int argc, char *argv[])
 				break;
 			}
 
+#ifdef VIEW_SHADOWCAST
+			case 'C':
+			case 'c':
+			{
+				view_shadowcast = TRUE;
+				break;
+			}
+#endif /* VIEW_SHADOWCAST */
+
 			case 'G':
 			case 'g':
 			{
@@ -500,6 +851,15 @@ int main(int argc, char *argv[])
 				continue;
 			}
 
+#ifdef SET_UID
+			case 'l':
+			case 'L':
+			{
+				list_saves = TRUE;
+				break;
+			}
+#endif /* SET_UID */
+
 			case 'u':
 			case 'U':
 			{
@@ -525,6 +885,34 @@ int main(int argc, char *argv[])
 				continue;
 			}
 
+#ifdef USE_NUL
+			case 'p':
+			case 'P':
+			{
+				if (!*arg) goto usage;
+
+				/* Get the display log */
+				replay = arg;
+				continue;
+			}
+#endif /* USE_NUL */
+
+#ifdef ALLOW_BORG
+			case 'b':
+			case 'B':
+			{
+				/* Default to a single run */
+				borg_runs = 1;
+
+				/* Parse "turns,min,max,seed,runs" (all optional) */
+				if (*arg) (void)sscanf(arg, "%lu,%d,%d,%lu,%d", &borg_turns,
+					&borg_depth[0], &borg_depth[1], &borg_seed, &borg_runs);
+
+				if (borg_runs < 1) goto usage;
+				continue;
+			}
+#endif /* ALLOW_BORG */
+
 			case '-':
 			{
 				argv[i] = argv[0];
@@ -544,11 +932,23 @@ int main(int argc, char *argv[])
 				puts("  -w       Request wizard mode");
 				puts("  -v       Request sound mode");
 				puts("  -g       Request graphics mode");
+#ifdef VIEW_SHADOWCAST
+				puts("  -c       Use shadowcasting for the field of view");
+#endif /* VIEW_SHADOWCAST */
 				puts("  -o       Request original keyset (default)");
 				puts("  -r       Request rogue-like keyset");
 				puts("  -s<num>  Show <num> high scores (default: 10)");
 				puts("  -u<who>  Use your <who> savefile");
+#ifdef SET_UID
+				puts("  -l       List the characters in the savefiles");
+#endif /* SET_UID */
 				puts("  -d<def>  Define a 'lib' dir sub-path");
+#ifdef USE_NUL
+				puts("  -p<file> Replay a display log recorded by '-mnul'");
+#endif /* USE_NUL */
+#ifdef ALLOW_BORG
+				puts("  -b<t,min,max,seed,runs>  Benchmark the borg without a display");
+#endif /* ALLOW_BORG */
 				puts("  -m<sys>  use Module <sys>, where <sys> can be:");
 
 				/* Print the name and help for each available module */
@@ -573,6 +973,11 @@ int main(int argc, char *argv[])
 	}
 
 
+#ifdef SET_UID
+	/* List the savefiles and quit */
+	if (list_saves) list_savefiles();
+#endif /* SET_UID */
+
 	/* Process the player name */
 	process_player_name(TRUE);
 
@@ -580,9 +985,33 @@ int main(int argc, char *argv[])
 	/* Install "quit" hook */
 	quit_aux = quit_hook;
 
+#ifdef ALLOW_BORG
+	/* Let the borg play without a display */
+	if (borg_runs)
+	{
+#ifdef USE_NUL
+		/* Let the null display record what the borg would have drawn */
+		if (mstr && streq(mstr, "nul")) (void)init_nul(argc, argv);
+#endif /* USE_NUL */
+
+		play_game_borg((u32b)borg_turns, borg_depth[0], borg_depth[1],
+			(u32b)borg_seed, borg_runs);
+	}
+#endif /* ALLOW_BORG */
+
+#ifdef USE_NUL
+	/* The null display answers every keypress with an escape, so only the borg can play on it */
+	if (mstr && streq(mstr, "nul")) quit("The 'nul' display module needs the borg ('-b')");
+#endif /* USE_NUL */
+
 	/* Try the modules in the order specified by modules[] */
 	for (i = 0; i < (int)N_ELEMENTS(modules); i++)
 	{
+#ifdef USE_NUL
+		/* Never pick the null display for a player */
+		if (modules[i].init == init_nul) continue;
+#endif /* USE_NUL */
+
 		/* User requested a specific module? */
 		if (!mstr || (streq(mstr, modules[i].name)))
 		{
@@ -598,6 +1027,11 @@ int main(int argc, char *argv[])
 	/* Make sure we have a display! */
 	if (!done) quit("Unable to prepare any 'display module'!");
 
+#ifdef USE_NUL
+	/* Time a display log */
+	if (replay) replay_nul(replay);
+#endif /* USE_NUL */
+
 	/* Catch nasty signals */
 	signals_init();
 
@@ -978,7 +978,8 @@ int attack_desc(char *buf, int target, int method, int effect, int damage, u16b
 bool mon_check_hit(int m_idx, int power, int level, int who, bool ranged)
 {
 	monster_type *m_ptr = &m_list[m_idx];
-	monster_type *n_ptr = &m_list[who];
+	/* Hack -- traps and the like attack as the blank monster */
+	monster_type *n_ptr = &m_list[who > 0 ? who : 0];
 	monster_race *r_ptr = &r_info[n_ptr->r_idx];
 
 	int k, ac;
@@ -200,7 +200,7 @@ void find_range(int m_idx)
 	{
 		/* Hack and back against another monster */
 		if ((m_ptr->mflag & (MFLAG_ALLY | MFLAG_IGNORE)) &&
-				(cave_m_idx[m_ptr->ty][m_ptr->tx]) &&
+				(cave_m_idx[m_ptr->ty][m_ptr->tx] > 0) &&
 				(distance(m_ptr->ty, m_ptr->tx, m_ptr->fy, m_ptr->fx) == 1))
 		{
 			monster_type *n_ptr = &m_list[cave_m_idx[m_ptr->ty][m_ptr->tx]];
@@ -271,7 +271,10 @@ int get_scent(int y, int x)
 	if (!scent) return (-1);
 
 	/* Get age of scent */
-	age = scent - scent_when;
+	age = scent_when - scent;
+
+	/* Scent has faded, or is from before the clock was started again */
+	if ((age < 0) || (age > SMELL_FADE)) return (-1);
 
 	/* Return the age of the scent */
 	return (age);
@@ -1158,7 +1161,17 @@ static void init_ranged_attack(monster_race *r_ptr)
 		method_type *method_ptr = &method_info[method];
 
 		/* Skip 'tricky' attacks */
-		if (((method_ptr->flags2 & (PR2_RANGED)) == 0) && !(r_ptr->flags3 & (RF3_HUGE))) continue;
+		if (((method_ptr->flags2 & (PR2_RANGED)) == 0) && !(r_ptr->flags3 & (RF3_HUGE)))
+		{
+			/* Forget the last monster's blow, so it is never in range */
+			spell_info_RF4[ap_cnt][COL_SPELL_MANA_COST] = 0;
+			spell_info_RF4[ap_cnt][COL_SPELL_DAM_MULT] = 0;
+			spell_info_RF4[ap_cnt][COL_SPELL_DAM_DIV] = 0;
+			spell_info_RF4[ap_cnt][COL_SPELL_DAM_VAR] = 0;
+			spell_info_RF4[ap_cnt][COL_SPELL_BEST_RANGE] = 0;
+
+			continue;
+		}
 
 		/* Should have already initialised blows */
 		/* r_ptr->flags4 |= (RF4_BLOW_1 << ap_cnt); */
@@ -4091,19 +4104,28 @@ bool tell_allies_info(int y, int x, cptr saying, intptr_t u, int v, int w, bool
 		void tell_ally_hook(monster_type *n_ptr, intptr_t u, int v, int w))
 {
 	int i, language, d;
+	int by, bx, by1, bx1, by2, bx2;
+	int next_i = 0;
 	bool vocal = FALSE;
 
 	/* Get the language */
 	language = monster_language(m_list[cave_m_idx[y][x]].r_idx);
 
-	/* Scan all other monsters */
-	for (i = 1; i < z_info->m_max; i++)
+	/* Get the blocks within sight */
+	by1 = MAX(y - MAX_SIGHT, 0) >> MON_BLOCK_SHIFT;
+	bx1 = MAX(x - MAX_SIGHT, 0) >> MON_BLOCK_SHIFT;
+	by2 = MIN(y + MAX_SIGHT, DUNGEON_HGT - 1) >> MON_BLOCK_SHIFT;
+	bx2 = MIN(x + MAX_SIGHT, DUNGEON_WID - 1) >> MON_BLOCK_SHIFT;
+
+	/* Scan all other monsters in those blocks */
+	for (by = by1; by <= by2; by++) for (bx = bx1; bx <= bx2; bx++)
+	for (i = mon_block[by * MON_BLOCK_WID + bx]; i; i = next_i)
 	{
 		/* Access the monster */
 		monster_type *n_ptr = &m_list[i];
 
-		/* Ignore dead monsters */
-		if (!n_ptr->r_idx) continue;
+		/* Get the next monster */
+		next_i = mon_block_next[i];
 
 		/* Ignore itself */
 		if (i == cave_m_idx[y][x]) continue;
@@ -4729,7 +4751,14 @@ static bool make_move(int m_idx, int *ty, int *tx, bool fear, bool *bash)
 			nx = ox + ddx[dir];
 
 			/* Check Bounds */
-			if (!in_bounds(ny, nx)) continue;
+			if (!in_bounds(ny, nx))
+			{
+				/* Never move off the map */
+				moves_data[i].move_chance = 0;
+				moves_data[i].move_bash = FALSE;
+
+				continue;
+			}
 
 			/* Store this grid's movement data. */
 			moves_data[i].move_chance =
@@ -6365,7 +6394,7 @@ static void process_monster(int m_idx)
 		    (!m_ptr->ty) && (!m_ptr->tx))
 		{
 			/* Monster cannot smell the character */
-			if (!cave_when[m_ptr->fy][m_ptr->fx]) m_ptr->mflag &= ~(MFLAG_ACTV);
+			if (get_scent(m_ptr->fy, m_ptr->fx) == -1) m_ptr->mflag &= ~(MFLAG_ACTV);
 			else if (!monster_can_smell(m_ptr))   m_ptr->mflag &= ~(MFLAG_ACTV);
 		}
 	}
@@ -6383,7 +6412,7 @@ static void process_monster(int m_idx)
 		else if (m_ptr->mflag & (MFLAG_TOWN | MFLAG_ALLY | MFLAG_IGNORE)) m_ptr->mflag |= (MFLAG_ACTV);
 
 		/* The monster is catching too much of a whiff to ignore */
-		else if (cave_when[m_ptr->fy][m_ptr->fx])
+		else if (get_scent(m_ptr->fy, m_ptr->fx) != -1)
 		{
 			if (monster_can_smell(m_ptr))
 			{
@@ -8820,20 +8849,28 @@ static void recover_monster(int m_idx, bool regen)
 /*
  * Process all living monsters, once per game turn.
  *
- * Scan through the list of all living monsters, (backwards, so we can
- * excise any "freshly dead" monsters).
+ * Scan through the monsters yet to move this game turn, from the highest
+ * index down, which is the order monsters have always moved in.  A monster
+ * placed in a lower slot part way through still gets its move.
  *
  * Every ten game turns, allow monsters to recover from temporary con-
  * ditions.  Every 100 game turns, regenerate monsters.  Give energy to
  * each monster, and allow fully energized monsters to take their turns.
  *
+ * Monsters are unflagged as they are processed, so later calls in the
+ * same game turn only see the monsters still waiting, and a word of flags
+ * with no monsters waiting is skipped at once.  The energy each waiting
+ * monster had when last checked is kept beside the flags; energy
+ * only goes down outside this function, so a monster whose copy is below
+ * the minimum can be skipped without looking at the monster at all.
+ *
  * This function and its children are responsible for at least a third of
  * the processor time in normal situations.  If the character is resting,
  * this may rise substantially.
  */
 void process_monsters(byte minimum_energy)
 {
-	int i;
+	int i, w, b;
 	monster_type *m_ptr;
 
 	/* Only process some things every so often */
@@ -8850,40 +8887,52 @@ void process_monsters(byte minimum_energy)
 	}
 
 	/* Process the monsters (backwards) */
-	for (i = m_max - 1; i >= 1; i--)
+	for (w = (m_max - 1) >> 5; w >= 0; w--)
 	{
-		/* Player is dead or leaving the current level */
-		if (p_ptr->leaving) break;
+		/* No monsters waiting here */
+		if (!mon_wait[w]) continue;
 
-		/* Access the monster */
-		m_ptr = &m_list[i];
+		for (b = 31; b >= 0; b--)
+		{
+			/* Player is dead or leaving the current level */
+			if (p_ptr->leaving) return;
 
-		/* Ignore dead monsters */
-		if (!m_ptr->r_idx) continue;
+			/* Not waiting (or died behind us) */
+			if (!(mon_wait[w] & (1UL << b))) continue;
 
-		/* Ignore monsters that have already been handled */
-		if (m_ptr->mflag & (MFLAG_MOVE)) continue;
+			/* Access the monster */
+			i = (w << 5) + b;
+			m_ptr = &m_list[i];
 
-		/* Leave monsters without enough energy for later */
-		if (m_ptr->energy < minimum_energy) continue;
+			/* Leave monsters without enough energy for later */
+			if (mon_wait_energy[i] < minimum_energy) continue;
 
-		/* Prevent reprocessing */
-		m_ptr->mflag |= (MFLAG_MOVE);
+			/* Leave monsters that have lost energy for later */
+			if (m_ptr->energy < minimum_energy)
+			{
+				mon_wait_energy[i] = m_ptr->energy;
+				continue;
+			}
 
-		/* Handle temporary monster attributes every ten game turns */
-		if (recover) recover_monster(i, regen);
+			/* Prevent reprocessing */
+			m_ptr->mflag |= (MFLAG_MOVE);
+			mon_wait_remove(i);
 
-		/* Give the monsters some energy */
-		m_ptr->energy += extract_energy[m_ptr->mspeed];
+			/* Handle temporary monster attributes every ten game turns */
+			if (recover) recover_monster(i, regen);
 
-		/* End the turn of monsters without enough energy to move */
-		if (m_ptr->energy < 100) continue;
+			/* Give the monsters some energy */
+			m_ptr->energy += extract_energy[m_ptr->mspeed];
 
-		/* Use up some energy */
-		m_ptr->energy -= 100;
+			/* End the turn of monsters without enough energy to move */
+			if (m_ptr->energy < 100) continue;
 
-		/* Let the monster take its turn */
-		process_monster(i);
+			/* Use up some energy */
+			m_ptr->energy -= 100;
+
+			/* Let the monster take its turn */
+			process_monster(i);
+		}
 	}
 }
 
@@ -8895,17 +8944,22 @@ void process_monsters(byte minimum_energy)
  */
 void reset_monsters(void)
 {
-	int i;
+	int i, n;
 	monster_type *m_ptr;
 
-	/* Process the monsters (backwards) */
-	for (i = m_max - 1; i >= 1; i--)
+	/* Process the live monsters */
+	for (n = 0; n < mon_live_n; n++)
 	{
 		/* Access the monster */
+		i = mon_live[n];
 		m_ptr = &m_list[i];
 
 		/* Monster is ready to go again */
 		m_ptr->mflag &= ~(MFLAG_MOVE);
+
+		/* Wait for its turn */
+		mon_wait[i >> 5] |= (1UL << (i & 31));
+		mon_wait_energy[i] = m_ptr->energy;
 	}
 }
 
@@ -246,6 +246,142 @@ void reapply_torch_lit(int y, int x, int r)
 }
 
 
+/*
+ * The live monster list and the list of monsters yet to move are both
+ * "sparse sets": a dense array of monster indexes, plus an array giving
+ * the slot of each monster in the dense array.  A monster is in the set
+ * if its slot is in range and the dense array points back at it, so the
+ * slot arrays never need clearing, and adding or removing a monster
+ * takes constant time.
+ *
+ * Removing a monster moves the last monster in the set into its slot,
+ * so the order of either set has no meaning.
+ */
+static bool mon_live_has(int m_idx)
+{
+	int n = mon_live_slot[m_idx];
+
+	return ((n < mon_live_n) && (mon_live[n] == m_idx));
+}
+
+
+/*
+ * Add a monster to the live monster list
+ */
+static void mon_live_add(int m_idx)
+{
+	/* Paranoia */
+	if (mon_live_has(m_idx)) return;
+
+	mon_live_slot[m_idx] = mon_live_n;
+	mon_live[mon_live_n++] = m_idx;
+}
+
+
+/*
+ * Remove a monster from the live monster list
+ */
+static void mon_live_remove(int m_idx)
+{
+	int n, last;
+
+	/* Paranoia */
+	if (!mon_live_has(m_idx)) return;
+
+	/* Move the last monster into the hole */
+	n = mon_live_slot[m_idx];
+	last = mon_live[--mon_live_n];
+
+	mon_live[n] = last;
+	mon_live_slot[last] = n;
+}
+
+
+/*
+ * Is a monster yet to move this game turn?
+ */
+static bool mon_wait_has(int m_idx)
+{
+	return ((mon_wait[m_idx >> 5] & (1UL << (m_idx & 31))) != 0);
+}
+
+
+/*
+ * Add a monster to the monsters yet to move this game turn
+ */
+static void mon_wait_add(int m_idx)
+{
+	mon_wait[m_idx >> 5] |= (1UL << (m_idx & 31));
+	mon_wait_energy[m_idx] = m_list[m_idx].energy;
+}
+
+
+/*
+ * Remove a monster from the monsters yet to move this game turn
+ */
+void mon_wait_remove(int m_idx)
+{
+	mon_wait[m_idx >> 5] &= ~(1UL << (m_idx & 31));
+}
+
+
+/*
+ * Add a monster to the block containing its grid.
+ *
+ * Each block holds a doubly linked list of the monsters in it, threaded
+ * through "mon_block_next" and "mon_block_prev", with zero marking the
+ * ends of the list.
+ */
+static void mon_block_add(int m_idx)
+{
+	monster_type *m_ptr = &m_list[m_idx];
+
+	int n = MON_BLOCK(m_ptr->fy, m_ptr->fx);
+
+	/* Link at the head */
+	mon_block_of[m_idx] = n;
+	mon_block_prev[m_idx] = 0;
+	mon_block_next[m_idx] = mon_block[n];
+
+	if (mon_block[n]) mon_block_prev[mon_block[n]] = m_idx;
+	mon_block[n] = m_idx;
+}
+
+
+/*
+ * Remove a monster from its block
+ */
+static void mon_block_remove(int m_idx)
+{
+	int prev = mon_block_prev[m_idx];
+	int next = mon_block_next[m_idx];
+
+	/* Unlink */
+	if (prev) mon_block_next[prev] = next;
+	else mon_block[mon_block_of[m_idx]] = next;
+
+	if (next) mon_block_prev[next] = prev;
+}
+
+
+/*
+ * Move a monster to the block containing its (new) grid, if needed
+ */
+static void mon_block_move(int m_idx)
+{
+	monster_type *m_ptr = &m_list[m_idx];
+
+	/* Paranoia -- monster died on the way */
+	if (!m_ptr->r_idx) return;
+
+	/* Still in the same block */
+	if (mon_block_of[m_idx] == MON_BLOCK(m_ptr->fy, m_ptr->fx)) return;
+
+	mon_block_remove(m_idx);
+	mon_block_add(m_idx);
+}
+
+
 /*
  * Delete a monster by index.
  *
@@ -283,6 +419,9 @@ void delete_monster_idx(int i)
 	/* Monster is gone */
 	cave_m_idx[y][x] = 0;
 
+	/* Leave the block */
+	mon_block_remove(i);
+
 	/* Delete objects */
 	for (this_o_idx = m_ptr->hold_o_idx; this_o_idx; this_o_idx = next_o_idx)
 	{
@@ -314,6 +453,10 @@ void delete_monster_idx(int i)
 	/* Count monsters */
 	m_cnt--;
 
+	/* No longer alive */
+	mon_live_remove(i);
+	mon_wait_remove(i);
+
 
 	/* Visual update */
 	lite_spot(y, x);
@@ -402,6 +545,37 @@ static void compact_monsters_aux(int i1, int i2)
 	/* Hack -- Update the health bar */
 	if (p_ptr->health_who == i1) p_ptr->health_who = i2;
 
+	/* Repair the live monster list */
+	if (mon_live_has(i1))
+	{
+		mon_live[mon_live_slot[i1]] = i2;
+		mon_live_slot[i2] = mon_live_slot[i1];
+	}
+
+	/* Repair the monsters yet to move */
+	if (mon_wait_has(i1))
+	{
+		mon_wait_remove(i1);
+		mon_wait[i2 >> 5] |= (1UL << (i2 & 31));
+		mon_wait_energy[i2] = mon_wait_energy[i1];
+	}
+
+	/* Repair the block list */
+	if (m_ptr->r_idx)
+	{
+		int prev = mon_block_prev[i1];
+		int next = mon_block_next[i1];
+
+		if (prev) mon_block_next[prev] = i2;
+		else mon_block[mon_block_of[i1]] = i2;
+
+		if (next) mon_block_prev[next] = i2;
+
+		mon_block_prev[i2] = prev;
+		mon_block_next[i2] = next;
+		mon_block_of[i2] = mon_block_of[i1];
+	}
+
 	/* Hack -- move monster */
 	COPY(&m_list[i2], &m_list[i1], monster_type);
 
@@ -543,6 +717,17 @@ void wipe_m_list(void)
 	/* Reset "m_cnt" */
 	m_cnt = 0;
 
+	/* No live monsters */
+	mon_live_n = 0;
+	C_WIPE(mon_wait, MON_WAIT_WORDS, u32b);
+
+	/* Nothing remembered about how the monsters were seen */
+	C_WIPE(mon_vis_key, z_info->m_max, u32b);
+	C_WIPE(mon_vis_race, z_info->m_max, s16b);
+
+	/* Empty the blocks */
+	C_WIPE(mon_block, MON_BLOCK_HGT * MON_BLOCK_WID, s16b);
+
 	/* Hack -- reset "reproducer" count */
 	num_repro = 0;
 
@@ -554,6 +739,63 @@ void wipe_m_list(void)
 }
 
 
+#ifdef LEVEL_CACHE
+
+/*
+ * Rebuild the monster lists and racial counters for a level that has
+ * been copied back into "m_list[]" from the level cache.
+ *
+ * Uniques which have been killed, or which have turned up again on
+ * this level by some other route, are removed.
+ */
+void relink_m_list(void)
+{
+	int i;
+
+	/* No live monsters yet */
+	mon_live_n = 0;
+	C_WIPE(mon_wait, MON_WAIT_WORDS, u32b);
+
+	/* Empty the blocks */
+	C_WIPE(mon_block, MON_BLOCK_HGT * MON_BLOCK_WID, s16b);
+
+	/* Hack -- reset "reproducer" count */
+	num_repro = 0;
+
+	/* No monsters counted yet */
+	for (i = 0; i < z_info->r_max; i++) r_info[i].cur_num = 0;
+
+	/* Relink the monsters */
+	for (i = 1; i < m_max; i++)
+	{
+		monster_type *m_ptr = &m_list[i];
+
+		monster_race *r_ptr = &r_info[m_ptr->r_idx];
+
+		/* Skip dead monsters */
+		if (!m_ptr->r_idx) continue;
+
+		/* Count racial occurances */
+		r_ptr->cur_num++;
+
+		/* Hack -- count the number of "reproducers" */
+		if (r_ptr->flags2 & (RF2_MULTIPLY)) num_repro++;
+
+		/* Now alive */
+		mon_live_add(i);
+		mon_block_add(i);
+
+		/* Allow it to move this game turn */
+		if (!(m_ptr->mflag & (MFLAG_MOVE))) mon_wait_add(i);
+
+		/* Too many of this race - delete it */
+		if (r_ptr->cur_num > r_ptr->max_num) delete_monster_idx(i);
+	}
+}
+
+#endif /* LEVEL_CACHE */
+
+
 /*
  * Get and return the index of a "free" monster.
  *
@@ -3070,23 +3312,138 @@ void update_mon(int m_idx, bool full)
 
 
 /*
- * This function simply updates all the (non-dead) monsters (see above).
+ * What a visibility pass saw of a monster, packed into 32 bits.
+ *
+ * This holds everything about the monster that "update_mon()" looks at:
+ * its grid, its distance, the view flags of its grid and its own flags,
+ * and also what "update_mon()" decided last time (the "result" bits).
+ */
+#define MON_VIS_DIST_SHIFT	15
+#define MON_VIS_VIEW		0x00800000L	/* Grid is in view */
+#define MON_VIS_SEEN		0x01000000L	/* Grid is seen */
+#define MON_VIS_MARK		0x02000000L	/* Monster is detected */
+#define MON_VIS_HIDE		0x04000000L	/* Monster is hiding */
+#define MON_VIS_INVIS		0x08000000L	/* Monster is invisible */
+#define MON_VIS_EASY		0x10000000L	/* Result -- easily visible */
+#define MON_VIS_ML		0x20000000L	/* Result -- visible */
+
+#define MON_VIS_RESULT		(MON_VIS_EASY | MON_VIS_ML)
+
+
+/*
+ * Get the result bits of a monster key.
+ */
+static u32b update_mon_result(const monster_type *m_ptr)
+{
+	return ((((m_ptr->mflag & (MFLAG_VIEW)) != 0) ? MON_VIS_EASY : 0L) |
+		((m_ptr->ml) ? MON_VIS_ML : 0L));
+}
+
+
+/*
+ * The senses of the player at the last visibility pass
+ */
+static u32b mon_vis_sense[2];
+
+
+/*
+ * This function updates all the (non-dead) monsters (see above).
+ *
+ * When the player moves, most monsters are neither seen nor sensed and
+ * have not moved since the last pass, so we do not want to call
+ * "update_mon()" for all of them.  Instead, one loop over the live
+ * monsters works out the key of each (see above), and we update only
+ * the monsters whose key has changed since the last pass.
+ *
+ * The result of "update_mon()" depends only on the key, the race and
+ * the index of the monster, and the senses of the player, so skipping
+ * a monster whose key has not changed never changes anything.  If the
+ * senses of the player have changed, we update every monster.
  */
 void update_monsters(bool full)
 {
-	int i;
+	int i, n = mon_live_n;
 
-	/* Update each (live) monster */
-	for (i = 1; i < m_max; i++)
+	int py = p_ptr->py;
+	int px = p_ptr->px;
+
+	u32b *key = mon_vis_new;
+
+	byte *fast_play_info = &play_info[0][0];
+
+	u32b sense[2];
+
+	bool all;
+
+	/* Get the senses of the player */
+	sense[0] = p_ptr->cur_flags3 & (TR3_SENSE_MASK);
+	sense[1] = ((u32b)p_ptr->see_infra & 0xFFFFL) |
+		((p_ptr->timed[TMD_BLIND]) ? 0x10000L : 0L) |
+		((u32b)p_ptr->pstyle << 24);
+
+	/* Senses have changed */
+	all = ((sense[0] != mon_vis_sense[0]) || (sense[1] != mon_vis_sense[1]));
+
+	/* Work out the key of each live monster */
+	for (i = 0; i < n; i++)
 	{
-		monster_type *m_ptr = &m_list[i];
+		monster_type *m_ptr = &m_list[mon_live[i]];
 
-		/* Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
+		int fy = m_ptr->fy;
+		int fx = m_ptr->fx;
+		int g = GRID(fy, fx);
+		int d;
 
-		/* Update the monster */
-		update_mon(i, full);
+		byte pinfo = fast_play_info[g];
+
+		/* Compute distance (see "update_mon()") */
+		if (full)
+		{
+			int dy = (py > fy) ? (py - fy) : (fy - py);
+			int dx = (px > fx) ? (px - fx) : (fx - px);
+
+			d = (dy > dx) ? (dy + (dx>>1)) : (dx + (dy>>1));
+
+			if (d > 255) d = 255;
+
+			m_ptr->cdis = d;
+		}
+		else
+		{
+			d = m_ptr->cdis;
+		}
+
+		key[i] = (u32b)g | ((u32b)d << MON_VIS_DIST_SHIFT) |
+			(((pinfo & (PLAY_VIEW)) != 0) ? MON_VIS_VIEW : 0L) |
+			(((pinfo & (PLAY_SEEN)) != 0) ? MON_VIS_SEEN : 0L) |
+			(((m_ptr->mflag & (MFLAG_MARK)) != 0) ? MON_VIS_MARK : 0L) |
+			(((m_ptr->mflag & (MFLAG_HIDE)) != 0) ? MON_VIS_HIDE : 0L) |
+			((m_ptr->tim_invis) ? MON_VIS_INVIS : 0L) |
+			update_mon_result(m_ptr);
+	}
+
+	/* Update the monsters which have changed */
+	for (i = 0; (i < n) && (i < mon_live_n); i++)
+	{
+		int m_idx = mon_live[i];
+
+		monster_type *m_ptr = &m_list[m_idx];
+
+		/* Nothing has changed */
+		if (!(all) && (key[i] == mon_vis_key[m_idx]) &&
+			(m_ptr->r_idx == mon_vis_race[m_idx])) continue;
+
+		/* Update the monster (distance is already done) */
+		update_mon(m_idx, FALSE);
+
+		/* Remember the key, with the new result */
+		mon_vis_key[m_idx] = (key[i] & ~(MON_VIS_RESULT)) | update_mon_result(m_ptr);
+		mon_vis_race[m_idx] = m_ptr->r_idx;
 	}
+
+	/* Remember the senses */
+	mon_vis_sense[0] = sense[0];
+	mon_vis_sense[1] = sense[1];
 }
 
 
@@ -3303,6 +3660,7 @@ void monster_swap(int y1, int x1, int y2, int x2)
 		/* Move monster */
 		m_ptr->fy = y2;
 		m_ptr->fx = x2;
+		mon_block_move(m1);
 
 		/* Some monsters radiate damage when moving */
 		if (r_ptr->flags2 & (RF2_HAS_AURA))
@@ -3350,6 +3708,7 @@ void monster_swap(int y1, int x1, int y2, int x2)
 		/* Move monster */
 		m_ptr->fy = y1;
 		m_ptr->fx = x1;
+		mon_block_move(m2);
 
 		/* Some monsters radiate lite when moving */
 		if (r_ptr->flags2 & (RF2_HAS_LITE | RF2_NEED_LITE))
@@ -3700,6 +4059,10 @@ int place_monster_here(int y, int x, int r_idx)
 	/* Race */
 	r_ptr = &r_info[r_idx];
 
+	/* Quickly reject grids that nothing but wall passers can enter */
+	if (!cave_pass_bold(PASS_MOVE, y, x) &&
+		((r_ptr->flags2 & (RF2_PASS_WALL | RF2_MUST_SWIM | RF2_MUST_FLY)) == 0)) return (MM_FAIL);
+
 	/* Monster resists terrain damage? */
 	resist = mon_resist_feat(cave_feat[y][x],r_idx);
 
@@ -4021,6 +4384,13 @@ s16b monster_place(int y, int x, monster_type *n_ptr)
 		/* Clear flags */
 		m_ptr->mflag &= ~(MFLAG_OVER | MFLAG_HIDE);
 
+		/* Now alive */
+		mon_live_add(m_idx);
+		mon_block_add(m_idx);
+
+		/* Allow it to move this game turn */
+		if (!(m_ptr->mflag & (MFLAG_MOVE))) mon_wait_add(m_idx);
+
 		/* Use the simple RNG to preserve seed from before save */
 		/* TODO: Perhaps eliminate the RNG roll altogether here */
 		/* Rand_quick = TRUE; */
@@ -4470,8 +4840,7 @@ static bool place_monster_one(int y, int x, int r_idx, bool slp, u32b flg)
 
 	dungeon_zone *zone=&t_info[0].zone[0];
 
-	/* Get the feature */
-	feature_type *f_ptr = &f_info[cave_feat[y][x]];
+	feature_type *f_ptr;
 
 	int i;
 
@@ -4481,6 +4850,9 @@ static bool place_monster_one(int y, int x, int r_idx, bool slp, u32b flg)
 	/* Paranoia */
 	if (!in_bounds(y, x)) return (FALSE);
 
+	/* Get the feature */
+	f_ptr = &f_info[cave_feat[y][x]];
+
 	/* Require empty space */
 	if (!cave_empty_bold(y, x))
 	{
@@ -7647,8 +8019,9 @@ bool place_guardian(int y0, int x0, int y1, int x1)
 			y = y0 + rand_int(y1);
 			x = x0 + rand_int(x1);
 
-			/* Place the questor */
-			if (place_monster_aux(y, x, guard, FALSE, TRUE, 0L)) break;
+			/* Place the questor, if the location is on the level */
+			if (in_bounds_fully(y, x) &&
+			    place_monster_aux(y, x, guard, FALSE, TRUE, 0L)) break;
 
 			if (count < MAX_RANGE)
 			{
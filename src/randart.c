@@ -378,7 +378,7 @@ static errr init_names(void)
 	}
 
 	/* Free the old names */
-	FREE(a_name);
+	if (!info_in_image(a_name)) FREE(a_name);
 
 	for (i = 1; i < z_info->a_max; i++)
 	{
@@ -84,28 +84,292 @@
  * Some "local" parameters, used to help write savefiles
  */
 
-static FILE	*fff;		/* Current save "file" */
+static byte	*sf_buf = NULL;	/* Section being built */
+static u32b	sf_size = 0L;	/* Size of the buffer */
+static u32b	sf_len = 0L;	/* Bytes in the buffer */
 
-static byte	xor_byte;	/* Simple encryption */
+static int	sf_cur = SF_HEADER;	/* Current section */
 
-static u32b	v_stamp = 0L;	/* A simple "checksum" on the actual values */
-static u32b	x_stamp = 0L;	/* A simple "checksum" on the encoded bytes */
+static byte	*sf_data[SF_MAX];	/* All the sections */
+static u32b	sf_data_size[SF_MAX];
+static u32b	sf_data_len[SF_MAX];
 
 
 
 /*
- * These functions place information into a savefile a byte at a time
+ * The savefile is built up in memory, a section at a time, and then
+ * packed and written out in one go.
+ *
+ * These functions place information into the current section a byte at
+ * a time.
  */
 
 static void sf_put(byte v)
 {
-	/* Encode the value, write a character */
-	xor_byte ^= v;
-	(void)putc((int)xor_byte, fff);
+	/* Grow the buffer */
+	if (sf_len >= sf_size)
+	{
+		if (sf_size)
+		{
+			sf_size *= 2;
+			sf_buf = mem_realloc(sf_buf, sf_size);
+		}
+		else
+		{
+			sf_size = 65536L;
+			sf_buf = C_RNEW(sf_size, byte);
+		}
+	}
+
+	/* Store the value */
+	sf_buf[sf_len++] = v;
+}
+
+
+/*
+ * Switch to writing section "n".  Sections can be written in several
+ * pieces, as long as they are read back in the same order.
+ */
+static void sf_section(int n)
+{
+	/* Put away the current section */
+	sf_data[sf_cur] = sf_buf;
+	sf_data_size[sf_cur] = sf_size;
+	sf_data_len[sf_cur] = sf_len;
+
+	/* Take out the new one */
+	sf_cur = n;
+	sf_buf = sf_data[n];
+	sf_size = sf_data_size[n];
+	sf_len = sf_data_len[n];
+}
+
+
+/*
+ * Store a two byte value
+ */
+static void sf_store_u16b(byte *s, u16b v)
+{
+	s[0] = (byte)(v);
+	s[1] = (byte)(v >> 8);
+}
+
+
+/*
+ * Store a four byte value
+ */
+static void sf_store_u32b(byte *s, u32b v)
+{
+	s[0] = (byte)(v);
+	s[1] = (byte)(v >> 8);
+	s[2] = (byte)(v >> 16);
+	s[3] = (byte)(v >> 24);
+}
+
+
+/*
+ * Checksum a section (32 bit FNV-1a)
+ */
+static u32b sf_checksum(const byte *s, u32b len)
+{
+	u32b h = 2166136261UL;
+
+	while (len--) h = ((h ^ *s++) * 16777619UL) & 0xFFFFFFFFL;
+
+	return (h);
+}
+
+
+/*
+ * Sections are compressed with a simple LZ77 codec.
+ *
+ * The packed data is a series of sequences, each of which is a token
+ * byte, some literal bytes, and then a match with some earlier bytes.
+ * The top four bits of the token give the number of literals, and the
+ * bottom four bits the length of the match, less four.  A value of 15
+ * means that more bytes follow, to be added on until one is not 255.
+ * The literals are followed by the two byte distance back to the match.
+ * The last sequence has no match, and just stops at the end of the data.
+ *
+ * Matches are found by hashing the next four bytes, and remembering the
+ * last place each hash was seen.
+ */
+#define SF_HASH_BITS	12
+#define SF_MIN_MATCH	4
+#define SF_MAX_DIST	65535L
+
+
+/*
+ * The most space that "len" bytes might take up once packed
+ */
+#define SF_PACK_BOUND(len) \
+	((len) + (len) / 255 + 16)
+
+
+/*
+ * Write a length of 15 or more, after the 15 in the token
+ */
+static byte *sf_pack_len(byte *op, u32b n)
+{
+	for (n -= 15; n >= 255; n -= 255) *op++ = 255;
+
+	*op++ = (byte)n;
+
+	return (op);
+}
+
+
+/*
+ * Get the four bytes at "s"
+ */
+static u32b sf_peek(const byte *s)
+{
+	return ((u32b)s[0] | ((u32b)s[1] << 8) | ((u32b)s[2] << 16) |
+	        ((u32b)s[3] << 24));
+}
+
+
+/*
+ * Compress "len" bytes from "src" into "dst", which must hold at least
+ * "SF_PACK_BOUND(len)" bytes.  Return the packed length.
+ */
+static u32b sf_pack(const byte *src, u32b len, byte *dst)
+{
+	u32b table[1 << SF_HASH_BITS];
+
+	const byte *ip = src;
+	const byte *anchor = src;
+	const byte *end = src + len;
+	const byte *ref;
+
+	byte *op = dst;
+	byte *token;
+
+	u32b seq, h, lit, mlen;
+
+	/* Nothing seen yet */
+	C_WIPE(table, 1 << SF_HASH_BITS, u32b);
+
+	/* Look for matches */
+	while ((len >= SF_MIN_MATCH) && (ip <= end - SF_MIN_MATCH))
+	{
+		seq = sf_peek(ip);
+
+		/* Hash the next four bytes */
+		h = ((seq * 2654435761UL) & 0xFFFFFFFFL) >> (32 - SF_HASH_BITS);
+
+		/* Remember this place */
+		ref = src + table[h];
+		table[h] = (u32b)(ip - src);
+
+		/* No match */
+		if ((ref >= ip) || (ip - ref > SF_MAX_DIST) || (sf_peek(ref) != seq))
+		{
+			ip++;
+			continue;
+		}
+
+		/* Extend the match */
+		for (mlen = SF_MIN_MATCH; (ip + mlen < end) && (ref[mlen] == ip[mlen]); mlen++) ;
+
+		/* Write the token */
+		lit = (u32b)(ip - anchor);
+		token = op++;
+		*token = (byte)(((lit < 15) ? lit : 15) << 4);
+		if (lit >= 15) op = sf_pack_len(op, lit);
+
+		/* Copy the literals */
+		C_COPY(op, anchor, lit, byte);
+		op += lit;
+
+		/* Write the match */
+		sf_store_u16b(op, (u16b)(ip - ref));
+		op += 2;
+
+		*token |= (byte)((mlen - SF_MIN_MATCH < 15) ? mlen - SF_MIN_MATCH : 15);
+		if (mlen - SF_MIN_MATCH >= 15) op = sf_pack_len(op, mlen - SF_MIN_MATCH);
+
+		/* Skip the match */
+		ip += mlen;
+		anchor = ip;
+	}
+
+	/* The last literals */
+	lit = (u32b)(end - anchor);
+	token = op++;
+	*token = (byte)(((lit < 15) ? lit : 15) << 4);
+	if (lit >= 15) op = sf_pack_len(op, lit);
+
+	C_COPY(op, anchor, lit, byte);
+	op += lit;
+
+	return ((u32b)(op - dst));
+}
+
+
+/*
+ * Pack the sections into a savefile image.
+ *
+ * The image starts with the four version bytes, and the number of
+ * sections.  Then for each section there is its number, how it is
+ * stored (0 for plain, 1 for packed), the stored and the real sizes,
+ * and a checksum of the real data.  The stored sections follow.
+ */
+static byte *sf_image(byte **data, const u32b *len, u32b *size)
+{
+	byte *buf, *s, *op;
+
+	u32b total;
+	u32b packed;
+
+	int n;
+
+	/* Make room for everything */
+	total = 8 + SF_MAX * 16;
+	for (n = 0; n < SF_MAX; n++) total += SF_PACK_BOUND(len[n]);
+
+	buf = C_RNEW(total, byte);
+
+	/* Version */
+	buf[0] = VERSION_MAJOR;
+	buf[1] = VERSION_MINOR;
+	buf[2] = VERSION_PATCH;
+	buf[3] = VERSION_EXTRA;
 
-	/* Maintain the checksum info */
-	v_stamp += v;
-	x_stamp += xor_byte;
+	/* Number of sections */
+	sf_store_u16b(buf + 4, SF_MAX);
+	sf_store_u16b(buf + 6, 0);
+
+	/* The sections */
+	op = buf + 8 + SF_MAX * 16;
+
+	for (n = 0; n < SF_MAX; n++)
+	{
+		s = buf + 8 + n * 16;
+
+		/* Try to pack it */
+		packed = (len[n] ? sf_pack(data[n], len[n], op) : 0L);
+
+		/* Store it plainly if that did not help */
+		if (len[n] && (packed >= len[n]))
+		{
+			packed = len[n];
+			C_COPY(op, data[n], packed, byte);
+		}
+
+		sf_store_u16b(s, (u16b)n);
+		sf_store_u16b(s + 2, (u16b)(packed < len[n]));
+		sf_store_u32b(s + 4, packed);
+		sf_store_u32b(s + 8, len[n]);
+		sf_store_u32b(s + 12, sf_checksum(data[n], len[n]));
+
+		op += packed;
+	}
+
+	/* Size of the image */
+	*size = (u32b)(op - buf);
+
+	return (buf);
 }
 
 static void wr_byte(byte v)
@@ -338,6 +602,18 @@ static void wr_monster(const monster_type *m_ptr)
 }
 
 
+/*
+ * A blank monster memory, to compare the lore against
+ */
+static const monster_lore lore_blank;
+
+/*
+ * Blank object knowledge, likewise
+ */
+static const object_info info_blank;
+static const object_lore e_lore_blank;
+
+
 /*
  * Write a "lore" record
  */
@@ -501,13 +777,17 @@ static errr wr_randomizer(void)
 	/* Zero */
 	wr_u16b(0);
 
-	/* Place */
-	wr_u16b(Rand_place);
+	/* Place (unused) */
+	wr_u16b(0);
 
-	/* State */
-	for (i = 0; i < RAND_DEG; i++)
+	/*
+	 * State -- the 64-bit words go in 32-bit halves at the start of
+	 * the old 63 entry table, which is padded with zeros.
+	 */
+	for (i = 0; i < 63; i++)
 	{
-		wr_u32b(Rand_state[i]);
+		if (i >= RAND_DEG * 2) wr_u32b(0L);
+		else wr_u32b((u32b)((Rand_state[i / 2] >> ((i % 2) * 32)) & 0xFFFFFFFFL));
 	}
 
 	/* Success */
@@ -1143,6 +1423,42 @@ static void wr_dungeon(void)
 
 
 
+/*
+ * Write a short description of the character, so that the savefile
+ * can be described without loading it.
+ */
+static void wr_description(void)
+{
+	char buf[160];
+
+	/* Dead */
+	if (p_ptr->is_dead)
+	{
+		strnfmt(buf, sizeof(buf), "%s, dead level %d %s %s",
+		        op_ptr->full_name, p_ptr->lev, p_name + rp_ptr->name,
+		        c_name + cp_ptr->name);
+	}
+
+	/* In the dungeon */
+	else if (p_ptr->depth)
+	{
+		strnfmt(buf, sizeof(buf), "%s, level %d %s %s, %d ft",
+		        op_ptr->full_name, p_ptr->lev, p_name + rp_ptr->name,
+		        c_name + cp_ptr->name, p_ptr->depth * 50);
+	}
+
+	/* In town */
+	else
+	{
+		strnfmt(buf, sizeof(buf), "%s, level %d %s %s, in town",
+		        op_ptr->full_name, p_ptr->lev, p_name + rp_ptr->name,
+		        c_name + cp_ptr->name);
+	}
+
+	wr_string(buf);
+}
+
+
 /*
  * Actually write a save-file
  */
@@ -1172,20 +1488,15 @@ static bool wr_savefile_new(void)
 
 	/*** Actually write the file ***/
 
-	/* Dump the file header */
-	xor_byte = 0;
-	wr_byte(VERSION_MAJOR);
-	xor_byte = 0;
-	wr_byte(VERSION_MINOR);
-	xor_byte = 0;
-	wr_byte(VERSION_PATCH);
-	xor_byte = 0;
-	wr_byte(VERSION_EXTRA);
+	/* Start with empty sections */
+	for (i = 0; i < SF_MAX; i++) sf_data_len[i] = 0L;
+	sf_len = 0L;
 
+	/* The file header (the version is written by "sf_image()") */
+	sf_section(SF_HEADER);
 
-	/* Reset the checksum */
-	v_stamp = 0L;
-	x_stamp = 0L;
+	/* Describe the character */
+	wr_description();
 
 
 	/* Operating system */
@@ -1215,6 +1526,9 @@ static bool wr_savefile_new(void)
 	wr_options();
 
 
+	/* The messages */
+	sf_section(SF_MESSAGES);
+
 	/* Dump the number of "messages" */
 	tmp16s = message_num();
 	if (tmp16s > 800) tmp16s = 800;
@@ -1241,16 +1555,50 @@ static bool wr_savefile_new(void)
 	wr_s16b(tips_start);
 
 
+	/* The lore */
+	sf_section(SF_LORE);
+
+	/*
+	 * The lore and knowledge below is written as a sparse list.  Only
+	 * the entries which differ from a blank baseline are dumped, each
+	 * one preceded by its index, and the list ends with 0xFFFF.
+	 */
+
 	/* Dump the monster lore */
 	tmp16u = z_info->r_max;
 	wr_u16b(tmp16u);
-	for (i = 0; i < tmp16u; i++) wr_lore(i);
+	for (i = 0; i < tmp16u; i++)
+	{
+		monster_race *r_ptr = &r_info[i];
+
+		/* Skip unknown races at their usual limit */
+		if ((r_ptr->max_num == ((r_ptr->flags1 & (RF1_UNIQUE)) ? 1 : 100)) &&
+		    !memcmp(&l_list[i], &lore_blank, sizeof(monster_lore))) continue;
+
+		wr_u16b(i);
+		wr_lore(i);
+	}
+	wr_u16b(0xFFFF);
 
 
 	/* Dump the object memory */
 	tmp16u = z_info->k_max;
 	wr_u16b(tmp16u);
-	for (i = 0; i < tmp16u; i++) wr_xtra(i);
+	for (i = 0; i < tmp16u; i++)
+	{
+		object_kind *k_ptr = &k_info[i];
+
+		/* Skip unknown kinds */
+		if (!k_ptr->aware && !k_ptr->guess && !k_ptr->ever_used &&
+		    !k_ptr->used) continue;
+
+		wr_u16b(i);
+		wr_xtra(i);
+	}
+	wr_u16b(0xFFFF);
+
+	/* The player */
+	sf_section(SF_PLAYER);
 
 	/* Hack -- Dump the quests */
 	tmp16u = MAX_Q_IDX;
@@ -1269,9 +1617,11 @@ static bool wr_savefile_new(void)
 	}
 
 	/* Random artifact seed */
+	sf_section(SF_RANDARTS);
 	wr_u32b(seed_randart);
 
 	/* Hack -- Dump the artifact lore */
+	sf_section(SF_LORE);
 	tmp16u = z_info->a_max;
 	wr_u16b(tmp16u);
 
@@ -1280,6 +1630,12 @@ static bool wr_savefile_new(void)
 		artifact_type *a_ptr = &a_info[i];
 		object_info *n_ptr = &a_list[i];
 
+		/* Skip unknown artifacts */
+		if (!a_ptr->cur_num && !a_ptr->activated &&
+		    !memcmp(n_ptr, &info_blank, sizeof(object_info))) continue;
+
+		wr_u16b(i);
+
 		wr_byte(a_ptr->cur_num);
 		wr_byte(0);
 		wr_byte(0);
@@ -1302,6 +1658,7 @@ static bool wr_savefile_new(void)
 		wr_byte(0);
 		wr_byte(0);
 	}
+	wr_u16b(0xFFFF);
 
 	/* Hack -- Dump the ego items lore */
 	tmp16u = z_info->e_max;
@@ -1311,6 +1668,12 @@ static bool wr_savefile_new(void)
         {
                 object_lore *n_ptr = &e_list[i];
 
+                /* Skip unknown ego items */
+                if (!e_info[i].aware &&
+                    !memcmp(n_ptr, &e_lore_blank, sizeof(object_lore))) continue;
+
+                wr_u16b(i);
+
                 wr_u32b(n_ptr->can_flags1);
                 wr_u32b(n_ptr->can_flags2);
                 wr_u32b(n_ptr->can_flags3);
@@ -1332,13 +1695,17 @@ static bool wr_savefile_new(void)
                	wr_byte(0);
                 wr_byte(0);
         }
+	wr_u16b(0xFFFF);
 
 	/* Write the "extra" information */
+	sf_section(SF_PLAYER);
 	wr_extra();
 
 	/* Don't bother saving the learnt flavor flags if dead */
 	if (!p_ptr->is_dead)
 	{
+		sf_section(SF_LORE);
+
 		/* Hack -- Dump the flavors */
 		tmp16u =z_info->x_max;
 		wr_u16b(tmp16u);
@@ -1347,6 +1714,11 @@ static bool wr_savefile_new(void)
 		{
                 	object_info *n_ptr = &x_list[i];
 
+			/* Skip unknown flavors */
+			if (!memcmp(n_ptr, &info_blank, sizeof(object_info))) continue;
+
+			wr_u16b(i);
+
                 	wr_u32b(n_ptr->can_flags1);
                 	wr_u32b(n_ptr->can_flags2);
                 	wr_u32b(n_ptr->can_flags3);
@@ -1357,11 +1729,14 @@ static bool wr_savefile_new(void)
                 	wr_u32b(n_ptr->not_flags3);
                 	wr_u32b(n_ptr->not_flags4);
 		}
+		wr_u16b(0xFFFF);
         }
 
+	sf_section(SF_RANDARTS);
 	wr_randarts();
 
 	/* Write the inventory */
+	sf_section(SF_PLAYER);
 	for (i = 0; i < INVEN_TOTAL; i++)
 	{
 		object_type *o_ptr = &inventory[i];
@@ -1421,6 +1796,7 @@ static bool wr_savefile_new(void)
 	if (!p_ptr->is_dead)
 	{
 		/* Note the stores */
+		sf_section(SF_STORES);
 		tmp16u = total_store_count;
 		wr_u16b(tmp16u);
 
@@ -1428,6 +1804,7 @@ static bool wr_savefile_new(void)
 		for (i = 0; i < tmp16u; i++) wr_store(store[i]);
 
 		/* Dump the dungeon */
+		sf_section(SF_DUNGEON);
 		wr_dungeon();
 
 		/* Dump the ghost */
@@ -1435,27 +1812,19 @@ static bool wr_savefile_new(void)
 	}
 
 
-	/* Write the "value check-sum" */
-	wr_u32b(v_stamp);
-
-	/* Write the "encoded checksum" */
-	wr_u32b(x_stamp);
+	/* Put the last section away */
+	sf_section(SF_HEADER);
 
 
-	/* Error in save */
-	if (ferror(fff) || (fflush(fff) == EOF)) return FALSE;
-
 	/* Successful save */
 	return TRUE;
 }
 
 
 /*
- * Medium level player saver
- *
- * XXX XXX XXX Angband 2.8.0 will use "fd" instead of "fff" if possible
+ * Write a finished savefile image into a new file
  */
-static bool save_player_aux(cptr name)
+static bool sf_write(cptr name, const byte *buf, u32b len)
 {
 	bool ok = FALSE;
 
@@ -1464,15 +1833,15 @@ static bool save_player_aux(cptr name)
 	int mode = 0644;
 
 
-	/* No file yet */
-	fff = NULL;
-
 	/* File type is "SAVE" */
 	FILE_TYPE(FILE_TYPE_SAVE);
 
 	/* Grab permissions */
 	safe_setuid_grab();
 
+	/* Remove any old one */
+	fd_kill(name);
+
 	/* Create the savefile */
 	fd = fd_make(name, mode);
 
@@ -1482,27 +1851,16 @@ static bool save_player_aux(cptr name)
 	/* File is okay */
 	if (fd >= 0)
 	{
-		/* Close the "fd" */
-		fd_close(fd);
-
-		/* Grab permissions */
-		safe_setuid_grab();
-
-		/* Open the savefile */
-		fff = my_fopen(name, "wb");
-
-		/* Drop permissions */
-		safe_setuid_drop();
+		/* Write it out */
+		if (!fd_write(fd, (cptr)buf, len)) ok = TRUE;
 
-		/* Successful open */
-		if (fff)
-		{
-			/* Write the savefile */
-			if (wr_savefile_new()) ok = TRUE;
+#ifdef HAVE_FSYNC
+		/* Make sure it is on the disk before it replaces the old one */
+		if (ok && fsync(fd)) ok = FALSE;
+#endif /* HAVE_FSYNC */
 
-			/* Attempt to close it */
-			if (my_fclose(fff)) ok = FALSE;
-		}
+		/* Attempt to close it */
+		if (fd_close(fd)) ok = FALSE;
 
 		/* Grab permissions */
 		safe_setuid_grab();
@@ -1514,6 +1872,56 @@ static bool save_player_aux(cptr name)
 		safe_setuid_drop();
 	}
 
+	/* Result */
+	return (ok);
+}
+
+
+/*
+ * Replace the savefile "target" with the new savefile "safe", keeping
+ * the old one as "temp" until the new one is in place.
+ */
+static void sf_replace(cptr safe, cptr target, cptr temp)
+{
+	/* Grab permissions */
+	safe_setuid_grab();
+
+	/* Remove it */
+	fd_kill(temp);
+
+	/* Preserve old savefile */
+	fd_move(target, temp);
+
+	/* Activate new savefile */
+	fd_move(safe, target);
+
+	/* Remove preserved savefile */
+	fd_kill(temp);
+
+	/* Drop permissions */
+	safe_setuid_drop();
+}
+
+
+/*
+ * Medium level player saver
+ */
+static bool save_player_aux(cptr name)
+{
+	byte *buf;
+	u32b size;
+
+	bool ok;
+
+	/* Build the savefile */
+	if (!wr_savefile_new()) return (FALSE);
+
+	/* Pack it */
+	buf = sf_image(sf_data, sf_data_len, &size);
+
+	/* Write it out */
+	ok = sf_write(name, buf, size);
+	FREE(buf);
 
 	/* Failure */
 	if (!ok) return (FALSE);
@@ -1525,6 +1933,288 @@ static bool save_player_aux(cptr name)
 	return (TRUE);
 }
 
+
+
+#ifdef ASYNC_AUTOSAVE
+
+/*
+ * Autosaves are written in the background.
+ *
+ * The sections of the savefile are built in memory as usual, and then
+ * handed to a thread of their own to pack, write out and move into place,
+ * while play goes on.  Only one image can wait to be written: a
+ * newer autosave replaces one that has not been started yet.
+ *
+ * The game may have to wait for the thread from a signal handler, where
+ * locking is not safe.  So signals are blocked on the main thread while
+ * it holds the lock (and the thread inherits that when it is started),
+ * and "save_outstanding" can be read without the lock.
+ */
+typedef struct save_job save_job;
+
+struct save_job
+{
+	byte *data[SF_MAX];	/* Savefile sections */
+	u32b len[SF_MAX];
+
+	char safe[1024];	/* File names for "sf_replace()" */
+	char target[1024];
+	char temp[1024];
+};
+
+static pthread_mutex_t save_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t save_cond = PTHREAD_COND_INITIALIZER;
+
+static bool save_started = FALSE;	/* The thread is running */
+static bool save_busy = FALSE;		/* A savefile is being written */
+static bool save_failed = FALSE;	/* The last one could not be written */
+
+static save_job *save_pending = NULL;	/* Waiting to be written */
+
+static volatile sig_atomic_t save_outstanding = 0;	/* Not written yet */
+
+
+/*
+ * Take the lock from the main thread, with signals blocked
+ */
+static void save_lock(sigset_t *old_mask)
+{
+	sigset_t mask;
+
+	(void)sigfillset(&mask);
+	(void)pthread_sigmask(SIG_BLOCK, &mask, old_mask);
+
+	(void)pthread_mutex_lock(&save_mutex);
+}
+
+
+/*
+ * Release the lock taken by "save_lock()"
+ */
+static void save_unlock(sigset_t *old_mask)
+{
+	(void)pthread_mutex_unlock(&save_mutex);
+
+	(void)pthread_sigmask(SIG_SETMASK, old_mask, NULL);
+}
+
+
+/*
+ * Free a savefile job
+ */
+static void save_job_free(save_job *job)
+{
+	int n;
+
+	for (n = 0; n < SF_MAX; n++) FREE(job->data[n]);
+
+	FREE(job);
+}
+
+
+/*
+ * Pack and write out a savefile, and free it
+ */
+static bool save_job_run(save_job *job)
+{
+	byte *buf;
+	u32b size;
+
+	bool ok;
+
+	/* Pack it */
+	buf = sf_image(job->data, job->len, &size);
+
+	/* Write it out and move it into place */
+	ok = sf_write(job->safe, buf, size);
+	if (ok) sf_replace(job->safe, job->target, job->temp);
+
+	/* Done with it */
+	FREE(buf);
+	save_job_free(job);
+
+	return (ok);
+}
+
+
+/*
+ * The thread that writes autosaves
+ */
+static void *save_thread(void *arg)
+{
+	save_job *job;
+
+	bool ok;
+
+	/* Unused parameter */
+	(void)arg;
+
+	(void)pthread_mutex_lock(&save_mutex);
+
+	while (TRUE)
+	{
+		/* Wait for something to do */
+		while (!save_pending) (void)pthread_cond_wait(&save_cond, &save_mutex);
+
+		/* Take it */
+		job = save_pending;
+		save_pending = NULL;
+		save_busy = TRUE;
+
+		/* Write it without holding the lock */
+		(void)pthread_mutex_unlock(&save_mutex);
+		ok = save_job_run(job);
+		(void)pthread_mutex_lock(&save_mutex);
+
+		/* Done */
+		if (!ok) save_failed = TRUE;
+		save_busy = FALSE;
+		if (!save_pending) save_outstanding = 0;
+		(void)pthread_cond_broadcast(&save_cond);
+	}
+
+	/* Never reached */
+	return (NULL);
+}
+
+
+/*
+ * Start writing the savefile in the background.
+ *
+ * Failures are only found out later, so we report whether the previous
+ * autosave could be written.
+ */
+static bool save_player_async(cptr safe, cptr target, cptr temp)
+{
+	save_job *job;
+
+	pthread_t thread;
+
+	sigset_t old_mask;
+
+	bool ok;
+
+	int n;
+
+	/* Build the savefile */
+	if (!wr_savefile_new()) return (FALSE);
+
+	/* Take the sections */
+	job = ZNEW(save_job);
+
+	for (n = 0; n < SF_MAX; n++)
+	{
+		job->data[n] = sf_data[n];
+		job->len[n] = sf_data_len[n];
+
+		/* The next save needs new buffers */
+		sf_data[n] = NULL;
+		sf_data_size[n] = 0L;
+		sf_data_len[n] = 0L;
+	}
+
+	sf_buf = NULL;
+	sf_size = 0L;
+	sf_len = 0L;
+
+	my_strcpy(job->safe, safe, sizeof(job->safe));
+	my_strcpy(job->target, target, sizeof(job->target));
+	my_strcpy(job->temp, temp, sizeof(job->temp));
+
+	save_lock(&old_mask);
+
+	/* Start the thread (with all signals blocked) */
+	if (!save_started)
+	{
+		if (pthread_create(&thread, NULL, save_thread, NULL) ||
+		    pthread_detach(thread))
+		{
+			save_unlock(&old_mask);
+
+			/* Hack -- write it here instead */
+			if (!save_job_run(job)) return (FALSE);
+
+			character_saved = TRUE;
+			return (TRUE);
+		}
+
+		save_started = TRUE;
+	}
+
+	/* Only the newest image is worth writing */
+	if (save_pending) save_job_free(save_pending);
+
+	/* Queue it */
+	save_pending = job;
+	save_outstanding = 1;
+	(void)pthread_cond_broadcast(&save_cond);
+
+	/* Check the last one */
+	ok = !save_failed;
+	save_failed = FALSE;
+
+	save_unlock(&old_mask);
+
+	/* Successful save (so far) */
+	character_saved = TRUE;
+
+	return (ok);
+}
+
+#endif /* ASYNC_AUTOSAVE */
+
+
+/*
+ * Wait until any autosave being written in the background is finished
+ */
+void save_wait(void)
+{
+#ifdef ASYNC_AUTOSAVE
+
+	sigset_t old_mask;
+
+	if (!save_started) return;
+
+	save_lock(&old_mask);
+
+	while (save_pending || save_busy)
+	{
+		(void)pthread_cond_wait(&save_cond, &save_mutex);
+	}
+
+	save_unlock(&old_mask);
+
+#endif /* ASYNC_AUTOSAVE */
+}
+
+
+/*
+ * Give any autosave being written in the background a chance to finish
+ * before the game exits.
+ *
+ * Unlike "save_wait()", this takes no locks, so it may be used from a
+ * signal handler.  We give up after about ten seconds.
+ */
+void save_finish(void)
+{
+#ifdef ASYNC_AUTOSAVE
+
+	struct timespec ts;
+
+	int i;
+
+	ts.tv_sec = 0;
+	ts.tv_nsec = 10000000L;
+
+	for (i = 0; save_outstanding && (i < 1000); i++)
+	{
+		(void)nanosleep(&ts, NULL);
+	}
+
+#endif /* ASYNC_AUTOSAVE */
+}
+
+
 /*
  * Attempt to save the player in a savefile
  */
@@ -1536,6 +2226,8 @@ bool save_player(void)
 
 /*
  * Attempt to save the player in a savefile
+ *
+ * Autosaves ("bkp") are written in the background, if possible.
  */
 bool save_player_bkp(bool bkp)
 {
@@ -1545,6 +2237,8 @@ bool save_player_bkp(bool bkp)
 
 	char target_savefile[1024];
 
+	char temp[1024];
+
 #ifdef SET_UID
 
 # ifdef SECURE
@@ -1578,48 +2272,65 @@ bool save_player_bkp(bool bkp)
 	my_strcat(safe, "n", sizeof(new));
 #endif /* VM */
 
-	/* Grab permissions */
-	safe_setuid_grab();
-
-	/* Remove it */
-	fd_kill(safe);
+	/* Old savefile */
+	my_strcpy(temp, savefile, sizeof(temp));
+	my_strcat(temp, ".old", sizeof(temp));
 
-	/* Drop permissions */
-	safe_setuid_drop();
+#ifdef VM
+	/* Hack -- support "flat directory" usage on VM/ESA */
+	my_strcpy(temp, savefile, sizeof(temp));
+	my_strcat(temp, "o", sizeof(temp));
+#endif /* VM */
 
-	/* Attempt to save the player */
-	if (save_player_aux(safe))
+	/*
+	 * Hack -- a panic save may interrupt the autosave being moved into
+	 * place, so it must not use the same files on the way
+	 */
+	if (p_ptr->panic_save && !bkp)
 	{
-		char temp[1024];
+		my_strcpy(safe, savefile, sizeof(safe));
+		my_strcat(safe, ".pan", sizeof(safe));
 
-		/* Old savefile */
 		my_strcpy(temp, savefile, sizeof(temp));
-		my_strcat(temp, ".old", sizeof(temp));
+		my_strcat(temp, ".pan.old", sizeof(temp));
+	}
 
-#ifdef VM
-		/* Hack -- support "flat directory" usage on VM/ESA */
-		my_strcpy(temp, savefile, sizeof(temp));
-		my_strcat(temp, "o", sizeof(temp));
-#endif /* VM */
+#ifdef ASYNC_AUTOSAVE
 
-		/* Grab permissions */
-		safe_setuid_grab();
-
-		/* Remove it */
-		fd_kill(temp);
+	/*
+	 * Hack -- the thread cannot juggle permissions safely, so only
+	 * write in the background if there are none to juggle.
+	 */
+# if defined(SET_UID) && defined(SAFE_SETUID)
+	if (bkp && (player_egid == (int)getgid()))
+# else
+	if (bkp)
+# endif
+	{
+		result = save_player_async(safe, target_savefile, temp);
+	}
+	else
 
-		/* Preserve old savefile */
-		fd_move(target_savefile, temp);
+#endif /* ASYNC_AUTOSAVE */
 
-		/* Activate new savefile */
-		fd_move(safe, target_savefile);
+	{
+		/* The autosave uses the same file names (see above) */
+		if (!p_ptr->panic_save) save_wait();
 
-		/* Remove preserved savefile */
-		fd_kill(temp);
+		/* Attempt to save the player */
+		if (save_player_aux(safe))
+		{
+			/* Move it into place */
+			sf_replace(safe, target_savefile, temp);
 
-		/* Drop permissions */
-		safe_setuid_drop();
+			/* Success */
+			result = TRUE;
+		}
+	}
 
+	/* Saved */
+	if (result)
+	{
 		/* Hack -- Pretend the character was loaded */
 		character_loaded = TRUE;
 
@@ -1639,9 +2350,6 @@ bool save_player_bkp(bool bkp)
 		safe_setuid_drop();
 
 #endif /* VERIFY_SAVEFILE */
-
-		/* Success */
-		result = TRUE;
 	}
 
 
@@ -13078,7 +13078,10 @@ bool project_t(int who, int what, int y, int x, int dam, int typ)
 		/* Block grids marked with temp flags as not to hit monster twice */
 		for (k=0;k<8;k++)
 		{
-			if (play_info[ddy_ddd[k]][ddy_ddd[k]] & (PLAY_TEMP)) blocked |= 1 << k;
+			int yy = y + ddy_ddd[k];
+			int xx = x + ddx_ddd[k];
+
+			if (in_bounds(yy, xx) && (play_info[yy][xx] & (PLAY_TEMP))) blocked |= 1 << k;
 		}
 
 		/* Check if monster can move and survive in terrain */
@@ -14425,6 +14428,9 @@ bool project_effect(int who, int what, u16b *grid, s16b *gd, int grids, int y0,
 		flg |= (PROJECT_LITE);
 	}
 
+	/* Redraw each affected grid once, when we are done */
+	lite_spot_hold();
+
 	/* Hack -- prevent arcs and starbursts from hurting the player if they are the source */
 	if (((flg & (PROJECT_ARC | PROJECT_STAR)) != 0))
 	{
@@ -14445,6 +14451,9 @@ bool project_effect(int who, int what, u16b *grid, s16b *gd, int grids, int y0,
 	/* Display the "blast area" if allowed */
 	if (!blind && !(flg & (PROJECT_HIDE)))
 	{
+		/* Bring the map up to date first */
+		lite_spot_flush();
+
 		/* Do the blast from inside out */
 		for (i = play_hack; i < grids; i++)
 		{
@@ -14528,6 +14537,7 @@ bool project_effect(int who, int what, u16b *grid, s16b *gd, int grids, int y0,
 			/* Flush the explosion */
 			if (op_ptr->delay_factor)
 			{
+				lite_spot_flush();
 				(void)Term_fresh();
 				if (p_ptr->window) window_stuff();
 			}
@@ -14578,6 +14588,9 @@ bool project_effect(int who, int what, u16b *grid, s16b *gd, int grids, int y0,
 			y = GRID_Y(grid[i]);
 			x = GRID_X(grid[i]);
 
+			/* Only grids holding objects */
+			if (!cave_o_idx[y][x]) continue;
+
 			/* Affect the object in the grid */
 			if (project_o(who, what, y, x, gd[i], typ)) notice = TRUE;
 		}
@@ -14752,6 +14765,9 @@ bool project_effect(int who, int what, u16b *grid, s16b *gd, int grids, int y0,
 		tell_allies_mflag(m_ptr->fy, m_ptr->fx, (MFLAG_SMART), "& is attempting to use illusions.");
 	}
 
+	/* Redraw the affected grids */
+	lite_spot_release();
+
 	/* Return "something was noticed" */
 	return (notice);
 }
@@ -4129,6 +4129,35 @@ void store_maint(int store_index)
 }
 
 
+/*
+ * Forget all the stores, as at the start of a new game.  Each store is
+ * made again when it is first entered.
+ */
+void wipe_store_list(void)
+{
+	int i, n;
+
+	/* Free the stores */
+	for (i = 0; i < total_store_count; i++)
+	{
+		/* Free the store inventory */
+		FREE(store[i]->stock);
+
+		/* Free the store */
+		FREE(store[i]);
+	}
+
+	/* No stores */
+	total_store_count = 0;
+
+	/* No town has been shopped in */
+	for (i = 0; i < z_info->t_max; i++)
+	{
+		for (n = 0; n < MAX_STORES; n++) t_info[i].store_index[n] = 0;
+	}
+}
+
+
 /*
  * Initialize a new store
  */
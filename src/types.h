@@ -108,6 +108,7 @@ typedef struct monster_blow monster_blow;
 typedef struct monster_race monster_race;
 typedef struct monster_lore monster_lore;
 typedef struct vault_type vault_type;
+typedef struct level_type level_type;
 typedef struct region_piece_type region_piece_type;
 typedef struct region_info_type region_info_type;
 typedef struct region_type region_type;
@@ -948,6 +949,33 @@ struct vault_type
 };
 
 
+/*
+ * The grid arrays of a level, kept together in one block.
+ *
+ * Every row of every array is LEVEL_STRIDE grids wide, so that the
+ * arrays share one stride and (given an aligned block) every row
+ * starts on a cache line.  The level can be wiped or copied as one
+ * piece of memory, apart from the block pointer at the end.
+ */
+struct level_type
+{
+	byte cave_info[DUNGEON_HGT][LEVEL_STRIDE];	/* Cave grid info flags */
+	byte play_info[DUNGEON_HGT][LEVEL_STRIDE];	/* Player grid info flags */
+
+	s16b cave_feat[DUNGEON_HGT][LEVEL_STRIDE];	/* Feature codes */
+	s16b cave_o_idx[DUNGEON_HGT][LEVEL_STRIDE];	/* Top object indexes */
+	s16b cave_m_idx[DUNGEON_HGT][LEVEL_STRIDE];	/* Monster indexes */
+	s16b cave_region_piece[DUNGEON_HGT][LEVEL_STRIDE];	/* Top region piece indexes */
+
+#ifdef MONSTER_FLOW
+	byte cave_cost[DUNGEON_HGT][LEVEL_STRIDE];	/* Flow (noise) costs */
+	u16b cave_when[DUNGEON_HGT][LEVEL_STRIDE];	/* Scent time stamps */
+#endif /* MONSTER_FLOW */
+
+	void *block;		/* Memory the level was allocated in */
+};
+
+
 /*
  * Information about which grids lie in a particular "region"
  */
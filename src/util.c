@@ -1600,6 +1600,9 @@ key_event inkey_ex(void)
 #endif /* ALLOW_BORG */
 
 
+	/* Draw any map grids held back by lite_spot_hold() */
+	lite_spot_flush();
+
 	/* Hack -- handle delayed "flush()" */
 	if (inkey_xtra)
 	{
@@ -4836,39 +4839,45 @@ void get_grid_using_angle(int angle, int y0, int x0, int *ty, int *tx)
 
 
 
-/* Purpose: Path finding algorithm */
-static int terrain[MAX_PF_RADIUS][MAX_PF_RADIUS];
-static int ox,oy,ex,ey;
+/*
+ * Purpose: Path finding algorithm
+ *
+ * We do an A* search from the character to the target over the whole
+ * level.  Whether the character is willing to walk through a grid is
+ * only worked out (by "is_valid_pf()") when the search first reaches
+ * it, and every piece of search state is stamped with the number of
+ * the search, so that nothing has to be cleared between searches.
+ */
+#define PF_GRIDS	(DUNGEON_HGT * DUNGEON_WID)
+
+static u32b pf_stamp = 0;
+static u32b pf_seen[PF_GRIDS];
+static bool pf_valid[PF_GRIDS];
+static bool pf_closed[PF_GRIDS];
+static u16b pf_dist[PF_GRIDS];
+static u16b pf_cost[PF_GRIDS];
+static byte pf_dir[PF_GRIDS];
+
+/*
+ * Binary heap of open grids, ordered by "pf_cost", with the position
+ * of each open grid in the heap.
+ */
+static u16b pf_heap[PF_GRIDS];
+static u16b pf_heap_pos[PF_GRIDS];
+static int pf_heap_n;
 
 bool is_valid_pf(int y, int x)
 {
-	int feat;
 	s16b this_region_piece, next_region_piece = 0;
 
 	/* Hack -- assume unvisited is permitted */
 	if (!(play_info[y][x] & (PLAY_MARK))) return (TRUE);
 
-	/* Get mimiced feat */
-	feat = f_info[cave_feat[y][x]].mimic;
-
 	/* Optionally alter known traps/doors on (non-jumping) movement */
-	if ((easy_alter)
-		 && ( (f_info[feat].flags1 & (FF1_DISARM)) ||
-		 ( !(f_info[feat].flags1 & (FF1_MOVE)) &&
-		 !(f_info[feat].flags3 & (FF3_EASY_CLIMB)) &&
-		 (f_info[feat].flags1 & (FF1_OPEN)))))
-	{
-		return (TRUE);
-	}
-
-	/* Require moveable space*/
-	if (!(f_info[feat].flags1 & (FF1_MOVE)) && !(f_info[feat].flags3 & (FF3_EASY_CLIMB))) return (FALSE);
-
-	/* Don't move over known dangerous terrain */
-	if ((f_info[feat].blow.method) || (f_info[feat].spell)) return (FALSE);
+	if ((easy_alter) && (cave_pass_bold(PASS_ALTER, y, x))) return (TRUE);
 
-	/* Don't move over known deep or filled terrain */
-	if (f_info[feat].flags2 & (FF2_DEEP | FF2_FILLED)) return (FALSE);
+	/* Require moveable space, and don't move over known dangerous, deep or filled terrain */
+	if (!cave_pass_bold(PASS_SAFE, y, x)) return (FALSE);
 
 	/* Don't move over known regions */
 	for (this_region_piece = cave_region_piece[y][x]; this_region_piece; this_region_piece = next_region_piece)
@@ -4896,128 +4905,193 @@ bool is_valid_pf(int y, int x)
 	return (TRUE);
 }
 
-static void fill_terrain_info(void)
+/*
+ * Is grid "a" better to expand than grid "b"?
+ *
+ * Ties are broken in favour of the grid further from the character,
+ * which is likely to be closer to the target.
+ */
+static bool pf_better(int a, int b)
 {
-	int i,j;
+	if (pf_cost[a] != pf_cost[b]) return (pf_cost[a] < pf_cost[b]);
 
-	ox = MAX(p_ptr->px - MAX_PF_RADIUS / 2,0);
-	oy = MAX(p_ptr->py - MAX_PF_RADIUS / 2,0);
+	return (pf_dist[a] > pf_dist[b]);
+}
 
-	ex = MIN(p_ptr->px + MAX_PF_RADIUS / 2 - 1,DUNGEON_WID);
-	ey = MIN(p_ptr->py + MAX_PF_RADIUS / 2 - 1,DUNGEON_HGT);
+/*
+ * Move a grid up the heap to its place
+ */
+static void pf_heap_up(int i)
+{
+	int g = pf_heap[i];
 
-	for (i=0;i<MAX_PF_RADIUS;i++)
-	    for(j=0;j<MAX_PF_RADIUS;j++)
-	        terrain[i][j] = -1;
+	while (i > 0)
+	{
+		int parent = (i - 1) / 2;
 
-	for (j=oy;j<ey;j++)
-		for (i=ox;i<ex;i++)
-			if (is_valid_pf(j,i))
-				terrain[j-oy][i-ox] = MAX_PF_LENGTH;
+		if (!pf_better(g, pf_heap[parent])) break;
 
-	terrain[p_ptr->py-oy][p_ptr->px-ox] = 1;
-}
+		pf_heap[i] = pf_heap[parent];
+		pf_heap_pos[pf_heap[i]] = i;
+		i = parent;
+	}
 
-#define MARK_DISTANCE(c,d) if ((c <= MAX_PF_LENGTH) && (c > d)) { c = d; try_again = (TRUE); }
+	pf_heap[i] = g;
+	pf_heap_pos[g] = i;
+}
 
-bool findpath(int y, int x)
+/*
+ * Take the best grid off the heap
+ */
+static int pf_heap_pop(void)
 {
-	int i,j,dir;
-	bool try_again;
-	int cur_distance;
+	int top = pf_heap[0];
+	int g = pf_heap[--pf_heap_n];
+	int i = 0;
+
+	/* Move the last grid down from the top */
+	while (TRUE)
+	{
+		int child = 2 * i + 1;
+
+		if (child >= pf_heap_n) break;
 
-	fill_terrain_info();
+		if ((child + 1 < pf_heap_n) && (pf_better(pf_heap[child + 1], pf_heap[child]))) child++;
 
-	terrain[p_ptr->py-oy][p_ptr->px-ox] = 1;
+		if (!pf_better(pf_heap[child], g)) break;
 
-	if ((x >= ox) && (x < ex) && (y >= oy) && (y < ey))
+		pf_heap[i] = pf_heap[child];
+		pf_heap_pos[pf_heap[i]] = i;
+		i = child;
+	}
+
+	if (pf_heap_n)
 	{
-		if ((cave_m_idx[y][x] > 0) && (m_list[cave_m_idx[y][x]].ml))
-		{
-			terrain[y-oy][x-ox] = MAX_PF_LENGTH;
-		}
-		/*else if (terrain[y-oy][x-ox] != MAX_PF_LENGTH)
-		{
-			bell("Target blocked");
-			return (FALSE);
-		}*/
-		terrain[y-oy][x-ox] = MAX_PF_LENGTH;
+		pf_heap[i] = g;
+		pf_heap_pos[g] = i;
 	}
-	else
+
+	return (top);
+}
+
+
+bool findpath(int y, int x)
+{
+	int d, dir;
+	int g, g2, y1, x1, y2, x2;
+	int goal;
+	int dist;
+
+	/* Check bounds */
+	if (!in_bounds_fully(y, x))
 	{
 		bell("Target out of range.");
 		return (FALSE);
 	}
 
-	if (terrain[y-oy][x-ox] == -1)
+	/* New search */
+	if (!++pf_stamp)
 	{
-		bell("Target space forbidden");
-		return (FALSE);
+		(void)C_WIPE(pf_seen, PF_GRIDS, u32b);
+		pf_stamp = 1;
 	}
 
+	goal = y * DUNGEON_WID + x;
 
-	/*
-	 * And now starts the very naive and very
-	 * inefficient pathfinding algorithm
-	 */
-	do
+	/* Start at the character */
+	g = p_ptr->py * DUNGEON_WID + p_ptr->px;
+
+	pf_seen[g] = pf_stamp;
+	pf_valid[g] = TRUE;
+	pf_closed[g] = FALSE;
+	pf_dist[g] = 0;
+	pf_cost[g] = MAX(ABS(y - p_ptr->py), ABS(x - p_ptr->px));
+
+	pf_heap[0] = g;
+	pf_heap_pos[g] = 0;
+	pf_heap_n = 1;
+
+	/* Search */
+	while (pf_heap_n)
 	{
-		try_again = (FALSE);
-		for (j=oy+1;j<ey-1;j++)
-			for (i=ox+1;i<ex-1;i++)
+		g = pf_heap_pop();
+		pf_closed[g] = TRUE;
+
+		/* Found the target */
+		if (g == goal) break;
+
+		y1 = g / DUNGEON_WID;
+		x1 = g % DUNGEON_WID;
+
+		dist = pf_dist[g] + 1;
+
+		/* Too far away */
+		if (dist >= MAX_PF_LENGTH) continue;
+
+		/* Look at all adjacent grids */
+		for (d = 0; d < 8; d++)
+		{
+			dir = ddd[d];
+
+			y2 = y1 + ddy[dir];
+			x2 = x1 + ddx[dir];
+
+			/* Check bounds */
+			if (!in_bounds_fully(y2, x2)) continue;
+
+			g2 = y2 * DUNGEON_WID + x2;
+
+			/* First time we have reached this grid */
+			if (pf_seen[g2] != pf_stamp)
 			{
-				cur_distance = terrain[j-oy][i-ox]+1;
-				if ((cur_distance > 0) && (cur_distance < MAX_PF_LENGTH))
-				{
-					for (dir=1;dir<10;dir++)
-					{
-						if (dir==5)
-							dir++;
-						MARK_DISTANCE(terrain[j-oy+ddy[dir]][i-ox+ddx[dir]],cur_distance);
-					}
-				}
+				pf_seen[g2] = pf_stamp;
+
+				/* The target itself is always allowed */
+				pf_valid[g2] = (g2 == goal) || is_valid_pf(y2, x2);
+				pf_closed[g2] = FALSE;
+				pf_dist[g2] = MAX_PF_LENGTH;
 			}
-		if (terrain[y-oy][x-ox] < MAX_PF_LENGTH)
-			try_again = (FALSE);
-	} while (try_again);
+
+			/* Ignore forbidden and finished grids */
+			if (!pf_valid[g2] || pf_closed[g2]) continue;
+
+			/* Ignore grids we already have a short enough path to */
+			if (pf_dist[g2] <= dist) continue;
+
+			/* Queue the grid, or move it up the queue */
+			if (pf_dist[g2] == MAX_PF_LENGTH) pf_heap_pos[g2] = pf_heap_n++;
+
+			pf_dist[g2] = dist;
+			pf_cost[g2] = dist + MAX(ABS(y - y2), ABS(x - x2));
+			pf_dir[g2] = dir;
+
+			pf_heap[pf_heap_pos[g2]] = g2;
+			pf_heap_up(pf_heap_pos[g2]);
+		}
+	}
 
 	/* Failure */
-	if (terrain[y-oy][x-ox] == MAX_PF_LENGTH)
+	if ((pf_seen[goal] != pf_stamp) || !pf_closed[goal])
 	{
 		bell("Target space unreachable.");
 		return (FALSE);
 	}
 
-	/* Success */
-	i = x;
-	j = y;
-
+	/* Success -- store the path backwards from the target */
 	pf_result_index = 0;
 
-	while ((i != p_ptr->px) || (j != p_ptr->py))
+	for (g = goal; pf_dist[g]; )
 	{
-		cur_distance = terrain[j-oy][i-ox] - 1;
-		for (dir=1;dir<10;dir++)
-			if (terrain[j-oy+ddy[dir]][i-ox+ddx[dir]] == cur_distance)
-				break;
+		dir = pf_dir[g];
 
-		/* Should never happend */
-		if (dir == 10)
-		{
-			bell("Wtf ?");
-			return (FALSE);
-		}
+		pf_result[pf_result_index++] = '0' + (char)dir;
 
-		if (dir == 5)
-		{
-			bell("Heyyy !");
-			return (FALSE);
-		}
+		y1 = g / DUNGEON_WID - ddy[dir];
+		x1 = g % DUNGEON_WID - ddx[dir];
 
-		pf_result[pf_result_index++] = '0' + (char)(10-dir);
-		i += ddx[dir];
-		j += ddy[dir];
+		g = y1 * DUNGEON_WID + x1;
 	}
+
 	pf_result_index--;
 	return (TRUE);
 }
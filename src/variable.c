@@ -601,6 +601,21 @@ u16b *view_g;
 sint fire_n = 0;
 u16b *fire_g;
 
+#ifdef VIEW_SHADOWCAST
+
+/*
+ * Array[VIEW_MAX] holding the old view while "update_view()" builds
+ * the new one by shadowcasting
+ */
+u16b *view_old_g;
+
+/*
+ * Use shadowcasting instead of the "vinfo" table
+ */
+bool view_shadowcast = FALSE;
+
+#endif /* VIEW_SHADOWCAST */
+
 
 /*
  * Arrays[TEMP_MAX] used for various things
@@ -620,25 +635,70 @@ byte dyna_cent_x;
 bool dyna_full;
 
 /*
- * Array[DUNGEON_HGT][256] of cave grid info flags (padded)
+ * The grid arrays of the current level.  The cave arrays below all
+ * point into this block (see "cave_level_set()").
+ */
+level_type *cave_level;
+
+/*
+ * Array[DUNGEON_HGT][LEVEL_STRIDE] of cave grid info flags (padded)
  *
  * This array is padded to a width of 256 to allow fast access to elements
  * in the array via "grid" values (see the GRID() macros).
  */
-byte (*cave_info)[256];
+byte (*cave_info)[LEVEL_STRIDE];
 
 /*
- * Array[DUNGEON_HGT][256] of player grid info flags (padded)
+ * Array[DUNGEON_HGT][LEVEL_STRIDE] of player grid info flags (padded)
  *
  * This array is padded to a width of 256 to allow fast access to elements
  * in the array via "grid" values (see the GRID() macros).
  */
-byte (*play_info)[256];
+byte (*play_info)[LEVEL_STRIDE];
+
+/*
+ * Array[DUNGEON_HGT][LEVEL_STRIDE] of cave grid feature codes
+ */
+s16b (*cave_feat)[LEVEL_STRIDE];
+
+/*
+ * Terrain change counter.  Bumped whenever the terrain of a grid changes,
+ * or a new level is made, so that anything worked out from the terrain
+ * can tell when it has gone stale.
+ */
+u32b cave_feat_epoch = 0;
+
+/*
+ * View change counter.  Bumped whenever the field of view (or fire) of
+ * the character is worked out again or forgotten.
+ */
+u32b play_view_epoch = 0;
+
+#ifdef LOS_CACHE
+
+/*
+ * Number of generic_los() calls answered from (and missing) the cache
+ */
+u32b los_cache_hit = 0L;
+u32b los_cache_miss = 0L;
+
+#endif /* LOS_CACHE */
+
+#ifdef PATH_CACHE
 
 /*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid feature codes
+ * Number of lines of fire found in (and missing from) the path cache
  */
-s16b (*cave_feat)[DUNGEON_WID];
+u32b path_cache_hit = 0L;
+u32b path_cache_miss = 0L;
+
+#endif /* PATH_CACHE */
+
+/*
+ * Array[PASS_MAX][DUNGEON_HGT][PASS_WORDS] of passability bitmaps.
+ * One bit per grid, kept up to date by "cave_set_feat()".
+ */
+u32b cave_pass[PASS_MAX][DUNGEON_HGT][PASS_WORDS];
 
 
 
@@ -661,7 +721,7 @@ byte dun_room[MAX_ROOMS_ROW][MAX_ROOMS_COL];
 
 
 /*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid object indexes
+ * Array[DUNGEON_HGT][LEVEL_STRIDE] of cave grid object indexes
  *
  * Note that this array yields the index of the top object in the stack of
  * objects in a given grid, using the "next_o_idx" field in that object to
@@ -671,13 +731,13 @@ byte dun_room[MAX_ROOMS_ROW][MAX_ROOMS_COL];
  * any object is in a grid, and relatively fast determination of which objects
  * are in a grid.
  */
-s16b (*cave_o_idx)[DUNGEON_WID];
+s16b (*cave_o_idx)[LEVEL_STRIDE];
 
 
 
 
 /*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid monster indexes
+ * Array[DUNGEON_HGT][LEVEL_STRIDE] of cave grid monster indexes
  *
  * Note that this array yields the index of the monster or player in a grid,
  * where negative numbers are used to represent the player, positive numbers
@@ -686,12 +746,12 @@ s16b (*cave_o_idx)[DUNGEON_WID];
  * the player structure, but provides extremely fast determination of which,
  * if any, monster or player is in any given grid.
  */
-s16b (*cave_m_idx)[DUNGEON_WID];
+s16b (*cave_m_idx)[LEVEL_STRIDE];
 
 
 
 /*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid region indexes
+ * Array[DUNGEON_HGT][LEVEL_STRIDE] of cave grid region indexes
  *
  * Note that this array yields the index of the top region in the stack of
  * region in a given grid, using the "next_region_idx" field in that region to
@@ -701,7 +761,7 @@ s16b (*cave_m_idx)[DUNGEON_WID];
  * any region is in a grid, and relatively fast determination of which regions
  * are in a grid.
  */
-s16b (*cave_region_piece)[DUNGEON_WID];
+s16b (*cave_region_piece)[LEVEL_STRIDE];
 
 
 /*
@@ -738,21 +798,22 @@ void (*modify_grid_interesting_hook)(byte *a, char *c, int y, int x, byte cinfo,
 #ifdef MONSTER_FLOW
 
 /*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid flow "cost" values
+ * Array[DUNGEON_HGT][LEVEL_STRIDE] of cave grid flow "cost" values
  * Used to simulate character noise.
  */
-byte (*cave_cost)[DUNGEON_WID];
+byte (*cave_cost)[LEVEL_STRIDE];
 
 /*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid flow "when" stamps.
- * Used to store character scent trails.
+ * Array[DUNGEON_HGT][LEVEL_STRIDE] of cave grid flow "when" stamps.
+ * Used to store character scent trails.  Zero means no scent.
  */
-byte (*cave_when)[DUNGEON_WID];
+u16b (*cave_when)[LEVEL_STRIDE];
 
 /*
- * Current scent age marker.  Counts down from 250 to 0 and then loops.
+ * Current scent time stamp.  Counts up each time scent is laid, and is
+ * started again (see "update_smell()") before it reaches SMELL_CLOCK_MAX.
  */
-int scent_when = 250;
+u16b scent_when = SMELL_FADE;
 
 
 /*
@@ -782,6 +843,41 @@ object_type *o_list;
  */
 monster_type *m_list;
 
+/*
+ * Array[z_info->m_max] of the indexes of live monsters, in no particular
+ * order, and Array[z_info->m_max] of the slot of each monster in it
+ */
+s16b *mon_live;
+s16b *mon_live_slot;
+s16b mon_live_n = 0;
+
+/*
+ * Array[z_info->m_max] of what "update_monsters()" last saw of each
+ * monster, Array[z_info->m_max] of the race it saw, and Array[z_info->m_max]
+ * of what it sees now, by slot in "mon_live"
+ */
+u32b *mon_vis_key;
+s16b *mon_vis_race;
+u32b *mon_vis_new;
+
+/*
+ * Array[MON_WAIT_WORDS] of flags marking the live monsters yet to move
+ * this game turn, one bit per monster, and Array[z_info->m_max] of the
+ * energy each of them had when last checked
+ */
+u32b *mon_wait;
+byte *mon_wait_energy;
+
+/*
+ * Array[MON_BLOCK_HGT * MON_BLOCK_WID] of the first monster in each block,
+ * and Array[z_info->m_max] of the next and previous monster in the same
+ * block as each monster, and of the block each monster is in
+ */
+s16b mon_block[MON_BLOCK_HGT * MON_BLOCK_WID];
+s16b *mon_block_next;
+s16b *mon_block_prev;
+s16b *mon_block_of;
+
 /*
  * Array[z_info->r_max] of monster lore
  */
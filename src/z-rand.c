@@ -14,13 +14,14 @@
  *
  *
  * This code provides both a "quick" random number generator (4 bytes of
- * state), and a "decent" random number generator (256 bytes of state),
- * both available in two flavors, first, the simple "mod" flavor, which
- * is fast, but slightly biased at high values, and second, the simple
- * "div" flavor, which is less fast (and potentially non-terminating)
- * but which is not biased and is much less subject to non-randomness
- * problems in the low bits.  Note the "rand_int()" macro in "z-rand.h",
- * which must specify a "default" flavor.
+ * state), and a "decent" random number generator (32 bytes of state).
+ * The "quick" one is a simple linear congruential generator, which is
+ * kept exactly as it always was, because flavors, the town and seeded
+ * levels are built from a known seed with it.  The "decent" one is the
+ * 64-bit "xoshiro256**" generator by David Blackman and Sebastiano Vigna,
+ * which is both faster and much better than the old lagged Fibonacci
+ * table.  Note the "rand_int()" macro in "z-rand.h", which uses the
+ * unbiased "Rand_div()" function.
  *
  * Note the use of the "simple" RNG, first you activate it via
  * "Rand_quick = TRUE" and "Rand_value = seed" and then it is used
@@ -48,6 +49,11 @@
  */
 #define LCRNG(X)        ((X) * 1103515245 + 12345)
 
+/*
+ * Rotate a 64-bit value left by "K" bits
+ */
+#define ROTL64(X, K)	(((X) << (K)) | ((X) >> (64 - (K))))
+
 
 
 /*
@@ -63,56 +69,102 @@ u32b Rand_value;
 
 
 /*
- * Current "index" for the "complex" RNG
+ * Current "state" for the "complex" RNG
  */
-u16b Rand_place;
+u64b Rand_state[RAND_DEG];
+
+
 
 /*
- * Current "state" table for the "complex" RNG
+ * Initialize the "complex" RNG using a new seed
+ *
+ * The seed is spread over the state with "splitmix64", which never
+ * leaves the state all zero.
  */
-u32b Rand_state[RAND_DEG];
+void Rand_state_init(u32b seed)
+{
+	int i;
 
+	u64b x = seed;
+	u64b z;
+
+	for (i = 0; i < RAND_DEG; i++)
+	{
+		x += UINT64_C(0x9E3779B97F4A7C15);
+
+		z = x;
+		z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+		z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+
+		Rand_state[i] = z ^ (z >> 31);
+	}
+}
 
 
 /*
- * Initialize the "complex" RNG using a new seed
+ * Advance the "complex" RNG held in "s", and extract 64 "random" bits
  */
-void Rand_state_init(u32b seed)
+static u64b Rand_next(u64b *s)
 {
-	int i, j;
+	u64b r = ROTL64(s[1] * 5, 7) * 9;
+	u64b t = s[1] << 17;
 
-	/* Seed the table */
-	Rand_state[0] = seed;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
 
-	/* Propagate the seed */
-	for (i = 1; i < RAND_DEG; i++) Rand_state[i] = LCRNG(Rand_state[i-1]);
+	s[2] ^= t;
 
-	/* Cycle the table ten times per degree */
-	for (i = 0; i < RAND_DEG * 10; i++)
-	{
-		/* Acquire the next index */
-		j = Rand_place + 1;
-		if (j == RAND_DEG) j = 0;
+	s[3] = ROTL64(s[3], 45);
+
+	return (r);
+}
 
-		/* Update the table, extract an entry */
-		Rand_state[j] += Rand_state[Rand_place];
 
-		/* Advance the index */
-		Rand_place = j;
+/*
+ * Extract a "random" number from 0 to m-1 from the "complex" RNG held
+ * in "s", using Lemire's "multiply and reject" method.
+ *
+ * The top 32 bits of a draw are multiplied by "m", and the top half
+ * of the product is the result.  Products whose low half falls below
+ * 2^32 % m would make some results more likely than others, so they
+ * are rejected, which almost never happens for the small "m" used by
+ * the game.  Only then is a division needed.
+ */
+static u32b Rand_lemire(u64b *s, u32b m)
+{
+	u64b prod = (Rand_next(s) >> 32) * m;
+	u64b low = prod & 0xFFFFFFFFL;
+
+	/* Possibly biased */
+	if (low < m)
+	{
+		u64b t = (((u64b)1 << 32) - m) % m;
+
+		/* Reject the biased products */
+		while (low < t)
+		{
+			prod = (Rand_next(s) >> 32) * m;
+			low = prod & 0xFFFFFFFFL;
+		}
 	}
+
+	return ((u32b)(prod >> 32));
 }
 
 
 /*
  * Extract a "random" number from 0 to m-1, via "division"
  *
- * This method selects "random" 28-bit numbers, and then uses
+ * The "complex" RNG uses "Rand_lemire()" above, which has no bias.
+ *
+ * The "simple" RNG selects "random" 28-bit numbers, and then uses
  * division to drop those numbers into "m" different partitions,
  * plus a small non-partition to reduce bias, taking as the final
  * value the first "good" partition that a number falls into.
- *
- * This method has no bias, and is much less affected by patterns
- * in the "low" bits of the underlying RNG's.
+ * This must never change, so that seeded levels, flavors and the
+ * town stay the same.
  *
  * Note that "m" must not be greater than 0x1000000, or division
  * by zero will result.
@@ -123,59 +175,60 @@ u32b Rand_div(u32b m)
 {
 	u32b r, n;
 
-/*    if (!Rand_quick) fputs(".",stdout); */
-
 	/* Hack -- simple case */
 	if (m <= 1) return (0);
 
+	/* Use a complex RNG */
+	if (!Rand_quick) return (Rand_lemire(Rand_state, m));
+
 	/* Partition size */
 	n = (0x10000000 / m);
 
-	/* Use a simple RNG */
-	if (Rand_quick)
+	/* Use a simple RNG -- wait for it */
+	while (1)
 	{
-		/* Wait for it */
-		while (1)
-		{
-			/* Cycle the generator */
-			r = (Rand_value = LCRNG(Rand_value));
+		/* Cycle the generator */
+		r = (Rand_value = LCRNG(Rand_value));
 
-			/* Mutate a 28-bit "random" number */
-			r = ((r >> 4) & 0x0FFFFFFF) / n;
+		/* Mutate a 28-bit "random" number */
+		r = ((r >> 4) & 0x0FFFFFFF) / n;
 
-			/* Done */
-			if (r < m) break;
-		}
+		/* Done */
+		if (r < m) break;
 	}
 
-	/* Use a complex RNG */
-	else
-	{
-		/* Wait for it */
-		while (1)
-		{
-			int j;
+	/* Use the value */
+	return (r);
+}
 
-			/* Acquire the next index */
-			j = Rand_place + 1;
-			if (j == RAND_DEG) j = 0;
 
-			/* Update the table, extract an entry */
-			r = (Rand_state[j] += Rand_state[Rand_place]);
+/*
+ * Fill "buf" with "num" "random" numbers from 0 to m-1.
+ *
+ * This gives exactly the numbers that "num" calls to "Rand_div()" would
+ * have, but the "complex" RNG is worked on from a local copy, which the
+ * compiler can keep in registers across the whole loop.
+ */
+void Rand_fill(u32b *buf, int num, u32b m)
+{
+	u64b s[RAND_DEG];
+	int i;
 
-			/* Hack -- extract a 28-bit "random" number */
-			r = ((r >> 4) & 0x0FFFFFFF) / n;
+	/* Use the simple RNG, or nothing at all */
+	if (Rand_quick || (m <= 1))
+	{
+		for (i = 0; i < num; i++) buf[i] = Rand_div(m);
+		return;
+	}
 
-			/* Advance the index */
-			Rand_place = j;
+	/* Take a copy of the state */
+	for (i = 0; i < RAND_DEG; i++) s[i] = Rand_state[i];
 
-			/* Done */
-			if (r < m) break;
-		}
-	}
+	/* Draw the numbers */
+	for (i = 0; i < num; i++) buf[i] = Rand_lemire(s, m);
 
-	/* Use the value */
-	return (r);
+	/* Store the new state */
+	for (i = 0; i < RAND_DEG; i++) Rand_state[i] = s[i];
 }
 
 
@@ -19,10 +19,11 @@
 
 
 /*
- * The "degree" of the "complex" Random Number Generator.
- * This value is hard-coded at 63 for a wide variety of reasons.
+ * The number of 64-bit words of state of the "complex" Random Number
+ * Generator.  This value is hard-coded at 4 by the "xoshiro256**"
+ * algorithm.
  */
-#define RAND_DEG 63
+#define RAND_DEG 4
 
 
 
@@ -85,8 +86,7 @@
 
 extern bool Rand_quick;
 extern u32b Rand_value;
-extern u16b Rand_place;
-extern u32b Rand_state[RAND_DEG];
+extern u64b Rand_state[RAND_DEG];
 
 
 /**** Available Functions ****/
@@ -94,6 +94,7 @@ extern u32b Rand_state[RAND_DEG];
 
 extern void Rand_state_init(u32b seed);
 extern u32b Rand_div(u32b m);
+extern void Rand_fill(u32b *buf, int num, u32b m);
 extern s16b Rand_normal(int mean, int stand);
 extern u32b Rand_simple(u32b m);
 extern s32b div_round(s32b n, s32b d);
@@ -288,6 +288,69 @@ term *Term = NULL;
 /*** Local routines ***/
 
 
+/*
+ * Hash one grid of a window.
+ *
+ * The hash of a row is the "xor" of the hashes of its grids, so it can
+ * be kept up to date as single grids change.  This lets "Term_fresh()"
+ * cheaply pick out a row which has been marked as changed but which may
+ * already match what is displayed, such as every row which was left
+ * alone by a menu after "Term_load()".  Rows whose hashes match are
+ * then compared in full (see "term_win_same()"), as different rows can
+ * have the same hash.
+ */
+static u32b term_grid_hash(int x, byte a, char c, byte ta, char tc)
+{
+	u32b k = ((u32b)a << 24) | ((u32b)(byte)c << 16) | ((u32b)ta << 8) | (u32b)(byte)tc;
+
+	/* Mix in the column */
+	k ^= (u32b)x * 0x9E3779B9UL;
+
+	/* Mix the bits */
+	k ^= k >> 16;
+	k = (k * 0x85EBCA6BUL) & 0xFFFFFFFFUL;
+	k ^= k >> 13;
+	k = (k * 0xC2B2AE35UL) & 0xFFFFFFFFUL;
+	k ^= k >> 16;
+
+	return (k);
+}
+
+
+/*
+ * Work out the hash of a row of a term_win from scratch
+ */
+static void term_win_hash(term_win *s, int y, int w)
+{
+	int x;
+
+	u32b hash = 0L;
+
+	for (x = 0; x < w; x++)
+	{
+		hash ^= term_grid_hash(x, s->a[y][x], s->c[y][x], s->ta[y][x], s->tc[y][x]);
+	}
+
+	s->hash[y] = hash;
+}
+
+
+/*
+ * Check that grids "x1" to "x2" of a row are the same in two term_wins
+ */
+static bool term_win_same(const term_win *s, const term_win *f, int y, int x1, int x2)
+{
+	int n = x2 - x1 + 1;
+
+	if (memcmp(&s->a[y][x1], &f->a[y][x1], n)) return (FALSE);
+	if (memcmp(&s->c[y][x1], &f->c[y][x1], n)) return (FALSE);
+	if (memcmp(&s->ta[y][x1], &f->ta[y][x1], n)) return (FALSE);
+	if (memcmp(&s->tc[y][x1], &f->tc[y][x1], n)) return (FALSE);
+
+	return (TRUE);
+}
+
+
 /*
  * Nuke a term_win (see below)
  */
@@ -309,6 +372,9 @@ static errr term_win_nuke(term_win *s)
 	FREE(s->vta);
 	FREE(s->vtc);
 
+	/* Free the row hashes */
+	FREE(s->hash);
+
 	/* Success */
 	return (0);
 }
@@ -337,6 +403,9 @@ static errr term_win_init(term_win *s, int w, int h)
 	s->vta = C_ZNEW(h * w, byte);
 	s->vtc = C_ZNEW(h * w, char);
 
+	/* Make the row hashes */
+	s->hash = C_ZNEW(h, u32b);
+
 	/* Prepare the window access arrays */
 	for (y = 0; y < h; y++)
 	{
@@ -345,6 +414,9 @@ static errr term_win_init(term_win *s, int w, int h)
 
 		s->ta[y] = s->vta + w * y;
 		s->tc[y] = s->vtc + w * y;
+
+		/* Hash the empty row */
+		term_win_hash(s, y, w);
 	}
 
 	/* Success */
@@ -354,6 +426,9 @@ static errr term_win_init(term_win *s, int w, int h)
 
 /*
  * Copy a "term_win" from another
+ *
+ * The row hashes are copied too, so if only part of a row is copied
+ * they must be worked out again afterwards.
  */
 static errr term_win_copy(term_win *s, term_win *f, int w, int h)
 {
@@ -382,6 +457,9 @@ static errr term_win_copy(term_win *s, term_win *f, int w, int h)
 			*s_taa++ = *f_taa++;
 			*s_tcc++ = *f_tcc++;
 		}
+
+		/* Copy the hash */
+		s->hash[y] = f->hash[y];
 	}
 
 	/* Copy cursor */
@@ -507,6 +585,9 @@ void Term_queue_char(int x, int y, byte a, char c, byte ta, char tc)
 	/* Hack -- Ignore non-changes */
 	if (!(Term->always_draw) && (oa == a) && (oc == c) && (ota == ta) && (otc == tc)) return;
 
+	/* Update the row hash */
+	Term->scr->hash[y] ^= term_grid_hash(x, oa, oc, ota, otc) ^ term_grid_hash(x, a, c, ta, tc);
+
 	/* Save the "literal" information */
 	scr_aa[x] = a;
 	scr_cc[x] = c;
@@ -554,6 +635,9 @@ void Term_queue_chars(int x, int y, int n, byte a, cptr s)
 		/* Hack -- Ignore non-changes */
 		if (!(Term->always_draw) && (oa == a) && (oc == *s) && (ota == 0) && (otc == 0)) continue;
 
+		/* Update the row hash */
+		Term->scr->hash[y] ^= term_grid_hash(x, oa, oc, ota, otc) ^ term_grid_hash(x, a, *s, 0, 0);
+
 		/* Save the "literal" information */
 		scr_aa[x] = a;
 		scr_cc[x] = *s;
@@ -1160,6 +1244,9 @@ errr Term_fresh(void)
 				*taa++ = na;
 				*tcc++ = nc;
 			}
+
+			/* Hash the blank row */
+			term_win_hash(old, y, w);
 		}
 
 		/* Redraw every row */
@@ -1265,8 +1352,15 @@ errr Term_fresh(void)
 			/* Flush each "modified" row */
 			if (x1 <= x2)
 			{
+				/* Hack -- the row already matches the display */
+				if (!(Term->always_draw) && (scr->hash[y] == old->hash[y]) &&
+				    term_win_same(scr, old, y, x1, x2))
+				{
+					/* Nothing to draw */
+				}
+
 				/* Always use "Term_pict()" */
-				if (Term->always_pict)
+				else if (Term->always_pict)
 				{
 					/* Flush the row */
 					Term_fresh_row_pict(y, x1, x2);
@@ -1286,6 +1380,9 @@ errr Term_fresh(void)
 					Term_fresh_row_text(y, x1, x2);
 				}
 
+				/* The display now matches the row */
+				old->hash[y] = scr->hash[y];
+
 				/* This row is all done */
 				Term->x1[y] = w;
 				Term->x2[y] = 0;
@@ -1625,6 +1722,10 @@ errr Term_erase(int x, int y, int n)
 		/* Hack -- Ignore "non-changes" */
 		if ((oa == na) && (oc == nc)) continue;
 
+		/* Update the row hash */
+		Term->scr->hash[y] ^= term_grid_hash(x, oa, oc, scr_taa[x], scr_tcc[x]) ^
+			term_grid_hash(x, na, nc, 0, 0);
+
 		/* Save the "literal" information */
 		scr_aa[x] = na;
 		scr_cc[x] = nc;
@@ -1695,6 +1796,9 @@ errr Term_clear(void)
 			scr_tcc[x] = 0;
 		}
 
+		/* Hash the blank row */
+		term_win_hash(Term->scr, y, w);
+
 		/* This row has changed */
 		Term->x1[y] = 0;
 		Term->x2[y] = w - 1;
@@ -1747,18 +1851,18 @@ errr Term_redraw_section(int x1, int y1, int x2, int y2)
 	if (x1 < 0) x1 = 0;
 
 
-	/* Set y limits */
-	Term->y1 = y1;
-	Term->y2 = y2;
+	/* Extend the y limits */
+	if (y1 < Term->y1) Term->y1 = y1;
+	if (y2 > Term->y2) Term->y2 = y2;
 
-	/* Set the x limits */
-	for (i = Term->y1; i <= Term->y2; i++)
+	/* Extend the x limits */
+	for (i = y1; i <= y2; i++)
 	{
 		if ((x1 > 0) && (Term->old->a[i][x1] == 255))
 			x1--;
 
-		Term->x1[i] = x1;
-		Term->x2[i] = x2;
+		if (x1 < Term->x1[i]) Term->x1[i] = x1;
+		if (x2 > Term->x2[i]) Term->x2[i] = x2;
 
 		c_ptr = Term->old->c[i];
 
@@ -1768,6 +1872,9 @@ errr Term_redraw_section(int x1, int y1, int x2, int y2)
 			/* Hack - set the old character to "none" */
 			c_ptr[j] = 0;
 		}
+
+		/* Hash what is left */
+		term_win_hash(Term->old, i, Term->wid);
 	}
 
 	/* Hack -- Refresh */
@@ -2294,6 +2401,14 @@ errr Term_resize(int w, int h)
 	Term->wid = w;
 	Term->hgt = h;
 
+	/* Work out the row hashes again */
+	for (i = 0; i < h; i++)
+	{
+		term_win_hash(Term->scr, i, w);
+		if (Term->mem) term_win_hash(Term->mem, i, w);
+		if (Term->tmp) term_win_hash(Term->tmp, i, w);
+	}
+
 	/* Force "total erase" */
 	Term->total_erase = TRUE;
 
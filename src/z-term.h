@@ -27,6 +27,8 @@
  *	- Array[h*w] -- Attribute array
  *	- Array[h*w] -- Character array
  *
+ *	- Array[h] -- Hash of the contents of each row
+ *
  * Note that the attr/char pair at (x,y) is a[y][x]/c[y][x]
  * and that the row of attr/chars at (0,y) is a[y]/c[y]
  */
@@ -49,6 +51,8 @@ struct term_win
 
 	byte *vta;
 	char *vtc;
+
+	u32b *hash;
 };
 
 